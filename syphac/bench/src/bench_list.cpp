@@ -0,0 +1,533 @@
+/* bench_list.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+// Compares sypha_list against a reference list that makes a separate allocation for the
+// item and for the copy of its data (the old sypha_list layout).  Link with
+// -Wl,--wrap=malloc -Wl,--wrap=free so allocations can be counted.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <chrono>
+#include <initializer_list>
+#include "syphac/sypha_deque.h"
+#include "syphac/sypha_list.h"
+#include "syphac/sypha_list_inline.h"
+#include "syphac/sypha_skiplist.h"
+
+#define ITEM_COUNT      1000000
+#define ITEM_SZ         32
+#define QUEUE_DEPTH     1024
+#define MERGE_PARTS     64
+#define REQUEST_ITEMS   1000
+#define SCAN_BATCH      64
+#define SORTED_COUNT    20000
+
+extern "C" {
+    void * __real_malloc(size_t sz);
+    void __real_free(void * ptr);
+
+    static size_t malloc_count = 0;
+    static volatile size_t malloc_bytes = 0;
+
+    // Counts the heap chunk, its header word included
+    void * __wrap_malloc(size_t sz) {
+        void * ptr = __real_malloc(sz);
+        malloc_count++;
+        malloc_bytes += malloc_usable_size(ptr) + sizeof(size_t);
+        return ptr;
+    }
+
+    void __wrap_free(void * ptr) {
+        __real_free(ptr);
+    }
+}
+
+struct ref_item {
+    void * data;
+    size_t data_sz;
+    struct ref_item * prev;
+    struct ref_item * next;
+};
+
+struct ref_list {
+    struct ref_item * first;
+    struct ref_item * last;
+};
+
+static void ref_list_append(struct ref_list * list, void * data, size_t data_sz) {
+    struct ref_item * item = (struct ref_item *) malloc(sizeof(struct ref_item));
+    item->data = malloc(data_sz);
+    memcpy(item->data, data, data_sz);
+    item->data_sz = data_sz;
+    item->prev = list->last;
+    item->next = NULL;
+    if (list->last) {
+        list->last->next = item;
+    } else {
+        list->first = item;
+    }
+    list->last = item;
+}
+
+static void ref_list_destroy(struct ref_list * list) {
+    struct ref_item * item = list->first, * next;
+    while (item) {
+        next = item->next;
+        free(item->data);
+        free(item);
+        item = next;
+    }
+}
+
+// Keeps the scans from being optimized away
+static volatile unsigned long long sink = 0;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char * name, const char * op, double ms, size_t allocs) {
+    printf("%-24s %-8s %10.2f ms %10.2f Mitems/s %8.2f allocs/item\n", name, op, ms,
+        (ITEM_COUNT / 1000.0) / ms, ((double) allocs) / ITEM_COUNT);
+}
+
+static void bench_reference() {
+    unsigned char record[ITEM_SZ];
+    struct ref_list list = { NULL, NULL };
+    unsigned long long sum = 0;
+
+    malloc_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        memset(record, (int) i, sizeof(record));
+        ref_list_append(&list, record, sizeof(record));
+    }
+    report("reference (2 allocs)", "append", elapsed_ms(start), malloc_count);
+
+    start = std::chrono::steady_clock::now();
+    for (struct ref_item * item = list.first; item; item = item->next) {
+        sum += ((unsigned char *) item->data)[0];
+    }
+    report("reference (2 allocs)", "scan", elapsed_ms(start), 0);
+
+    ref_list_destroy(&list);
+    sink = sum;
+}
+
+static void bench_sypha_list() {
+    unsigned char record[ITEM_SZ];
+    SYPHA_LIST list = sypha_list_create();
+    unsigned long long sum = 0;
+    void * value;
+    size_t value_sz;
+
+    malloc_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        memset(record, (int) i, sizeof(record));
+        sypha_list_append_item(list, record, sizeof(record));
+    }
+    report("sypha_list", "append", elapsed_ms(start), malloc_count);
+
+    SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while (sypha_list_iterator_next(iterator) == 0) {
+        value = sypha_list_iterator_get(iterator, &value_sz);
+        sum += ((unsigned char *) value)[0];
+    }
+    report("sypha_list", "scan", elapsed_ms(start), 0);
+    sypha_list_destroy_iterator(iterator);
+
+    void * values[SCAN_BATCH];
+    size_t count;
+    iterator = sypha_list_get_read_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while ((count = sypha_list_iterator_next_batch(iterator, values, NULL, SCAN_BATCH)) > 0) {
+        for (size_t i=0;i < count;i++) {
+            sum += ((unsigned char *) values[i])[0];
+        }
+    }
+    report("sypha_list (batch)", "scan", elapsed_ms(start), 0);
+    sypha_list_destroy_iterator(iterator);
+
+    iterator = sypha_list_get_read_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while ((value = sypha_list_iterator_next_get_inline(iterator, &value_sz))) {
+        sum += ((unsigned char *) value)[0];
+    }
+    report("sypha_list (inline)", "scan", elapsed_ms(start), 0);
+    sypha_list_destroy_iterator(iterator);
+
+    sypha_list_destroy(list);
+    sink = sum;
+}
+
+// Loading an array of records one append at a time vs in one batch
+static void bench_load() {
+    unsigned char (* records)[ITEM_SZ] = (unsigned char (*)[ITEM_SZ]) malloc(ITEM_COUNT * ITEM_SZ);
+    SYPHA_LIST list;
+
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        memset(records[i], (int) i, ITEM_SZ);
+    }
+
+    list = sypha_list_create();
+    malloc_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        sypha_list_append_item(list, records[i], ITEM_SZ);
+    }
+    report("sypha_list (loop)", "load", elapsed_ms(start), malloc_count);
+    sypha_list_destroy(list);
+
+    list = sypha_list_create();
+    malloc_count = 0;
+    start = std::chrono::steady_clock::now();
+    sypha_list_append_many(list, records, ITEM_SZ, ITEM_COUNT);
+    report("sypha_list (append_many)", "load", elapsed_ms(start), malloc_count);
+    sypha_list_destroy(list);
+
+    free(records);
+}
+
+// Merging per-thread result lists into one, copying items over vs concat
+static void bench_merge() {
+    unsigned char record[ITEM_SZ];
+    SYPHA_LIST parts[MERGE_PARTS];
+    SYPHA_LIST merged;
+    SYPHA_LIST_ITERATOR iterator;
+    void * value;
+    size_t value_sz;
+
+    memset(record, 0x0, sizeof(record));
+    for (size_t p=0;p < MERGE_PARTS;p++) {
+        parts[p] = sypha_list_create();
+        for (size_t i=0;i < ITEM_COUNT / MERGE_PARTS;i++) {
+            sypha_list_append_item(parts[p], record, sizeof(record));
+        }
+    }
+
+    merged = sypha_list_create();
+    malloc_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t p=0;p < MERGE_PARTS;p++) {
+        iterator = sypha_list_get_iterator_front(parts[p]);
+        while (sypha_list_iterator_next(iterator) == 0) {
+            value = sypha_list_iterator_get(iterator, &value_sz);
+            sypha_list_append_item(merged, value, value_sz);
+        }
+        sypha_list_destroy_iterator(iterator);
+    }
+    report("sypha_list (copy)", "merge", elapsed_ms(start), malloc_count);
+    sypha_list_destroy(merged);
+
+    merged = sypha_list_create();
+    malloc_count = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t p=0;p < MERGE_PARTS;p++) {
+        sypha_list_concat(merged, parts[p]);
+    }
+    report("sypha_list (concat)", "merge", elapsed_ms(start), malloc_count);
+    sypha_list_destroy(merged);
+
+    for (size_t p=0;p < MERGE_PARTS;p++) {
+        sypha_list_destroy(parts[p]);
+    }
+}
+
+static int cmp_record(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+    unsigned int ka = *((const unsigned int *) a), kb = *((const unsigned int *) b);
+    return (ka > kb) - (ka < kb);
+}
+
+static int qsort_record(const void * a, const void * b) {
+    return cmp_record(a, ITEM_SZ, b, ITEM_SZ, NULL);
+}
+
+// Pooled so every list starts out laid out in order, not in whatever order the last one freed
+static SYPHA_LIST random_record_list() {
+    unsigned char record[ITEM_SZ];
+    SYPHA_LIST list = sypha_list_create_pooled(ITEM_SZ, 4096);
+
+    srand(1);
+    memset(record, 0x0, sizeof(record));
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        *((unsigned int *) record) = (unsigned int) rand();
+        sypha_list_append_item(list, record, sizeof(record));
+    }
+    return list;
+}
+
+// Sorting by copying out to an array, qsort and rebuilding vs sorting in place
+static void bench_sort() {
+    SYPHA_LIST list, sorted;
+    SYPHA_LIST_ITERATOR iterator;
+    unsigned char * records;
+    size_t value_sz, i = 0;
+    char name[64];
+
+    list = random_record_list();
+    malloc_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    records = (unsigned char *) malloc(ITEM_COUNT * ITEM_SZ);
+    iterator = sypha_list_get_iterator_front(list);
+    while (sypha_list_iterator_next(iterator) == 0) {
+        memcpy(records + (i++ * ITEM_SZ), sypha_list_iterator_get(iterator, &value_sz), ITEM_SZ);
+    }
+    sypha_list_destroy_iterator(iterator);
+    qsort(records, ITEM_COUNT, ITEM_SZ, qsort_record);
+    sorted = sypha_list_create();
+    sypha_list_append_many(sorted, records, ITEM_SZ, ITEM_COUNT);
+    free(records);
+    sypha_list_destroy(list);
+    report("qsort + rebuild", "sort", elapsed_ms(start), malloc_count);
+    sypha_list_destroy(sorted);
+
+    list = random_record_list();
+    malloc_count = 0;
+    start = std::chrono::steady_clock::now();
+    sypha_list_sort(list, cmp_record, NULL);
+    report("sypha_list_sort", "sort", elapsed_ms(start), malloc_count);
+
+    // and again on the now sorted list
+    start = std::chrono::steady_clock::now();
+    sypha_list_sort(list, cmp_record, NULL);
+    report("sypha_list_sort (sorted)", "sort", elapsed_ms(start), 0);
+    sypha_list_destroy(list);
+
+    for (size_t nthreads : { 2, 4, 8 }) {
+        list = random_record_list();
+        snprintf(name, sizeof(name), "sort_parallel (%zu)", nthreads);
+        start = std::chrono::steady_clock::now();
+        sypha_list_sort_parallel(list, cmp_record, NULL, nthreads);
+        report(name, "sort", elapsed_ms(start), 0);
+        sypha_list_destroy(list);
+    }
+}
+
+// Some made up CPU heavy work per item
+static void crunch(void * data, size_t data_sz, void * ctx) {
+    unsigned int * value = (unsigned int *) data;
+    for (int i=0;i < 200;i++) {
+        *value = *value * 1664525u + 1013904223u;
+    }
+}
+
+// Walking the list with an iterator vs sypha_list_parallel_for_each on pools of a few sizes
+static void bench_for_each() {
+    SYPHA_LIST list = random_record_list();
+    SYPHA_LIST_ITERATOR iterator;
+    size_t value_sz;
+    char name[64];
+
+    auto start = std::chrono::steady_clock::now();
+    iterator = sypha_list_get_iterator_front(list);
+    while (sypha_list_iterator_next(iterator) == 0) {
+        crunch(sypha_list_iterator_get(iterator, &value_sz), value_sz, NULL);
+    }
+    sypha_list_destroy_iterator(iterator);
+    report("iterator", "for_each", elapsed_ms(start), 0);
+
+    for (size_t nthreads : { 1, 2, 4, 8 }) {
+        SYPHA_POOL pool = sypha_pool_create(nthreads);
+        snprintf(name, sizeof(name), "parallel (%zu threads)", nthreads);
+        start = std::chrono::steady_clock::now();
+        sypha_list_parallel_for_each(list, pool, crunch, NULL);
+        report(name, "for_each", elapsed_ms(start), 0);
+        sypha_pool_destroy(pool);
+    }
+
+    sypha_list_destroy(list);
+}
+
+// Per-request lists of REQUEST_ITEMS built, read once and thrown away, ITEM_COUNT items in all
+static void bench_request(const char * name, SYPHA_ARENA arena) {
+    unsigned char record[ITEM_SZ];
+    unsigned long long sum = 0;
+    SYPHA_LIST list;
+    SYPHA_LIST_ITERATOR iterator;
+    size_t value_sz;
+
+    memset(record, 0x0, sizeof(record));
+    malloc_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t request=0;request < ITEM_COUNT / REQUEST_ITEMS;request++) {
+        list = (arena) ? sypha_list_create_in_arena(arena) : sypha_list_create();
+        for (size_t i=0;i < REQUEST_ITEMS;i++) {
+            record[0] = (unsigned char) i;
+            sypha_list_append_item(list, record, sizeof(record));
+        }
+        iterator = sypha_list_get_read_iterator_front(list);
+        while (sypha_list_iterator_next(iterator) == 0) {
+            sum += ((unsigned char *) sypha_list_iterator_get(iterator, &value_sz))[0];
+        }
+        sypha_list_destroy_iterator(iterator);
+        sypha_list_destroy(list);
+        if (arena) {
+            sypha_arena_reset(arena);
+        }
+    }
+    report(name, "request", elapsed_ms(start), malloc_count);
+
+    sink = sum;
+}
+
+// Heap bytes per element for small handles
+static void bench_footprint(size_t payload_sz) {
+    unsigned char record[ITEM_SZ];
+    struct ref_list ref = { NULL, NULL };
+    SYPHA_LIST list;
+
+    memset(record, 0x0, sizeof(record));
+    printf("%zu byte payload:", payload_sz);
+
+    malloc_bytes = 0;
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        ref_list_append(&ref, record, payload_sz);
+    }
+    printf(" reference %.1f B/item,", ((double) malloc_bytes) / ITEM_COUNT);
+    ref_list_destroy(&ref);
+
+    list = sypha_list_create();
+    malloc_bytes = 0;
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        sypha_list_append_item(list, record, payload_sz);
+    }
+    printf(" sypha_list %.1f B/item,", ((double) malloc_bytes) / ITEM_COUNT);
+    sypha_list_destroy(list);
+
+    list = sypha_list_create_pooled(payload_sz, 1024);
+    malloc_bytes = 0;
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        sypha_list_append_item(list, record, payload_sz);
+    }
+    printf(" pooled %.1f B/item\n", ((double) malloc_bytes) / ITEM_COUNT);
+    sypha_list_destroy(list);
+}
+
+static void report_sorted(const char * name, double ms) {
+    printf("%-24s %-8s %10.2f ms %10.2f Mitems/s (%d items)\n", name, "sorted", ms, (SORTED_COUNT / 1000.0) / ms, SORTED_COUNT);
+}
+
+// Keeping items sorted as they arrive: a list needs a scan for every insert, the skip list
+// a search
+static void bench_sorted_insert() {
+    unsigned char record[ITEM_SZ];
+    SYPHA_LIST list = sypha_list_create();
+    SYPHA_LIST_ITERATOR iterator;
+    SYPHA_SKIPLIST skiplist = sypha_skiplist_create(cmp_record, NULL);
+    size_t data_sz;
+    int inserted;
+
+    memset(record, 0x0, sizeof(record));
+    srand(1);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < SORTED_COUNT;i++) {
+        *((unsigned int *) record) = (unsigned int) rand();
+        inserted = 0;
+        iterator = sypha_list_get_iterator_front(list);
+        while (!inserted && sypha_list_iterator_next(iterator) == 0) {
+            if (cmp_record(sypha_list_iterator_get(iterator, &data_sz), data_sz, record, ITEM_SZ, NULL) > 0) {
+                sypha_list_iterator_insert_before(iterator, record, sizeof(record));
+                inserted = 1;
+            }
+        }
+        sypha_list_destroy_iterator(iterator);
+        if (!inserted) {
+            sypha_list_append_item(list, record, sizeof(record));
+        }
+    }
+    report_sorted("sypha_list (scan)", elapsed_ms(start));
+    sypha_list_destroy(list);
+
+    srand(1);
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < SORTED_COUNT;i++) {
+        *((unsigned int *) record) = (unsigned int) rand();
+        sypha_skiplist_insert(skiplist, record, sizeof(record));
+    }
+    report_sorted("sypha_skiplist", elapsed_ms(start));
+    sypha_skiplist_destroy(skiplist);
+}
+
+// Queue-like churn: append at back, delete at front, keeping QUEUE_DEPTH items around
+static void bench_churn(const char * name, SYPHA_LIST list) {
+    unsigned char record[ITEM_SZ];
+    SYPHA_LIST_ITERATOR iterator;
+
+    memset(record, 0x0, sizeof(record));
+    for (size_t i=0;i < QUEUE_DEPTH;i++) {
+        sypha_list_append_item(list, record, sizeof(record));
+    }
+
+    malloc_count = 0;
+    iterator = sypha_list_get_iterator_front(list);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        sypha_list_append_item(list, record, sizeof(record));
+        sypha_list_iterator_next(iterator);
+        sypha_list_iterator_delete_current(iterator);
+    }
+    report(name, "churn", elapsed_ms(start), malloc_count);
+    sypha_list_destroy_iterator(iterator);
+
+    sypha_list_destroy(list);
+}
+
+// Same churn through a deque, which stops allocating once its ring covers QUEUE_DEPTH
+static void bench_deque_churn() {
+    SYPHA_DEQUE deque = sypha_deque_create(ITEM_SZ);
+    unsigned char record[ITEM_SZ];
+
+    memset(record, 0x0, sizeof(record));
+    for (size_t i=0;i < QUEUE_DEPTH;i++) {
+        sypha_deque_push_back(deque, record);
+    }
+
+    malloc_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < ITEM_COUNT;i++) {
+        sypha_deque_push_back(deque, record);
+        sypha_deque_pop_front(deque, record);
+    }
+    report("sypha_deque", "churn", elapsed_ms(start), malloc_count);
+
+    sypha_deque_destroy(deque);
+}
+
+int main(int argc, char ** argv) {
+    printf("%d items of %d bytes\n", ITEM_COUNT, ITEM_SZ);
+    bench_reference();
+    bench_sypha_list();
+    bench_load();
+    bench_merge();
+    bench_sort();
+    bench_sorted_insert();
+    bench_for_each();
+    bench_request("sypha_list", NULL);
+    SYPHA_ARENA arena = sypha_arena_create(0);
+    bench_request("sypha_list (arena)", arena);
+    sypha_arena_destroy(arena);
+    bench_churn("sypha_list", sypha_list_create());
+    bench_churn("sypha_list (pooled)", sypha_list_create_pooled(ITEM_SZ, 256));
+    bench_deque_churn();
+    bench_footprint(8);
+    bench_footprint(16);
+    return 0;
+}
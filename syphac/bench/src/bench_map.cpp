@@ -0,0 +1,117 @@
+/* bench_map.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+// Compares sypha_map against std::unordered_map for short string keys mapping to 8 byte values:
+// inserts, hits, misses and deletes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "syphac/sypha_map.h"
+
+#define KEY_COUNT       1000000
+
+// Keeps the lookups from being optimized away
+static volatile unsigned long long sink = 0;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char * name, const char * op, double ms, size_t count) {
+    printf("%-24s %-14s %10.2f ms %10.2f Mops/s\n", name, op, ms, (count / 1000.0) / ms);
+}
+
+static void bench_sypha_map(const std::vector<std::string> & keys, const std::vector<std::string> & misses) {
+    SYPHA_MAP map = sypha_map_create();
+    unsigned long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i=0;i < keys.size();i++) {
+        sypha_map_put(map, keys[i].data(), keys[i].size(), &i, sizeof(i));
+    }
+    report("sypha_map", "insert", elapsed_ms(start), keys.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < keys.size();i++) {
+        sum += *((unsigned long long *) sypha_map_get(map, keys[i].data(), keys[i].size(), NULL));
+    }
+    report("sypha_map", "hit", elapsed_ms(start), keys.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < misses.size();i++) {
+        sum += (sypha_map_get(map, misses[i].data(), misses[i].size(), NULL) == NULL);
+    }
+    report("sypha_map", "miss", elapsed_ms(start), misses.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < keys.size();i++) {
+        sum += sypha_map_delete(map, keys[i].data(), keys[i].size());
+    }
+    report("sypha_map", "delete", elapsed_ms(start), keys.size());
+
+    sypha_map_destroy(map);
+    sink = sum;
+}
+
+static void bench_unordered_map(const std::vector<std::string> & keys, const std::vector<std::string> & misses) {
+    std::unordered_map<std::string, unsigned long long> map;
+    unsigned long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i=0;i < keys.size();i++) {
+        map[keys[i]] = i;
+    }
+    report("std::unordered_map", "insert", elapsed_ms(start), keys.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < keys.size();i++) {
+        sum += map.find(keys[i])->second;
+    }
+    report("std::unordered_map", "hit", elapsed_ms(start), keys.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < misses.size();i++) {
+        sum += (map.find(misses[i]) == map.end());
+    }
+    report("std::unordered_map", "miss", elapsed_ms(start), misses.size());
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < keys.size();i++) {
+        sum += map.erase(keys[i]);
+    }
+    report("std::unordered_map", "delete", elapsed_ms(start), keys.size());
+
+    sink = sum;
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> keys;
+    std::vector<std::string> misses;
+
+    for (size_t i=0;i < KEY_COUNT;i++) {
+        keys.push_back("key:" + std::to_string(i * 2654435761ULL));
+        misses.push_back("miss:" + std::to_string(i));
+    }
+
+    bench_sypha_map(keys, misses);
+    bench_unordered_map(keys, misses);
+    return 0;
+}
@@ -0,0 +1,125 @@
+/* bench_mpmc_queue.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+// Producer / consumer throughput of sypha_mpmc_queue against a bounded queue built on a mutex
+// and condition variables (what queue.Queue does) from 1 to 64 threads.  Half the threads
+// produce and half consume, a single thread does both in turn.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "syphac/sypha_mpmc_queue.h"
+
+#define ITEM_COUNT      2000000
+#define QUEUE_CAPACITY  1024
+
+// Keeps the pops from being optimized away
+static volatile unsigned long long sink = 0;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char * name, int threads, double ms) {
+    printf("%-24s %3d threads %10.2f ms %10.2f Mitems/s\n", name, threads, ms, (ITEM_COUNT / 1000.0) / ms);
+}
+
+// The locking baseline
+class LockedQueue {
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+        std::deque<unsigned long long> m_items;
+
+    public:
+        void push(unsigned long long item) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_full.wait(lock, [this]() { return m_items.size() < QUEUE_CAPACITY; });
+            m_items.push_back(item);
+            m_not_empty.notify_one();
+        }
+
+        unsigned long long pop() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_empty.wait(lock, [this]() { return !m_items.empty(); });
+            unsigned long long item = m_items.front();
+            m_items.pop_front();
+            m_not_full.notify_one();
+            return item;
+        }
+};
+
+// Runs threads / 2 producers and as many consumers over ITEM_COUNT items
+template <typename Push, typename Pop>
+static double run(int threads, Push push, Pop pop) {
+    std::vector<std::thread> workers;
+    int pairs = (threads > 1) ? threads / 2 : 1;
+    size_t per_thread = ITEM_COUNT / pairs;
+
+    auto start = std::chrono::steady_clock::now();
+    if (threads == 1) {
+        unsigned long long sum = 0;
+        for (size_t i=0;i < ITEM_COUNT;i++) {
+            push(i);
+            sum += pop();
+        }
+        sink = sum;
+    } else {
+        for (int p=0;p < pairs;p++) {
+            workers.emplace_back([&push, per_thread]() {
+                for (size_t i=0;i < per_thread;i++) {
+                    push(i);
+                }
+            });
+            workers.emplace_back([&pop, per_thread]() {
+                unsigned long long sum = 0;
+                for (size_t i=0;i < per_thread;i++) {
+                    sum += pop();
+                }
+                sink = sum;
+            });
+        }
+        for (auto & worker : workers) {
+            worker.join();
+        }
+    }
+    return elapsed_ms(start);
+}
+
+int main(int argc, char ** argv) {
+    printf("%d items through a %d slot queue, %u hardware threads\n", ITEM_COUNT, QUEUE_CAPACITY, std::thread::hardware_concurrency());
+
+    for (int threads=1;threads <= 64;threads *= 2) {
+        SYPHA_MPMC_QUEUE queue = sypha_mpmc_queue_create(sizeof(unsigned long long), QUEUE_CAPACITY);
+        report("sypha_mpmc_queue", threads, run(threads,
+            [queue](unsigned long long item) { sypha_mpmc_queue_push(queue, &item); },
+            [queue]() { unsigned long long item; sypha_mpmc_queue_pop(queue, &item); return item; }));
+        sypha_mpmc_queue_destroy(queue);
+
+        LockedQueue locked;
+        report("mutex + condvar", threads, run(threads,
+            [&locked](unsigned long long item) { locked.push(item); },
+            [&locked]() { return locked.pop(); }));
+    }
+    return 0;
+}
@@ -0,0 +1,257 @@
+/* bench_ulist.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+// Compares scan and insert costs of the unrolled and compact lists and the vector against
+// sypha_list for fixed size elements, and the heap against std::priority_queue.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "syphac/sypha_clist.h"
+#include "syphac/sypha_heap.h"
+#include "syphac/sypha_list.h"
+#include "syphac/sypha_ulist.h"
+#include "syphac/sypha_vec.h"
+
+#define SCAN_COUNT      10000000
+#define INSERT_COUNT    1000000
+
+// Keeps the scans from being optimized away
+static volatile unsigned long long sink = 0;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char * name, const char * op, double ms, size_t count) {
+    printf("%-24s %-14s %10.2f ms %10.2f Mitems/s %8.2f MB/s\n", name, op, ms, (count / 1000.0) / ms,
+        ((count * sizeof(unsigned long long)) / (1024.0 * 1024.0)) / (ms / 1000.0));
+}
+
+static void bench_sypha_list() {
+    SYPHA_LIST list = sypha_list_create();
+    SYPHA_LIST_ITERATOR iterator;
+    unsigned long long sum = 0;
+    size_t value_sz;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i=0;i < SCAN_COUNT;i++) {
+        sypha_list_append_item(list, &i, sizeof(i));
+    }
+    report("sypha_list", "append", elapsed_ms(start), SCAN_COUNT);
+
+    iterator = sypha_list_get_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while (sypha_list_iterator_next(iterator) == 0) {
+        sum += *((unsigned long long *) sypha_list_iterator_get(iterator, &value_sz));
+    }
+    report("sypha_list", "scan", elapsed_ms(start), SCAN_COUNT);
+    sypha_list_destroy_iterator(iterator);
+    sypha_list_destroy(list);
+
+    // Insert after every item of a smaller list, doubling it
+    list = sypha_list_create();
+    for (unsigned long long i=0;i < INSERT_COUNT;i++) {
+        sypha_list_append_item(list, &i, sizeof(i));
+    }
+    iterator = sypha_list_get_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while (sypha_list_iterator_next(iterator) == 0) {
+        sypha_list_iterator_insert_after(iterator, &sum, sizeof(sum));
+        sypha_list_iterator_next(iterator);
+    }
+    report("sypha_list", "insert_after", elapsed_ms(start), INSERT_COUNT);
+    sypha_list_destroy_iterator(iterator);
+    sypha_list_destroy(list);
+
+    sink = sum;
+}
+
+static void bench_sypha_ulist(size_t elems_per_node) {
+    SYPHA_ULIST list = sypha_ulist_create(sizeof(unsigned long long), elems_per_node);
+    SYPHA_ULIST_ITERATOR iterator;
+    unsigned long long sum = 0;
+    char name[64];
+
+    snprintf(name, sizeof(name), "sypha_ulist (%zu/node)", elems_per_node);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i=0;i < SCAN_COUNT;i++) {
+        sypha_ulist_append_item(list, &i);
+    }
+    report(name, "append", elapsed_ms(start), SCAN_COUNT);
+
+    iterator = sypha_ulist_get_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while (sypha_ulist_iterator_next(iterator) == 0) {
+        sum += *((unsigned long long *) sypha_ulist_iterator_get(iterator));
+    }
+    report(name, "scan", elapsed_ms(start), SCAN_COUNT);
+    sypha_ulist_destroy_iterator(iterator);
+    sypha_ulist_destroy(list);
+
+    list = sypha_ulist_create(sizeof(unsigned long long), elems_per_node);
+    for (unsigned long long i=0;i < INSERT_COUNT;i++) {
+        sypha_ulist_append_item(list, &i);
+    }
+    iterator = sypha_ulist_get_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while (sypha_ulist_iterator_next(iterator) == 0) {
+        sypha_ulist_iterator_insert_after(iterator, &sum);
+        sypha_ulist_iterator_next(iterator);
+    }
+    report(name, "insert_after", elapsed_ms(start), INSERT_COUNT);
+    sypha_ulist_destroy_iterator(iterator);
+    sypha_ulist_destroy(list);
+
+    sink = sum;
+}
+
+static void bench_sypha_clist() {
+    SYPHA_CLIST list = sypha_clist_create(sizeof(unsigned long long));
+    SYPHA_CLIST_ITERATOR iterator;
+    unsigned long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i=0;i < SCAN_COUNT;i++) {
+        sypha_clist_append_item(list, &i);
+    }
+    report("sypha_clist", "append", elapsed_ms(start), SCAN_COUNT);
+    printf("%-24s %-14s %10.2f bytes/item\n", "sypha_clist", "footprint", ((double) sypha_clist_serialized_sz(list)) / SCAN_COUNT);
+
+    iterator = sypha_clist_get_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while (sypha_clist_iterator_next(iterator) == 0) {
+        sum += *((unsigned long long *) sypha_clist_iterator_get(iterator));
+    }
+    report("sypha_clist", "scan", elapsed_ms(start), SCAN_COUNT);
+    sypha_clist_destroy_iterator(iterator);
+    sypha_clist_destroy(list);
+
+    list = sypha_clist_create(sizeof(unsigned long long));
+    for (unsigned long long i=0;i < INSERT_COUNT;i++) {
+        sypha_clist_append_item(list, &i);
+    }
+    iterator = sypha_clist_get_iterator_front(list);
+    start = std::chrono::steady_clock::now();
+    while (sypha_clist_iterator_next(iterator) == 0) {
+        sypha_clist_iterator_insert_after(iterator, &sum);
+        sypha_clist_iterator_next(iterator);
+    }
+    report("sypha_clist", "insert_after", elapsed_ms(start), INSERT_COUNT);
+    sypha_clist_destroy_iterator(iterator);
+    sypha_clist_destroy(list);
+
+    sink = sum;
+}
+
+static void bench_sypha_vec() {
+    SYPHA_VEC vec = sypha_vec_create(sizeof(unsigned long long));
+    SYPHA_VEC_ITERATOR iterator;
+    unsigned long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i=0;i < SCAN_COUNT;i++) {
+        sypha_vec_append_item(vec, &i);
+    }
+    report("sypha_vec", "append", elapsed_ms(start), SCAN_COUNT);
+
+    iterator = sypha_vec_get_iterator_front(vec);
+    start = std::chrono::steady_clock::now();
+    while (sypha_vec_iterator_next(iterator) == 0) {
+        sum += *((unsigned long long *) sypha_vec_iterator_get(iterator, NULL));
+    }
+    report("sypha_vec", "scan", elapsed_ms(start), SCAN_COUNT);
+    sypha_vec_destroy_iterator(iterator);
+
+    unsigned long long * elems = (unsigned long long *) sypha_vec_data(vec);
+    start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < sypha_vec_count(vec);i++) {
+        sum += elems[i];
+    }
+    report("sypha_vec", "scan (data)", elapsed_ms(start), SCAN_COUNT);
+    sypha_vec_destroy(vec);
+
+    sink = sum;
+}
+
+static int cmp_deadline(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+    unsigned long long a_deadline = *((const unsigned long long *) a);
+    unsigned long long b_deadline = *((const unsigned long long *) b);
+    return (a_deadline > b_deadline) - (a_deadline < b_deadline);
+}
+
+// Timer queue: push INSERT_COUNT random deadlines, then pop them all in order
+static void bench_sypha_heap() {
+    SYPHA_HEAP heap = sypha_heap_create(sizeof(unsigned long long), cmp_deadline, NULL);
+    unsigned long long deadline;
+    unsigned long long sum = 0;
+
+    srand(1);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < INSERT_COUNT;i++) {
+        deadline = (unsigned long long) rand();
+        sypha_heap_push(heap, &deadline, NULL);
+    }
+    report("sypha_heap", "push", elapsed_ms(start), INSERT_COUNT);
+
+    start = std::chrono::steady_clock::now();
+    while (sypha_heap_pop(heap, &deadline) == 0) {
+        sum += deadline;
+    }
+    report("sypha_heap", "pop", elapsed_ms(start), INSERT_COUNT);
+
+    sypha_heap_destroy(heap);
+    sink = sum;
+}
+
+static void bench_priority_queue() {
+    std::priority_queue<unsigned long long, std::vector<unsigned long long>, std::greater<unsigned long long>> queue;
+    unsigned long long sum = 0;
+
+    srand(1);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i=0;i < INSERT_COUNT;i++) {
+        queue.push((unsigned long long) rand());
+    }
+    report("std::priority_queue", "push", elapsed_ms(start), INSERT_COUNT);
+
+    start = std::chrono::steady_clock::now();
+    while (!queue.empty()) {
+        sum += queue.top();
+        queue.pop();
+    }
+    report("std::priority_queue", "pop", elapsed_ms(start), INSERT_COUNT);
+
+    sink = sum;
+}
+
+int main(int argc, char ** argv) {
+    printf("scan over %d items, insert into %d items, 8 byte elements\n", SCAN_COUNT, INSERT_COUNT);
+    bench_sypha_list();
+    bench_sypha_ulist(8);
+    bench_sypha_ulist(29);
+    bench_sypha_ulist(128);
+    bench_sypha_clist();
+    bench_sypha_vec();
+    bench_sypha_heap();
+    bench_priority_queue();
+    return 0;
+}
@@ -22,8 +22,20 @@
 extern "C" {
 #endif // __cplusplus
 
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_clist.h"
+#include "syphac/sypha_deque.h"
 #include "syphac/sypha_env.h"
+#include "syphac/sypha_heap.h"
+#include "syphac/sypha_list.h"
+#include "syphac/sypha_map.h"
+#include "syphac/sypha_mpmc_queue.h"
 #include "syphac/sypha_opt.h"
+#include "syphac/sypha_pool.h"
+#include "syphac/sypha_skiplist.h"
+#include "syphac/sypha_ulist.h"
+#include "syphac/sypha_vec.h"
 
 #if defined __cplusplus
 }
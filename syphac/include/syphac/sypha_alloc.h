@@ -0,0 +1,60 @@
+/* sypha_alloc.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/* Pluggable memory allocation for the sypha containers.  Every container takes a copy of an
+ * allocator when it is created (or of the process-wide default if none is given) and routes all
+ * of its allocations through it, so the allocator must outlive anything created with it.
+ */
+
+#ifndef _SYPHA_ALLOC_H_
+#define _SYPHA_ALLOC_H_
+
+#include <stdlib.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Allocator vtable.  The functions follow malloc / realloc / free semantics and get handed
+// ctx as their first argument (e.g. a per-thread arena).
+typedef struct _sypha_allocator {
+    void * (*alloc)(void * ctx, size_t sz);
+    void * (*realloc)(void * ctx, void * ptr, size_t sz);
+    void (*free)(void * ctx, void * ptr);
+    void * ctx;
+} SYPHA_ALLOCATOR;
+
+// Replaces the process-wide default allocator with a copy of allocator, NULL restores plain
+// malloc / realloc / free.  Containers copy the default when created so set this up front.
+extern void sypha_allocator_set_default(const SYPHA_ALLOCATOR * allocator);
+
+// Returns the current process-wide default allocator
+extern const SYPHA_ALLOCATOR * sypha_allocator_get_default();
+
+// Copies a c-string using allocator, returns NULL on error
+extern char * sypha_allocator_strdup(const SYPHA_ALLOCATOR * allocator, const char * str);
+
+// Call through an allocator
+#define sypha_alloc(allocator, sz)             ((allocator)->alloc((allocator)->ctx, (sz)))
+#define sypha_realloc(allocator, ptr, sz)      ((allocator)->realloc((allocator)->ctx, (ptr), (sz)))
+#define sypha_free(allocator, ptr)             ((allocator)->free((allocator)->ctx, (ptr)))
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_ALLOC_H_
@@ -0,0 +1,84 @@
+/* sypha_arena.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/* Bump allocation out of big chunks.  Allocating is a pointer bump, freeing a single block does
+ * nothing, and everything goes at once on reset or destroy.  Reset keeps the chunks around for the
+ * next round, so an arena reused for similar sized work stops allocating once it has warmed up.
+ * Not thread safe.
+ */
+
+#ifndef _SYPHA_ARENA_H_
+#define _SYPHA_ARENA_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague arena object
+typedef void * SYPHA_ARENA;
+
+// A point in the arena's allocations to rewind to
+typedef struct _sypha_arena_mark {
+    void * chunk;
+    void * next;
+    void * oversized;
+} SYPHA_ARENA_MARK;
+
+// Creates an empty arena carving blocks out of chunk_sz sized chunks, 0 for the default of 64KB.
+// Blocks too big to share a chunk get one of their own.  Returns NULL on error.
+extern SYPHA_ARENA sypha_arena_create(size_t chunk_sz);
+
+// Same as sypha_arena_create but the chunks come from allocator, NULL means the default
+extern SYPHA_ARENA sypha_arena_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t chunk_sz);
+
+// Releases the arena and everything allocated from it
+extern void sypha_arena_destroy(SYPHA_ARENA arena);
+
+// Returns a 16 byte aligned block of sz bytes, or NULL on allocation error
+extern void * sypha_arena_alloc(SYPHA_ARENA arena, size_t sz);
+
+// Releases everything allocated from the arena at once.  Regular chunks are kept for reuse, only
+// the oversized ones are given back.
+extern void sypha_arena_reset(SYPHA_ARENA arena);
+
+// Remembers where the arena is at
+extern SYPHA_ARENA_MARK sypha_arena_mark(SYPHA_ARENA arena);
+
+// Releases everything allocated from the arena since mark was taken, anything from before it stays
+extern void sypha_arena_rewind(SYPHA_ARENA arena, SYPHA_ARENA_MARK mark);
+
+// Fills in an allocator that allocates from the arena, for handing to the containers.  Its free
+// does nothing.  Its blocks keep their size in 16 bytes in front of them so realloc can grow any
+// of them, in place when nothing has been allocated since or else by copying into a new block.
+extern void sypha_arena_get_allocator(SYPHA_ARENA arena, SYPHA_ALLOCATOR * allocator);
+
+// Whether allocator is one handed out by sypha_arena_get_allocator, returns the arena or NULL
+extern SYPHA_ARENA sypha_arena_from_allocator(const SYPHA_ALLOCATOR * allocator);
+
+// Fills in scratch with what a container on allocator should use for short lived allocations like
+// iterators: allocator itself, or the current default if it's an arena's, which would only get
+// them back on reset
+extern void sypha_arena_scratch_allocator(const SYPHA_ALLOCATOR * allocator, SYPHA_ALLOCATOR * scratch);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_ARENA_H_
@@ -0,0 +1,115 @@
+/* sypha_clist.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Compact variant of sypha_list for huge numbers of fixed size elements.  The nodes live in one
+ * growable array and link to each other with 32 bit indices instead of pointers, so a node costs
+ * 8 bytes on top of its element and the whole list can be moved, copied or written out as is.
+ * Deleted nodes are recycled for later inserts, the array only grows until the list is destroyed.
+ * The iterator follows the same conventions as the sypha_list one: a "next" call is needed to
+ * get to the first item, "previous" / "next" are from the perspective of the iterator's
+ * direction and deleting repositions to the previous item.
+ *
+ * Inserting can move the node array, so pointers returned by get are only good until the next
+ * insert.  Iterators hold indices and stay put, but one left on an item deleted through another
+ * iterator is undefined.  Elements are 4 byte aligned, 8 byte aligned when elem_sz is a
+ * multiple of 8.
+ */
+
+#ifndef _SYPHA_CLIST_H_
+#define _SYPHA_CLIST_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague compact list object
+typedef void * SYPHA_CLIST;
+
+// Opague compact list iterator object
+typedef void * SYPHA_CLIST_ITERATOR;
+
+// Most elements a compact list can hold
+#define SYPHA_CLIST_MAX_COUNT   0xfffffffeUL
+
+// Creates an empty list of elem_sz sized elements.  Returns NULL on error.
+extern SYPHA_CLIST sypha_clist_create(size_t elem_sz);
+
+// Same as sypha_clist_create but all allocations go through allocator, NULL means the default.
+// The node array grows with realloc, so the allocator needs a working one.
+extern SYPHA_CLIST sypha_clist_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz);
+
+// Releases all allocated resources for the list
+extern void sypha_clist_destroy(SYPHA_CLIST list);
+
+// Number of elements in the list
+extern size_t sypha_clist_count(SYPHA_CLIST list);
+
+// Grows the node array to hold at least count elements up front, so a list of known size is
+// built without repeated reallocation.  Returns 0 on success, otherwise < 0.
+extern int sypha_clist_reserve(SYPHA_CLIST list, size_t count);
+
+// Insert a copy of the elem_sz bytes at data into the list
+    // Add item to end of list, returns 0 if item added, otherwise < 0
+extern int sypha_clist_append_item(SYPHA_CLIST list, void * data);
+    // Add item to front of list, returns 0 if item added, otherwise < 0
+extern int sypha_clist_prepend_item(SYPHA_CLIST list, void * data);
+
+// Serializing.  The image is the node array plus a small header, in the host's byte order, so
+// writing it out and reading it back is a straight copy.
+    // Size of the image of the list in bytes
+extern size_t sypha_clist_serialized_sz(SYPHA_CLIST list);
+    // Writes the image of the list to buffer, which has to hold sypha_clist_serialized_sz bytes
+extern void sypha_clist_serialize(SYPHA_CLIST list, void * buffer);
+    // Creates a list from an image written by sypha_clist_serialize, allocations go through
+    // allocator, NULL means the default.  Returns NULL on error or if the image doesn't add up.
+extern SYPHA_CLIST sypha_clist_create_from_serialized(const SYPHA_ALLOCATOR * allocator, const void * buffer, size_t buffer_sz);
+
+// Get iterators for the list.  Positioned before the first item.
+    // Forward iterator from beginning of the list
+extern SYPHA_CLIST_ITERATOR sypha_clist_get_iterator_front(SYPHA_CLIST list);
+    // Backward iterator from end of the list
+extern SYPHA_CLIST_ITERATOR sypha_clist_get_iterator_back(SYPHA_CLIST list);
+    // Release all iterator resources
+extern void sypha_clist_destroy_iterator(SYPHA_CLIST_ITERATOR iterator);
+
+// Get current item in list, returns NULL if empty list OR iterator if before first item
+extern void * sypha_clist_iterator_get(SYPHA_CLIST_ITERATOR iterator);
+
+// Move to "next" item in list from perspective of forward / backward iterator.
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_clist_iterator_next(SYPHA_CLIST_ITERATOR iterator);
+
+// Move to "previous" item in list from perspective of forward / backward iterator
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_clist_iterator_previous(SYPHA_CLIST_ITERATOR iterator);
+
+// Adding / removing list items via the iterator
+    // Insert new item after current item, returns 0 if item added, otherwise < 0
+extern int sypha_clist_iterator_insert_after(SYPHA_CLIST_ITERATOR iterator, void * data);
+    // Insert new item before current item, returns 0 if item added, otherwise < 0
+extern int sypha_clist_iterator_insert_before(SYPHA_CLIST_ITERATOR iterator, void * data);
+    // Delete the current item, repositioning iterator to previous item to make a "next" call sane
+    // returns 0 if item removed, otherwise < 0
+extern int sypha_clist_iterator_delete_current(SYPHA_CLIST_ITERATOR iterator);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_CLIST_H_
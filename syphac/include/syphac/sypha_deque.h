@@ -0,0 +1,86 @@
+/* sypha_deque.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Double-ended queue of fixed size elements.  Elements live in fixed size blocks arranged in a
+ * power of 2 ring, so pushing and popping at either end is O(1), and once the ring is big enough
+ * for the queue's depth it allocates nothing: popped blocks are kept for the next pushes.  Any
+ * element can be reached by index in O(1).
+ *
+ * Pointers returned by at / front / back are good until the element is popped or the deque
+ * grows.
+ */
+
+#ifndef _SYPHA_DEQUE_H_
+#define _SYPHA_DEQUE_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague deque object
+typedef void * SYPHA_DEQUE;
+
+// Creates an empty deque of elem_sz sized elements.  Returns NULL on error.
+extern SYPHA_DEQUE sypha_deque_create(size_t elem_sz);
+
+// Same as sypha_deque_create but all allocations go through allocator, NULL means the default
+extern SYPHA_DEQUE sypha_deque_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz);
+
+// Releases all allocated resources for the deque
+extern void sypha_deque_destroy(SYPHA_DEQUE deque);
+
+// Number of elements in the deque
+extern size_t sypha_deque_count(SYPHA_DEQUE deque);
+
+// Number of elements the ring holds before it has to grow
+extern size_t sypha_deque_capacity(SYPHA_DEQUE deque);
+
+// Grows the ring to hold at least count elements.  Returns 0 on success, otherwise < 0.
+extern int sypha_deque_reserve(SYPHA_DEQUE deque, size_t count);
+
+// Frees the blocks not holding any elements, the ring keeps its size
+extern void sypha_deque_shrink(SYPHA_DEQUE deque);
+
+// Drops every element, keeping the blocks for reuse
+extern void sypha_deque_clear(SYPHA_DEQUE deque);
+
+// Add a copy of the elem_sz bytes at data, returns 0 if added, otherwise < 0
+    // Add to the back
+extern int sypha_deque_push_back(SYPHA_DEQUE deque, const void * data);
+    // Add to the front
+extern int sypha_deque_push_front(SYPHA_DEQUE deque, const void * data);
+
+// Remove an element, copying it to data unless NULL.  Returns 0 if removed, < 0 if empty.
+    // Remove from the back
+extern int sypha_deque_pop_back(SYPHA_DEQUE deque, void * data);
+    // Remove from the front
+extern int sypha_deque_pop_front(SYPHA_DEQUE deque, void * data);
+
+// The element at index counting from the front, NULL if out of range
+extern void * sypha_deque_at(SYPHA_DEQUE deque, size_t index);
+
+// The first / last element, NULL if empty
+extern void * sypha_deque_front(SYPHA_DEQUE deque);
+extern void * sypha_deque_back(SYPHA_DEQUE deque);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_DEQUE_H_
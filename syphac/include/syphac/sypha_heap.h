@@ -0,0 +1,93 @@
+/* sypha_heap.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Priority queue of fixed size elements, smallest first by a user comparator.  A 4-ary heap in
+ * one array: a node's children sit next to each other, so sifting down compares a cache line's
+ * worth of siblings per level and the tree is half as deep as a binary heap.  Push, pop, update
+ * and remove are O(log n), peek is O(1) and push_many heapifies in O(n).
+ *
+ * Every element gets a handle when pushed that keeps naming it while it moves around the heap,
+ * for changing its priority or taking it out early (timer reschedules and cancels).  A handle is
+ * good until its element is popped or removed, after which it may be reused.
+ */
+
+#ifndef _SYPHA_HEAP_H_
+#define _SYPHA_HEAP_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_list.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague heap object
+typedef void * SYPHA_HEAP;
+
+// Names an element in the heap
+typedef size_t SYPHA_HEAP_HANDLE;
+
+// Creates an empty heap of elem_sz sized elements ordered by cmp (called with elem_sz for both
+// sizes).  Returns NULL on error.
+extern SYPHA_HEAP sypha_heap_create(size_t elem_sz, SYPHA_LIST_COMPARATOR cmp, void * ctx);
+
+// Same as sypha_heap_create but all allocations go through allocator, NULL means the default
+extern SYPHA_HEAP sypha_heap_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz, SYPHA_LIST_COMPARATOR cmp, void * ctx);
+
+// Releases all allocated resources for the heap
+extern void sypha_heap_destroy(SYPHA_HEAP heap);
+
+// Number of elements in the heap
+extern size_t sypha_heap_count(SYPHA_HEAP heap);
+
+// Grows the heap to hold count elements without reallocating.  Returns 0 on success, otherwise < 0.
+extern int sypha_heap_reserve(SYPHA_HEAP heap, size_t count);
+
+// Drops every element, invalidating all handles
+extern void sypha_heap_clear(SYPHA_HEAP heap);
+
+// Adds a copy of the elem_sz bytes at data, filling in its handle unless handle is NULL.
+// Returns 0 if added, otherwise < 0.
+extern int sypha_heap_push(SYPHA_HEAP heap, const void * data, SYPHA_HEAP_HANDLE * handle);
+
+// Adds count elements copied from the array at base in one go, heapifying instead of sifting each
+// when that's cheaper.  Fills in their handles to the handles array unless NULL.  Returns 0 if
+// they were all added, otherwise < 0 and none were.
+extern int sypha_heap_push_many(SYPHA_HEAP heap, const void * base, size_t count, SYPHA_HEAP_HANDLE * handles);
+
+// The smallest element, NULL if empty
+extern void * sypha_heap_peek(SYPHA_HEAP heap);
+
+// Removes the smallest element, copying it to data unless NULL.  Returns 0 if removed, < 0 if empty.
+extern int sypha_heap_pop(SYPHA_HEAP heap, void * data);
+
+// The element named by handle, NULL if the handle isn't live.  Good until the next change.
+extern void * sypha_heap_get(SYPHA_HEAP heap, SYPHA_HEAP_HANDLE handle);
+
+// Replaces the element named by handle with a copy of data and moves it to where it now belongs,
+// covers both decrease-key and increase-key.  Returns 0 if updated, < 0 if the handle isn't live.
+extern int sypha_heap_update(SYPHA_HEAP heap, SYPHA_HEAP_HANDLE handle, const void * data);
+
+// Removes the element named by handle, copying it to data unless NULL.  Returns 0 if removed,
+// < 0 if the handle isn't live.
+extern int sypha_heap_remove(SYPHA_HEAP heap, SYPHA_HEAP_HANDLE handle, void * data);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_HEAP_H_
@@ -22,13 +22,15 @@
  * 
  * TODO:
  * 1) better indicate a malloc error
- * 2) add protection against creating a second iterator
  */ 
 
 #ifndef _SYPHA_LIST_H_
 #define _SYPHA_LIST_H_
 
 #include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_pool.h"
 
 #if defined __cplusplus
 extern "C" {
@@ -43,24 +45,131 @@ typedef void * SYPHA_LIST_ITERATOR;
 // Creates an empty list for data items
 extern SYPHA_LIST sypha_list_create();
 
+// Creates an empty list that makes all of its allocations through (a copy of) allocator, NULL
+// means the process-wide default
+extern SYPHA_LIST sypha_list_create_with_allocator(const SYPHA_ALLOCATOR * allocator);
+
+// Creates an empty list whose items are carved out of slabs of nodes_per_slab items, each
+// slot holding up to node_payload_hint bytes of data.  Deleted items are recycled for later
+// inserts and destroying the list releases whole slabs rather than walking every item.
+// Larger items still work, they just get their own heap block.  Returns NULL on error.
+extern SYPHA_LIST sypha_list_create_pooled(size_t node_payload_hint, size_t nodes_per_slab);
+
+// Same as sypha_list_create_pooled but the slabs come from allocator, NULL means the default
+extern SYPHA_LIST sypha_list_create_pooled_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t node_payload_hint, size_t nodes_per_slab);
+
+// Creates an empty list that lives in an arena along with all of its items, so destroying or
+// clearing it never walks the items to free them.  With arena NULL the list makes and owns an
+// arena of its own, otherwise it shares the caller's arena which has to outlive it and is where
+// the memory of a destroyed list goes back with the next reset.  Passing an arena allocator to
+// sypha_list_create_with_allocator is the same as passing its arena here.  Returns NULL on error.
+extern SYPHA_LIST sypha_list_create_in_arena(SYPHA_ARENA arena);
+
 // Releases all allocated resources for the list
 extern void sypha_list_destroy(SYPHA_LIST list);
 
-// Insert items into the list making a copy of the item.  If a deep copy of some struct
-// isn't needed, just use something like (void *) &ptr.
+// Deletes every item leaving an empty list that is ready for reuse.  A list in its own arena
+// rewinds the arena and keeps its chunks, so refilling it to the same size allocates nothing.
+// Returns -1 while any iterator on the list is live, 0 otherwise.
+extern int sypha_list_clear(SYPHA_LIST list);
+
+// Insert items into the list making a copy of the item.  The copy lives in the same
+// allocation as the list item itself, right behind a 24 byte header, so each insert costs a
+// single allocation.  Copies are 8 byte aligned.  See the _ref variants below for storing a
+// pointer instead.
     // Add item to end of list making a copy of the data
 extern void sypha_list_append_item(SYPHA_LIST list, void * data, size_t data_sz);
     // Add item to front of list making a copy of the data
 extern void sypha_list_prepend_item(SYPHA_LIST list, void * data, size_t data_sz);
 
-// Get iterators for the list.  Only 1 iterator can be in use at a time. Follows the
-// convention of requiring a "next" call to get first item (e.g. positioned before first
-// item).
+// Insert count elements of elem_sz bytes each, copied from the array at base, in their array order.
+// Items for the batch come out of a few large blocks rather than an allocation each and are
+// linked in one pass.  A block is freed once its last item is deleted, unless the list is pooled
+// and elem_sz fits its slots, in which case deleted items recycle into the pool.  Returns 0 if the
+// items were added, otherwise < 0 and the list is unchanged.
+    // Add items to end of list
+extern int sypha_list_append_many(SYPHA_LIST list, void * base, size_t elem_sz, size_t count);
+    // Add items to front of list, base[0] ends up first
+extern int sypha_list_prepend_many(SYPHA_LIST list, void * base, size_t elem_sz, size_t count);
+
+// Insert items into the list by reference, no copy is made and the list just stores the data
+// pointer.  The caller decides who owns it: leave the destructor unset for borrowed data, or set
+// one to hand ownership to the list.
+    // Add item to end of list storing the data pointer
+extern void sypha_list_append_ref(SYPHA_LIST list, void * data, size_t data_sz);
+    // Add item to front of list storing the data pointer
+extern void sypha_list_prepend_ref(SYPHA_LIST list, void * data, size_t data_sz);
+
+// Called with a ref item's data pointer and size when the item is deleted or the list destroyed
+typedef void (*SYPHA_LIST_DESTRUCTOR)(void * data, size_t data_sz, void * ctx);
+
+// Sets the destructor for ref items, NULL for none (the default).  Copied items never see it.
+extern void sypha_list_set_destructor(SYPHA_LIST list, SYPHA_LIST_DESTRUCTOR destructor, void * ctx);
+
+// Moves all of src's items to the end of dst, leaving src empty (but still to be destroyed).  When
+// both lists use the same allocator this is a relink plus handing over src's slabs, no matter how
+// many items there are; otherwise every item is copied.  Moved ref items come under dst's
+// destructor.  src can't have a changing iterator.  Returns 0 if moved, otherwise < 0 and both
+// lists are unchanged.
+extern int sypha_list_concat(SYPHA_LIST dst, SYPHA_LIST src);
+
+// Compares two items' data for sorting, returns < 0, 0 or > 0 like strcmp
+typedef int (*SYPHA_LIST_COMPARATOR)(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx);
+
+// Most worker threads sypha_list_sort_parallel will use
+#define SYPHA_LIST_SORT_MAX_THREADS     64
+
+// Sorts the list in place by relinking its items, nothing is copied or allocated.  Stable, and a
+// list that's already (mostly) in order sorts in about one pass.  Returns 0 if sorted, otherwise < 0.
+extern int sypha_list_sort(SYPHA_LIST list, SYPHA_LIST_COMPARATOR cmp, void * ctx);
+
+// Same as sypha_list_sort, but the list is cut into nthreads pieces that are sorted and then merged
+// on worker threads, so cmp gets called from several threads at once.  Pass 0 for nthreads to use
+// one per online CPU, more threads than CPUs only adds overhead.  Lists too short to be worth the
+// threads just get sorted on the calling thread.
+extern int sypha_list_sort_parallel(SYPHA_LIST list, SYPHA_LIST_COMPARATOR cmp, void * ctx, size_t nthreads);
+
+// Parallel algorithms.  The list is cut into balanced segments in one pass and the segments are
+// run as tasks on pool (or one after the other on the calling thread when pool is NULL), so the
+// callbacks get called from several threads at once and in no particular order.
+    // Called with each item's data, may change the data in place
+typedef void (*SYPHA_LIST_VISITOR)(void * data, size_t data_sz, void * ctx);
+    // Returns non-zero to keep the item
+typedef int (*SYPHA_LIST_PREDICATE)(const void * data, size_t data_sz, void * ctx);
+    // Folds an item's data into acc
+typedef void (*SYPHA_LIST_REDUCER)(void * acc, const void * data, size_t data_sz, void * ctx);
+    // Folds a partial accumulator into acc
+typedef void (*SYPHA_LIST_COMBINER)(void * acc, const void * partial, void * ctx);
+
+    // Calls visit on every item, returns 0 if done, otherwise < 0
+extern int sypha_list_parallel_for_each(SYPHA_LIST list, SYPHA_POOL pool, SYPHA_LIST_VISITOR visit, void * ctx);
+    // Removes the items keep returns 0 for, in place, keeping the order of the rest.  Needs the list
+    // to itself like a changing iterator does, returns 0 if done, otherwise < 0.
+extern int sypha_list_parallel_filter(SYPHA_LIST list, SYPHA_POOL pool, SYPHA_LIST_PREDICATE keep, void * ctx);
+    // Folds every item into an acc_sz sized accumulator.  Each segment starts from a copy of
+    // identity (which has to be given) and the partials are combined into acc in list order, so
+    // reduce / combine only have to be associative.  Returns 0 if done, otherwise < 0.
+extern int sypha_list_parallel_reduce(SYPHA_LIST list, SYPHA_POOL pool, void * acc, const void * identity, size_t acc_sz, SYPHA_LIST_REDUCER reduce, SYPHA_LIST_COMBINER combine, void * ctx);
+
+// Get iterators for the list.  Follows the convention of requiring a "next" call to get first
+// item (e.g. positioned before first item).  An iterator that can change the list has to be the
+// only one in use on it, these return NULL while any other iterator on the list is alive.
     // Forward iterator from beginning of the list
 extern SYPHA_LIST_ITERATOR sypha_list_get_iterator_front(SYPHA_LIST list);
     // Backward iterator from end of the list
 extern SYPHA_LIST_ITERATOR sypha_list_get_iterator_back(SYPHA_LIST list);
-    // Release all iterator resources
+
+// Read iterators can't change the list, so any number of them can be in use at once (from
+// different threads too) as long as no changing iterator is alive, these return NULL if one is.
+// The list keeps a version that every change bumps: once the list changes under a read iterator,
+// get returns NULL and next / previous return < 0 rather than following links that may be gone.
+// That's a check between calls, not a lock, changes still mustn't run alongside the readers.
+    // Forward read iterator from beginning of the list
+extern SYPHA_LIST_ITERATOR sypha_list_get_read_iterator_front(SYPHA_LIST list);
+    // Backward read iterator from end of the list
+extern SYPHA_LIST_ITERATOR sypha_list_get_read_iterator_back(SYPHA_LIST list);
+
+    // Release all iterator resources, either kind
 extern void sypha_list_destroy_iterator(SYPHA_LIST_ITERATOR iterator);
 
 // Get current item in list, returns NULL if empty list OR iterator if before first item
@@ -75,15 +184,41 @@ extern int sypha_list_iterator_next(SYPHA_LIST_ITERATOR iterator);
     // Returns 0 if a move is made, < 0 if at end-of-iterator
 extern int sypha_list_iterator_previous(SYPHA_LIST_ITERATOR iterator);
 
-// Adding / removing list items via the iterator
+// Same as up to max rounds of next + get in one call, for tight scan loops that would rather run
+// over arrays.  Fills out_ptrs (and out_sizes unless NULL) with the data of the items moved to
+// and leaves the iterator on the last of them.  Returns how many were filled in, 0 at
+// end-of-iterator.
+extern size_t sypha_list_iterator_next_batch(SYPHA_LIST_ITERATOR iterator, void ** out_ptrs, size_t * out_sizes, size_t max);
+
+// Adding / removing list items via the iterator, these all fail on read iterators
     // Insert new item after current item, returns 0 if item added, otherwise < 0
 extern int sypha_list_iterator_insert_after(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz);
     // Insert new item before current item, returns 0 if item added, otherwise < 0
 extern int sypha_list_iterator_insert_before(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz);
+    // Same as insert after but stores the data pointer rather than a copy
+extern int sypha_list_iterator_insert_after_ref(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz);
+    // Same as insert before but stores the data pointer rather than a copy
+extern int sypha_list_iterator_insert_before_ref(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz);
     // Delete the current item, repositioning iterator to previous item to make a "next" call sane
     // returns 0 if item removed, otherwise < 0
 extern int sypha_list_iterator_delete_current(SYPHA_LIST_ITERATOR iterator);
 
+// Moving runs of items between lists.  When both lists use the same allocator the items are
+// relinked as they are, O(1) plus a walk of the range, with no allocations.  Items from the source
+// list's slabs or batch blocks keep their slab alive until they are deleted, and slots deleted
+// away from the list that carved them aren't reused.  When the allocators differ every item is
+// copied.  Iterators on the source list are left pointing at items that moved and shouldn't be
+// used again.
+    // Moves src's items from the one src_begin_iterator is on through the one src_end_iterator is on
+    // (NULL for either means from the first / through the last item) to where insert_after through
+    // dst_iterator would put an item, keeping their order.  Use read iterators to mark the range, src
+    // can't have a changing iterator.  Returns 0 if moved, otherwise < 0 and both lists are unchanged.
+extern int sypha_list_splice(SYPHA_LIST_ITERATOR dst_iterator, SYPHA_LIST src, SYPHA_LIST_ITERATOR src_begin_iterator, SYPHA_LIST_ITERATOR src_end_iterator);
+    // Moves the current item and all items after it (front to back order, whatever the iterator's
+    // direction) into a new list set up like this one, iterator moves to the new last item.  Returns
+    // NULL on error or if the iterator isn't on an item.
+extern SYPHA_LIST sypha_list_split_at(SYPHA_LIST_ITERATOR iterator);
+
 #if defined __cplusplus
 }
 #endif // __cplusplus
@@ -0,0 +1,202 @@
+/* sypha_list_inline.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Opt-in look inside sypha_list for hot loops.  Exposes the list, item and iterator layouts and
+ * static inline versions of the iterator walking calls so the compiler can inline and unroll a
+ * scan instead of going through the library for every step.  Everything else, inserting and
+ * deleting included, stays behind the regular calls in sypha_list.h, and the two mix freely on
+ * the same iterator.
+ *
+ * Code using this header is tied to the layout of the library it was built against.  Comparing
+ * SYPHA_LIST_LAYOUT_VERSION with sypha_list_layout_version() at startup catches a mismatch.
+ */
+
+#ifndef _SYPHA_LIST_INLINE_H_
+#define _SYPHA_LIST_INLINE_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_list.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Bumped whenever the structs below change
+#define SYPHA_LIST_LAYOUT_VERSION   3
+
+// Layout version the library was built with
+extern unsigned int sypha_list_layout_version();
+
+// Item flags
+#define SYPHA_LIST_ITEM_POOLED      0x1     // item lives in a slab slot rather than its own heap block
+#define SYPHA_LIST_ITEM_REF         0x2     // data holds the caller's pointer rather than a copy
+#define SYPHA_LIST_ITEM_BLOCK       0x4     // item lives in a batch block, freed when its last item goes
+
+// Bits of the item header word left for the data size, the rest hold the flags
+#define SYPHA_LIST_ITEM_SZ_BITS     56
+
+// Where an item's data lives
+#define SYPHA_LIST_ITEM_DATA(item)  (((item)->flags & SYPHA_LIST_ITEM_REF) ? *((void **) (item)->data) : (void *) (item)->data)
+
+// Items are a single allocation: the copy of the caller's data lives inline right behind
+// the links rather than in a second heap block.  Ref items keep just the caller's pointer there.
+struct _sypha_list_item {
+    struct _sypha_list_item * prev;
+    struct _sypha_list_item * next;
+
+    // Sharing one word keeps the header at 24 bytes, so a 16 byte handle makes a 40 byte item
+    // that fits the same 48 byte heap chunk an 8 byte one does
+    size_t data_sz : SYPHA_LIST_ITEM_SZ_BITS;
+    size_t flags : (sizeof(size_t) * 8 - SYPHA_LIST_ITEM_SZ_BITS);
+    unsigned char data[];
+};
+
+struct _sypha_list_slab;
+
+struct _sypha_list {
+    size_t count;
+    struct _sypha_list_item * first;
+    struct _sypha_list_item * last;
+
+    // Everything the list owns, itself included, comes from here
+    SYPHA_ALLOCATOR allocator;
+
+    // Set when allocator is an arena's, then nothing needs freeing one item at a time.  A list that
+    // owns its arena lives at the start of it and clearing rewinds the arena to just past it.
+    SYPHA_ARENA arena;
+    unsigned int owns_arena;
+    SYPHA_ARENA_MARK arena_mark;
+
+    // Iterators and other short lived scratch come from here, the default allocator of when the
+    // list was created if allocator is an arena's, which would never get them back
+    SYPHA_ALLOCATOR scratch_allocator;
+
+    // Pool state, only used when slot_sz is non-zero
+    size_t slot_sz;
+    size_t slot_data_sz;
+    size_t slots_per_slab;
+    struct _sypha_list_slab * slabs;
+    struct _sypha_list_slab * slabs_last;   // oldest slab, lets concat hand the chain over in one go
+    unsigned char * slab_next;
+    unsigned char * slab_end;
+    struct _sypha_list_item * free_items;
+    size_t heap_item_count;
+    // Set once slab items have moved in from or out to another list, then letting go of the
+    // slabs means accounting for every item
+    unsigned int shared_slabs;
+
+    // Called on ref items' data when they leave the list
+    SYPHA_LIST_DESTRUCTOR destructor;
+    void * destructor_ctx;
+    size_t ref_item_count;
+
+    // Bumped on every change to the links so read iterators can tell they've gone stale
+    size_t version;
+    // Live iterators: the number of read iterators, or SYPHA_LIST_ITERATOR_WRITER
+    long iterators;
+};
+
+#define SYPHA_LIST_ITERATOR_WRITER  (-1L)
+
+struct _sypha_list_iterator {
+    struct _sypha_list * list;
+    struct _sypha_list_item * curr;
+    unsigned int forward;
+    unsigned int is_pristine;
+    unsigned int read_only;
+    size_t version;         // list version a read iterator is good for
+};
+
+// Read iterators fail once the list has changed under them
+static inline int sypha_list_iterator_is_stale(struct _sypha_list_iterator * iterator) {
+    return iterator->read_only && __atomic_load_n(&iterator->list->version, __ATOMIC_ACQUIRE) != iterator->version;
+}
+
+// Same as sypha_list_iterator_get
+static inline void * sypha_list_iterator_get_inline(SYPHA_LIST_ITERATOR iterator, size_t * data_sz) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list_item * curr = _iterator->curr;
+
+    // Iterator not started OR empty list OR list changed under a read iterator
+    if (_iterator->is_pristine || !curr || sypha_list_iterator_is_stale(_iterator)) {
+        return NULL;
+    }
+
+    *data_sz = curr->data_sz;
+    return SYPHA_LIST_ITEM_DATA(curr);
+}
+
+// Same as sypha_list_iterator_next
+static inline int sypha_list_iterator_next_inline(SYPHA_LIST_ITERATOR iterator) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list_item * curr = _iterator->curr;
+    struct _sypha_list_item * next;
+
+    // Empty list case, or list changed under a read iterator
+    if (!curr || sypha_list_iterator_is_stale(_iterator)) {
+        return -1;
+    }
+
+    // In the initial state so don't move and clense that state
+    if (_iterator->is_pristine) {
+        _iterator->is_pristine = 0;
+        return 0;
+    }
+
+    // Moving front-to-back or back-to-front, stay where we are at the "end"
+    if (!(next = (_iterator->forward) ? curr->next : curr->prev)) {
+        return -1;
+    }
+    _iterator->curr = next;
+    return 0;
+}
+
+// Same as sypha_list_iterator_previous
+static inline int sypha_list_iterator_previous_inline(SYPHA_LIST_ITERATOR iterator) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list_item * curr = _iterator->curr;
+    struct _sypha_list_item * next;
+
+    // Empty list case, list changed under a read iterator, and you can't move to the previous
+    // node from the initial state
+    if (!curr || _iterator->is_pristine || sypha_list_iterator_is_stale(_iterator)) {
+        return -1;
+    }
+
+    // Moving front-to-back or back-to-front, stay where we are at the "end"
+    if (!(next = (_iterator->forward) ? curr->prev : curr->next)) {
+        return -1;
+    }
+    _iterator->curr = next;
+    return 0;
+}
+
+// Moves to the next item and returns its data in one go, the usual shape of a scan loop.
+// Returns NULL at end-of-iterator.
+static inline void * sypha_list_iterator_next_get_inline(SYPHA_LIST_ITERATOR iterator, size_t * data_sz) {
+    if (sypha_list_iterator_next_inline(iterator) < 0) {
+        return NULL;
+    }
+    return sypha_list_iterator_get_inline(iterator, data_sz);
+}
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_LIST_INLINE_H_
@@ -0,0 +1,92 @@
+/* sypha_map.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Hash map from byte-string keys to byte-string values.  Open addressing in the style of
+ * SwissTable: a byte of control data per slot holds 7 bits of the key's hash, and a lookup checks
+ * 16 of those at once (with SSE2 where there is one), so most probes touch a single cache line of
+ * control bytes and compare a key only when its hash bits already match.
+ *
+ * Keys and values are copied into the map.  Pointers returned by get / the iterator are good until
+ * the entry is replaced or deleted, resizing the table doesn't move them.  Any put or delete,
+ * except through sypha_map_iterator_delete_current, leaves live iterators undefined.
+ */
+
+#ifndef _SYPHA_MAP_H_
+#define _SYPHA_MAP_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague map object
+typedef void * SYPHA_MAP;
+
+// Opague map iterator object
+typedef void * SYPHA_MAP_ITERATOR;
+
+// Creates an empty map.  Returns NULL on error.
+extern SYPHA_MAP sypha_map_create();
+
+// Same as sypha_map_create but all allocations go through allocator, NULL means the default
+extern SYPHA_MAP sypha_map_create_with_allocator(const SYPHA_ALLOCATOR * allocator);
+
+// Releases all allocated resources for the map
+extern void sypha_map_destroy(SYPHA_MAP map);
+
+// Number of entries in the map
+extern size_t sypha_map_count(SYPHA_MAP map);
+
+// Sizes the table to hold count entries without growing.  Returns 0 on success, otherwise < 0.
+extern int sypha_map_reserve(SYPHA_MAP map, size_t count);
+
+// Deletes every entry, keeping the table's size
+extern void sypha_map_clear(SYPHA_MAP map);
+
+// Adds a copy of the key and value, replacing the value if the key is already there.  Returns 0
+// on success, otherwise < 0 and the map is left as it was.
+extern int sypha_map_put(SYPHA_MAP map, const void * key, size_t key_sz, const void * value, size_t value_sz);
+
+// Returns the value stored for key and fills in its size to value_sz unless NULL, NULL if the
+// key isn't there.  Values are 8 byte aligned.
+extern void * sypha_map_get(SYPHA_MAP map, const void * key, size_t key_sz, size_t * value_sz);
+
+// Removes key, returns 0 if it was there, otherwise < 0
+extern int sypha_map_delete(SYPHA_MAP map, const void * key, size_t key_sz);
+
+// Iterating visits every entry once in no particular order.  A "next" call is needed to get to
+// the first entry.
+    // Iterator positioned before the first entry
+extern SYPHA_MAP_ITERATOR sypha_map_get_iterator(SYPHA_MAP map);
+    // Release all iterator resources
+extern void sypha_map_destroy_iterator(SYPHA_MAP_ITERATOR iterator);
+    // Move to the next entry, returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_map_iterator_next(SYPHA_MAP_ITERATOR iterator);
+    // Current entry's key and its size, NULL if before the first entry
+extern const void * sypha_map_iterator_get_key(SYPHA_MAP_ITERATOR iterator, size_t * key_sz);
+    // Current entry's value and its size unless value_sz is NULL, NULL if before the first entry
+extern void * sypha_map_iterator_get(SYPHA_MAP_ITERATOR iterator, size_t * value_sz);
+    // Delete the current entry, a "next" call moves on to the one after it.  Returns 0 if the
+    // entry was removed, otherwise < 0.
+extern int sypha_map_iterator_delete_current(SYPHA_MAP_ITERATOR iterator);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_MAP_H_
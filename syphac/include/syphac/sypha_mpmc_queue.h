@@ -0,0 +1,74 @@
+/* sypha_mpmc_queue.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Bounded multi-producer / multi-consumer queue of fixed size elements without locks.  A ring of
+ * cells each carrying a sequence number that says whose turn the cell is: producers claim the next
+ * cell to fill and consumers the next one to empty with a compare-and-swap on their own counter,
+ * then hand the cell over by bumping its sequence.  The producer and consumer counters sit on
+ * cache lines of their own so the two sides don't fight over one line.
+ *
+ * Elements come out in the order their pushes claimed cells.  Every call can be made from any
+ * thread at any time, except destroy.
+ *
+ * The waiting push / pop spin for a moment, then yield, then park on a condition variable until
+ * a pop / push on the other side wakes them, so an idle thread blocked on the queue costs no CPU.
+ * Calls that go through only touch the lock when somebody is parked.
+ */
+
+#ifndef _SYPHA_MPMC_QUEUE_H_
+#define _SYPHA_MPMC_QUEUE_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague queue object
+typedef void * SYPHA_MPMC_QUEUE;
+
+// Creates an empty queue of elem_sz sized elements holding up to capacity of them, rounded up to
+// a power of 2.  Returns NULL on error.
+extern SYPHA_MPMC_QUEUE sypha_mpmc_queue_create(size_t elem_sz, size_t capacity);
+
+// Same as sypha_mpmc_queue_create but allocations go through allocator, NULL means the default
+extern SYPHA_MPMC_QUEUE sypha_mpmc_queue_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz, size_t capacity);
+
+// Releases all allocated resources for the queue, no other thread may be using it
+extern void sypha_mpmc_queue_destroy(SYPHA_MPMC_QUEUE queue);
+
+// Number of elements the queue holds when full
+extern size_t sypha_mpmc_queue_capacity(SYPHA_MPMC_QUEUE queue);
+
+// Number of elements in the queue, only a snapshot while other threads are using it
+extern size_t sypha_mpmc_queue_count(SYPHA_MPMC_QUEUE queue);
+
+// Adds a copy of the elem_sz bytes at data without waiting.  Returns 0 if added, < 0 if full.
+extern int sypha_mpmc_queue_try_push(SYPHA_MPMC_QUEUE queue, const void * data);
+
+// Removes the oldest element into data without waiting.  Returns 0 if removed, < 0 if empty.
+extern int sypha_mpmc_queue_try_pop(SYPHA_MPMC_QUEUE queue, void * data);
+
+// Same as the try calls but wait for room / an element, however long that takes
+extern void sypha_mpmc_queue_push(SYPHA_MPMC_QUEUE queue, const void * data);
+extern void sypha_mpmc_queue_pop(SYPHA_MPMC_QUEUE queue, void * data);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_MPMC_QUEUE_H_
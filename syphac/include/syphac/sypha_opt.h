@@ -18,6 +18,8 @@
 #ifndef _SYPHA_OPT_H_
 #define _SYPHA_OPT_H_
 
+#include "syphac/sypha_alloc.h"
+
 #if defined __cplusplus
 extern "C" {
 #endif // __cplusplus
@@ -27,7 +29,13 @@ typedef void * SYPHA_OPT_CONFIG;
 
 // TODO: add support for default values
 
-// Adds a new param to config, pass NULL cfg for first invocation, returns NULL on errror
+// Creates an empty config that makes all of its allocations, and those of any parse result
+// made from it, through (a copy of) allocator.  NULL means the process-wide default.  Returns
+// NULL on error.
+extern SYPHA_OPT_CONFIG sypha_opt_config_create(const SYPHA_ALLOCATOR * allocator);
+
+// Adds a new param to config, pass NULL cfg for first invocation (uses the default allocator),
+// returns NULL on errror
 extern SYPHA_OPT_CONFIG sypha_opt_config_add_param(SYPHA_OPT_CONFIG cfg, const char * short_name, const char * long_name, int is_flag, int is_required);
 
 // Release opt config
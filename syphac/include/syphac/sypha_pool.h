@@ -0,0 +1,60 @@
+/* sypha_pool.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/* A fixed set of worker threads for running batches of tasks.  The threads are started once and
+ * parked between batches, so handing a batch to the pool costs a wakeup rather than a thread
+ * create per task.  The thread calling sypha_pool_run works through the batch alongside the
+ * workers and the call returns once every task in the batch is done.
+ */
+
+#ifndef _SYPHA_POOL_H_
+#define _SYPHA_POOL_H_
+
+#include <stdlib.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague worker pool object
+typedef void * SYPHA_POOL;
+
+// A task, gets a pointer to its own argument
+typedef void (*SYPHA_POOL_TASK)(void * arg);
+
+// Creates a pool running batches on nthreads threads: the caller plus nthreads - 1 workers.  Pass
+// 0 for nthreads to use one per online CPU.  Returns NULL on error.
+extern SYPHA_POOL sypha_pool_create(size_t nthreads);
+
+// Stops the workers and releases all pool resources, must not be called while a batch is running
+extern void sypha_pool_destroy(SYPHA_POOL pool);
+
+// Number of threads batches run on, the caller included
+extern size_t sypha_pool_thread_count(SYPHA_POOL pool);
+
+// Runs task once for each of the count arguments in the args array (arg_sz bytes apart) and waits
+// for all of them.  Tasks run concurrently and in no particular order.  Batches from different
+// threads take turns.  Called from inside one of the pool's own tasks the batch runs one task
+// after another on the calling thread, since the pool is busy with the outer batch.  Returns 0
+// when the batch is done, otherwise < 0.
+extern int sypha_pool_run(SYPHA_POOL pool, SYPHA_POOL_TASK task, void * args, size_t arg_sz, size_t count);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_POOL_H_
@@ -0,0 +1,99 @@
+/* sypha_skiplist.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Ordered container keeping its items sorted by a user comparator.  A skip list: every item is
+ * on the bottom, doubly linked level and on a random number of sparser levels above it, so insert,
+ * delete and searches are O(log n) expected instead of the linear walk a sorted sypha_list needs.
+ * Items that compare equal stay in insertion order.
+ *
+ * Iterators follow the sypha_list conventions: a "next" call is needed to get to the first item,
+ * "previous" / "next" are from the perspective of the iterator's direction and deleting
+ * repositions to the previous item.  Inserting or deleting other than through the iterator in use
+ * leaves it undefined.
+ */
+
+#ifndef _SYPHA_SKIPLIST_H_
+#define _SYPHA_SKIPLIST_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_list.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague skip list object
+typedef void * SYPHA_SKIPLIST;
+
+// Opague skip list iterator object
+typedef void * SYPHA_SKIPLIST_ITERATOR;
+
+// Creates an empty skip list ordered by cmp, which is called with an item as a and a key or the
+// item being inserted as b.  Returns NULL on error.
+extern SYPHA_SKIPLIST sypha_skiplist_create(SYPHA_LIST_COMPARATOR cmp, void * ctx);
+
+// Same as sypha_skiplist_create but all allocations go through allocator, NULL means the default
+extern SYPHA_SKIPLIST sypha_skiplist_create_with_allocator(const SYPHA_ALLOCATOR * allocator, SYPHA_LIST_COMPARATOR cmp, void * ctx);
+
+// Releases all allocated resources for the skip list
+extern void sypha_skiplist_destroy(SYPHA_SKIPLIST skiplist);
+
+// Number of items in the skip list
+extern size_t sypha_skiplist_count(SYPHA_SKIPLIST skiplist);
+
+// Inserts a copy of data after any items comparing equal to it.  Returns 0 if added, otherwise < 0.
+extern int sypha_skiplist_insert(SYPHA_SKIPLIST skiplist, const void * data, size_t data_sz);
+
+// Removes the first item comparing equal to key.  Returns 0 if one was removed, otherwise < 0.
+extern int sypha_skiplist_delete(SYPHA_SKIPLIST skiplist, const void * key, size_t key_sz);
+
+// Returns the first item comparing equal to key and fills in its size to data_sz unless NULL,
+// NULL if there is none
+extern void * sypha_skiplist_find(SYPHA_SKIPLIST skiplist, const void * key, size_t key_sz, size_t * data_sz);
+
+// Get iterators for the skip list.  Positioned before the first item.
+    // Forward iterator from the smallest item
+extern SYPHA_SKIPLIST_ITERATOR sypha_skiplist_get_iterator_front(SYPHA_SKIPLIST skiplist);
+    // Backward iterator from the largest item
+extern SYPHA_SKIPLIST_ITERATOR sypha_skiplist_get_iterator_back(SYPHA_SKIPLIST skiplist);
+    // Forward iterator where a "next" call moves to the first item not less than key, and
+    // "previous" to the last one less than it
+extern SYPHA_SKIPLIST_ITERATOR sypha_skiplist_get_iterator_lower_bound(SYPHA_SKIPLIST skiplist, const void * key, size_t key_sz);
+    // Release all iterator resources
+extern void sypha_skiplist_destroy_iterator(SYPHA_SKIPLIST_ITERATOR iterator);
+
+// Get current item, returns NULL if the iterator isn't on one
+    // Returns the data and fills in its size to the data_sz param unless NULL
+extern void * sypha_skiplist_iterator_get(SYPHA_SKIPLIST_ITERATOR iterator, size_t * data_sz);
+
+// Move to "next" item from perspective of forward / backward iterator.
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_skiplist_iterator_next(SYPHA_SKIPLIST_ITERATOR iterator);
+
+// Move to "previous" item from perspective of forward / backward iterator
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_skiplist_iterator_previous(SYPHA_SKIPLIST_ITERATOR iterator);
+
+// Delete the current item, repositioning iterator to previous item to make a "next" call sane.
+    // Returns 0 if item removed, otherwise < 0
+extern int sypha_skiplist_iterator_delete_current(SYPHA_SKIPLIST_ITERATOR iterator);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_SKIPLIST_H_
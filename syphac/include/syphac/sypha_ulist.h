@@ -0,0 +1,97 @@
+/* sypha_ulist.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/* Unrolled variant of sypha_list for fixed size elements.  Each node holds a small array of
+ * elements so a scan walks mostly contiguous memory instead of chasing a pointer per element.
+ * The iterator follows the same conventions as the sypha_list one: a "next" call is needed to
+ * get to the first item, "previous" / "next" are from the perspective of the iterator's
+ * direction and deleting repositions to the previous item.
+ *
+ * Elements are moved around within and between nodes on insert / delete, so pointers returned
+ * by get are only good until the next change to the list, and inserting / deleting through
+ * anything but the one iterator in use leaves that iterator undefined.
+ */
+
+#ifndef _SYPHA_ULIST_H_
+#define _SYPHA_ULIST_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague unrolled list object
+typedef void * SYPHA_ULIST;
+
+// Opague unrolled list iterator object
+typedef void * SYPHA_ULIST_ITERATOR;
+
+// Creates an empty list of elem_sz sized elements, elems_per_node at most in each node.  Pass 0
+// for elems_per_node to size nodes to a few cache lines.  Returns NULL on error.
+extern SYPHA_ULIST sypha_ulist_create(size_t elem_sz, size_t elems_per_node);
+
+// Same as sypha_ulist_create but all allocations go through allocator, NULL means the default
+extern SYPHA_ULIST sypha_ulist_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz, size_t elems_per_node);
+
+// Releases all allocated resources for the list
+extern void sypha_ulist_destroy(SYPHA_ULIST list);
+
+// Number of elements in the list
+extern size_t sypha_ulist_count(SYPHA_ULIST list);
+
+// Insert a copy of the elem_sz bytes at data into the list
+    // Add item to end of list, returns 0 if item added, otherwise < 0
+extern int sypha_ulist_append_item(SYPHA_ULIST list, void * data);
+    // Add item to front of list, returns 0 if item added, otherwise < 0
+extern int sypha_ulist_prepend_item(SYPHA_ULIST list, void * data);
+
+// Get iterators for the list.  Only 1 iterator can be in use at a time. Positioned before
+// the first item.
+    // Forward iterator from beginning of the list
+extern SYPHA_ULIST_ITERATOR sypha_ulist_get_iterator_front(SYPHA_ULIST list);
+    // Backward iterator from end of the list
+extern SYPHA_ULIST_ITERATOR sypha_ulist_get_iterator_back(SYPHA_ULIST list);
+    // Release all iterator resources
+extern void sypha_ulist_destroy_iterator(SYPHA_ULIST_ITERATOR iterator);
+
+// Get current item in list, returns NULL if empty list OR iterator if before first item
+extern void * sypha_ulist_iterator_get(SYPHA_ULIST_ITERATOR iterator);
+
+// Move to "next" item in list from perspective of forward / backward iterator.
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_ulist_iterator_next(SYPHA_ULIST_ITERATOR iterator);
+
+// Move to "previous" item in list from perspective of forward / backward iterator
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_ulist_iterator_previous(SYPHA_ULIST_ITERATOR iterator);
+
+// Adding / removing list items via the iterator
+    // Insert new item after current item, returns 0 if item added, otherwise < 0
+extern int sypha_ulist_iterator_insert_after(SYPHA_ULIST_ITERATOR iterator, void * data);
+    // Insert new item before current item, returns 0 if item added, otherwise < 0
+extern int sypha_ulist_iterator_insert_before(SYPHA_ULIST_ITERATOR iterator, void * data);
+    // Delete the current item, repositioning iterator to previous item to make a "next" call sane
+    // returns 0 if item removed, otherwise < 0
+extern int sypha_ulist_iterator_delete_current(SYPHA_ULIST_ITERATOR iterator);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_ULIST_H_
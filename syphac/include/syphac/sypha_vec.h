@@ -0,0 +1,122 @@
+/* sypha_vec.h
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+/* Growable array of fixed size elements for data that is mostly appended and scanned.  Elements
+ * sit back to back in one block, appends are amortized O(1) and a scan is a straight walk through
+ * memory.  Inserting or deleting anywhere but the end shifts everything behind it, so those are
+ * O(n) and best left to sypha_list.
+ *
+ * The iterator mirrors the sypha_list one so a list that only ever gets appended and scanned can
+ * switch over by changing the type: a "next" call is needed to get to the first item, "previous" /
+ * "next" are from the perspective of the iterator's direction and deleting repositions to the
+ * previous item.  Any change can move the elements, so pointers returned by get / data are only
+ * good until the next change, and changing the vector through anything but the one iterator in
+ * use leaves that iterator undefined.
+ */
+
+#ifndef _SYPHA_VEC_H_
+#define _SYPHA_VEC_H_
+
+#include <stdlib.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Opague vector object
+typedef void * SYPHA_VEC;
+
+// Opague vector iterator object
+typedef void * SYPHA_VEC_ITERATOR;
+
+// Creates an empty vector of elem_sz sized elements.  Returns NULL on error.
+extern SYPHA_VEC sypha_vec_create(size_t elem_sz);
+
+// Same as sypha_vec_create but all allocations go through allocator, NULL means the default.
+// The elements grow with realloc, so the allocator needs a working one.
+extern SYPHA_VEC sypha_vec_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz);
+
+// Releases all allocated resources for the vector
+extern void sypha_vec_destroy(SYPHA_VEC vec);
+
+// Number of elements in the vector
+extern size_t sypha_vec_count(SYPHA_VEC vec);
+
+// Number of elements the vector can hold before it has to grow
+extern size_t sypha_vec_capacity(SYPHA_VEC vec);
+
+// Grows the vector to hold at least count elements without reallocating.  Returns 0 on
+// success, otherwise < 0.
+extern int sypha_vec_reserve(SYPHA_VEC vec, size_t count);
+
+// Gives back the room past the last element.  Returns 0 on success, otherwise < 0 and the
+// vector is left as it was.
+extern int sypha_vec_shrink(SYPHA_VEC vec);
+
+// Drops every element, keeping the room for reuse
+extern void sypha_vec_clear(SYPHA_VEC vec);
+
+// The elements as one array, NULL if the vector never held any
+extern void * sypha_vec_data(SYPHA_VEC vec);
+
+// The element at index, NULL if out of range
+extern void * sypha_vec_get(SYPHA_VEC vec, size_t index);
+
+// Insert a copy of the elem_sz bytes at data into the vector
+    // Add item to end of vector, returns 0 if item added, otherwise < 0
+extern int sypha_vec_append_item(SYPHA_VEC vec, void * data);
+    // Add item to front of vector, O(n), returns 0 if item added, otherwise < 0
+extern int sypha_vec_prepend_item(SYPHA_VEC vec, void * data);
+
+// Add count elements copied from the array at base to the end in one go.  Returns 0 if they
+// were all added, otherwise < 0 and none were.
+extern int sypha_vec_append_many(SYPHA_VEC vec, const void * base, size_t count);
+
+// Get iterators for the vector.  Positioned before the first item.
+    // Forward iterator from beginning of the vector
+extern SYPHA_VEC_ITERATOR sypha_vec_get_iterator_front(SYPHA_VEC vec);
+    // Backward iterator from end of the vector
+extern SYPHA_VEC_ITERATOR sypha_vec_get_iterator_back(SYPHA_VEC vec);
+    // Release all iterator resources
+extern void sypha_vec_destroy_iterator(SYPHA_VEC_ITERATOR iterator);
+
+// Get current item in vector, returns NULL if empty vector OR iterator if before first item
+    // Returns the data and fills in its size to the data_sz param unless NULL
+extern void * sypha_vec_iterator_get(SYPHA_VEC_ITERATOR iterator, size_t * data_sz);
+
+// Move to "next" item in vector from perspective of forward / backward iterator.
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_vec_iterator_next(SYPHA_VEC_ITERATOR iterator);
+
+// Move to "previous" item in vector from perspective of forward / backward iterator
+    // Returns 0 if a move is made, < 0 if at end-of-iterator
+extern int sypha_vec_iterator_previous(SYPHA_VEC_ITERATOR iterator);
+
+// Adding / removing items via the iterator, O(n) away from the end
+    // Insert new item after current item, returns 0 if item added, otherwise < 0
+extern int sypha_vec_iterator_insert_after(SYPHA_VEC_ITERATOR iterator, void * data);
+    // Insert new item before current item, returns 0 if item added, otherwise < 0
+extern int sypha_vec_iterator_insert_before(SYPHA_VEC_ITERATOR iterator, void * data);
+    // Delete the current item, repositioning iterator to previous item to make a "next" call sane
+    // returns 0 if item removed, otherwise < 0
+extern int sypha_vec_iterator_delete_current(SYPHA_VEC_ITERATOR iterator);
+
+#if defined __cplusplus
+}
+#endif // __cplusplus
+
+#endif // _SYPHA_VEC_H_
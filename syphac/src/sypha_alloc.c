@@ -0,0 +1,73 @@
+/* sypha_alloc.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "syphac/sypha_alloc.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+static void * sypha_allocator_std_alloc(void * ctx, size_t sz) {
+    return malloc(sz);
+}
+
+static void * sypha_allocator_std_realloc(void * ctx, void * ptr, size_t sz) {
+    return realloc(ptr, sz);
+}
+
+static void sypha_allocator_std_free(void * ctx, void * ptr) {
+    free(ptr);
+}
+
+static const SYPHA_ALLOCATOR sypha_allocator_std = {
+    sypha_allocator_std_alloc,
+    sypha_allocator_std_realloc,
+    sypha_allocator_std_free,
+    NULL
+};
+
+static SYPHA_ALLOCATOR sypha_allocator_default = {
+    sypha_allocator_std_alloc,
+    sypha_allocator_std_realloc,
+    sypha_allocator_std_free,
+    NULL
+};
+
+void sypha_allocator_set_default(const SYPHA_ALLOCATOR * allocator) {
+    sypha_allocator_default = (allocator) ? *allocator : sypha_allocator_std;
+}
+
+const SYPHA_ALLOCATOR * sypha_allocator_get_default() {
+    return &sypha_allocator_default;
+}
+
+char * sypha_allocator_strdup(const SYPHA_ALLOCATOR * allocator, const char * str) {
+    size_t str_sz = strlen(str) + 1;
+    char * copy;
+
+    if (!(copy = (char *) sypha_alloc(allocator, str_sz))) {
+        return NULL;
+    }
+    memcpy(copy, str, str_sz);
+    return copy;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,256 @@
+/* sypha_arena.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+#define SYPHA_ARENA_DEFAULT_CHUNK_SZ    (64 * 1024)
+
+// Blocks are kept 16 byte aligned like malloc's
+#define SYPHA_ARENA_ALIGN(sz)           (((sz) + 15) & ~((size_t) 15))
+
+// Chunk header, the blocks follow it
+struct _sypha_arena_chunk {
+    struct _sypha_arena_chunk * next;
+    size_t sz;
+};
+
+struct _sypha_arena {
+    SYPHA_ALLOCATOR allocator;
+    size_t chunk_sz;
+
+    // Regular chunks in the order they were first used, curr is the one being carved up and
+    // the ones after it are left over from before the last reset
+    struct _sypha_arena_chunk * chunks;
+    struct _sypha_arena_chunk * curr;
+    unsigned char * next;
+    unsigned char * end;
+
+    // Blocks too big for a regular chunk
+    struct _sypha_arena_chunk * oversized;
+};
+
+#define SYPHA_ARENA_CHUNK_HEADER_SZ     SYPHA_ARENA_ALIGN(sizeof(struct _sypha_arena_chunk))
+
+static void sypha_arena_use_chunk(struct _sypha_arena * arena, struct _sypha_arena_chunk * chunk) {
+    arena->curr = chunk;
+    arena->next = ((unsigned char *) chunk) + SYPHA_ARENA_CHUNK_HEADER_SZ;
+    arena->end = arena->next + chunk->sz;
+}
+
+SYPHA_ARENA sypha_arena_create(size_t chunk_sz) {
+    return sypha_arena_create_with_allocator(NULL, chunk_sz);
+}
+
+SYPHA_ARENA sypha_arena_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t chunk_sz) {
+    struct _sypha_arena * arena;
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(arena = (struct _sypha_arena *) sypha_alloc(allocator, sizeof(struct _sypha_arena)))) {
+        return NULL;
+    }
+    arena->allocator = *allocator;
+    arena->chunk_sz = SYPHA_ARENA_ALIGN((chunk_sz) ? chunk_sz : SYPHA_ARENA_DEFAULT_CHUNK_SZ);
+    arena->chunks = NULL;
+    arena->curr = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->oversized = NULL;
+
+    return (SYPHA_ARENA) arena;
+}
+
+static void sypha_arena_free_chunks(struct _sypha_arena * arena, struct _sypha_arena_chunk * chunk) {
+    struct _sypha_arena_chunk * chunk_next;
+    while (chunk) {
+        chunk_next = chunk->next;
+        sypha_free(&arena->allocator, chunk);
+        chunk = chunk_next;
+    }
+}
+
+void sypha_arena_destroy(SYPHA_ARENA arena) {
+    struct _sypha_arena * _arena = (struct _sypha_arena *) arena;
+    if (!_arena) {
+        return;
+    }
+
+    sypha_arena_free_chunks(_arena, _arena->chunks);
+    sypha_arena_free_chunks(_arena, _arena->oversized);
+    sypha_free(&_arena->allocator, _arena);
+}
+
+void * sypha_arena_alloc(SYPHA_ARENA arena, size_t sz) {
+    struct _sypha_arena * _arena = (struct _sypha_arena *) arena;
+    struct _sypha_arena_chunk * chunk;
+    void * block;
+
+    sz = SYPHA_ARENA_ALIGN(sz);
+
+    // Anything over a quarter chunk would waste too much of one, give it its own
+    if (sz > _arena->chunk_sz / 4) {
+        if (!(chunk = (struct _sypha_arena_chunk *) sypha_alloc(&_arena->allocator, SYPHA_ARENA_CHUNK_HEADER_SZ + sz))) {
+            return NULL;
+        }
+        chunk->sz = sz;
+        chunk->next = _arena->oversized;
+        _arena->oversized = chunk;
+        return ((unsigned char *) chunk) + SYPHA_ARENA_CHUNK_HEADER_SZ;
+    }
+
+    if ((size_t) (_arena->end - _arena->next) < sz) {
+        if (_arena->curr && _arena->curr->next) {
+            // Left over from before a reset
+            sypha_arena_use_chunk(_arena, _arena->curr->next);
+        } else {
+            if (!(chunk = (struct _sypha_arena_chunk *) sypha_alloc(&_arena->allocator, SYPHA_ARENA_CHUNK_HEADER_SZ + _arena->chunk_sz))) {
+                return NULL;
+            }
+            chunk->sz = _arena->chunk_sz;
+            chunk->next = NULL;
+            if (_arena->curr) {
+                _arena->curr->next = chunk;
+            } else {
+                _arena->chunks = chunk;
+            }
+            sypha_arena_use_chunk(_arena, chunk);
+        }
+    }
+
+    block = _arena->next;
+    _arena->next += sz;
+    return block;
+}
+
+void sypha_arena_reset(SYPHA_ARENA arena) {
+    struct _sypha_arena * _arena = (struct _sypha_arena *) arena;
+
+    sypha_arena_free_chunks(_arena, _arena->oversized);
+    _arena->oversized = NULL;
+
+    if (_arena->chunks) {
+        sypha_arena_use_chunk(_arena, _arena->chunks);
+    }
+}
+
+SYPHA_ARENA_MARK sypha_arena_mark(SYPHA_ARENA arena) {
+    struct _sypha_arena * _arena = (struct _sypha_arena *) arena;
+    SYPHA_ARENA_MARK mark;
+
+    mark.chunk = _arena->curr;
+    mark.next = _arena->next;
+    mark.oversized = _arena->oversized;
+    return mark;
+}
+
+void sypha_arena_rewind(SYPHA_ARENA arena, SYPHA_ARENA_MARK mark) {
+    struct _sypha_arena * _arena = (struct _sypha_arena *) arena;
+    struct _sypha_arena_chunk * chunk;
+
+    // Oversized blocks are stacked newest first
+    while (_arena->oversized != mark.oversized) {
+        chunk = _arena->oversized;
+        _arena->oversized = chunk->next;
+        sypha_free(&_arena->allocator, chunk);
+    }
+
+    if (mark.chunk) {
+        _arena->curr = (struct _sypha_arena_chunk *) mark.chunk;
+        _arena->next = (unsigned char *) mark.next;
+        _arena->end = ((unsigned char *) _arena->curr) + SYPHA_ARENA_CHUNK_HEADER_SZ + _arena->curr->sz;
+    } else if (_arena->chunks) {
+        // Marked before the first chunk
+        sypha_arena_use_chunk(_arena, _arena->chunks);
+    }
+}
+
+// Blocks handed out through the allocator carry their size in front, so realloc can grow them
+#define SYPHA_ARENA_SIZE_HEADER_SZ      SYPHA_ARENA_ALIGN(sizeof(size_t))
+
+static void * sypha_arena_allocator_alloc(void * ctx, size_t sz) {
+    unsigned char * block;
+
+    if (!(block = (unsigned char *) sypha_arena_alloc((SYPHA_ARENA) ctx, SYPHA_ARENA_SIZE_HEADER_SZ + sz))) {
+        return NULL;
+    }
+    *((size_t *) block) = sz;
+    return block + SYPHA_ARENA_SIZE_HEADER_SZ;
+}
+
+static void * sypha_arena_allocator_realloc(void * ctx, void * ptr, size_t sz) {
+    struct _sypha_arena * arena = (struct _sypha_arena *) ctx;
+    unsigned char * block;
+    size_t block_sz;
+    void * grown;
+
+    if (!ptr) {
+        return sypha_arena_allocator_alloc(ctx, sz);
+    }
+
+    block = ((unsigned char *) ptr) - SYPHA_ARENA_SIZE_HEADER_SZ;
+    block_sz = *((size_t *) block);
+    if (sz <= block_sz) {
+        return ptr;
+    }
+
+    // The last block carved out of the current chunk can grow in place if the chunk has room
+    if (block + SYPHA_ARENA_ALIGN(SYPHA_ARENA_SIZE_HEADER_SZ + block_sz) == arena->next &&
+            SYPHA_ARENA_ALIGN(SYPHA_ARENA_SIZE_HEADER_SZ + sz) <= (size_t) (arena->end - block)) {
+        arena->next = block + SYPHA_ARENA_ALIGN(SYPHA_ARENA_SIZE_HEADER_SZ + sz);
+        *((size_t *) block) = sz;
+        return ptr;
+    }
+
+    // Otherwise it moves, the old block goes with the rest of the arena
+    if (!(grown = sypha_arena_allocator_alloc(ctx, sz))) {
+        return NULL;
+    }
+    memcpy(grown, ptr, block_sz);
+    return grown;
+}
+
+static void sypha_arena_allocator_free(void * ctx, void * ptr) {
+    // Everything goes at once on reset / destroy
+}
+
+void sypha_arena_get_allocator(SYPHA_ARENA arena, SYPHA_ALLOCATOR * allocator) {
+    allocator->alloc = sypha_arena_allocator_alloc;
+    allocator->realloc = sypha_arena_allocator_realloc;
+    allocator->free = sypha_arena_allocator_free;
+    allocator->ctx = arena;
+}
+
+SYPHA_ARENA sypha_arena_from_allocator(const SYPHA_ALLOCATOR * allocator) {
+    return (allocator->alloc == sypha_arena_allocator_alloc) ? (SYPHA_ARENA) allocator->ctx : NULL;
+}
+
+void sypha_arena_scratch_allocator(const SYPHA_ALLOCATOR * allocator, SYPHA_ALLOCATOR * scratch) {
+    *scratch = (sypha_arena_from_allocator(allocator)) ? *sypha_allocator_get_default() : *allocator;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,538 @@
+/* sypha_clist.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_clist.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+// Index standing in for a NULL link
+#define SYPHA_CLIST_NIL             0xffffffffU
+
+// Nodes the array starts out with
+#define SYPHA_CLIST_MIN_CAPACITY    64
+
+// Address of the node at index i
+#define SYPHA_CLIST_NODE(list, i)   ((struct _sypha_clist_node *) ((list)->nodes + ((size_t) (i)) * (list)->node_sz))
+
+// Stands in for prev on free nodes while a loaded image is checked, no index gets this high
+#define SYPHA_CLIST_FREE_MARK       0xfffffffeU
+
+// Tells a serialized image apart from random bytes
+#define SYPHA_CLIST_IMAGE_MAGIC     0x53434c31U     // "SCL1"
+
+struct _sypha_clist_node {
+    uint32_t prev;
+    uint32_t next;
+    unsigned char elem[];
+};
+
+struct _sypha_clist {
+    size_t count;
+    size_t elem_sz;
+    size_t node_sz;
+
+    uint32_t first;
+    uint32_t last;
+
+    // Deleted nodes, chained through next
+    uint32_t free_first;
+
+    // Nodes [0, used) have been handed out at some point, the rest of capacity never has
+    uint32_t used;
+    uint32_t capacity;
+    unsigned char * nodes;
+
+    SYPHA_ALLOCATOR allocator;
+    // Iterators come from here, see sypha_arena_scratch_allocator
+    SYPHA_ALLOCATOR scratch_allocator;
+};
+
+struct _sypha_clist_iterator {
+    struct _sypha_clist * list;
+    uint32_t curr;
+    unsigned int forward;
+    unsigned int is_pristine;
+};
+
+// Leads off a serialized image, the used nodes follow it
+struct _sypha_clist_image {
+    uint32_t magic;
+    uint32_t first;
+    uint32_t last;
+    uint32_t free_first;
+    uint32_t used;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t elem_sz;
+};
+
+// Grows the node array to hold at least capacity nodes, returns 0 on success, otherwise < 0
+static int sypha_clist_grow(struct _sypha_clist * list, size_t capacity) {
+    unsigned char * nodes;
+
+    if (capacity <= list->capacity) {
+        return 0;
+    }
+    if (capacity > SYPHA_CLIST_MAX_COUNT || capacity > ((size_t) -1) / list->node_sz) {
+        return -1;
+    }
+
+    if (!(nodes = (unsigned char *) sypha_realloc(&list->allocator, list->nodes, capacity * list->node_sz))) {
+        return -1;
+    }
+    list->nodes = nodes;
+    list->capacity = (uint32_t) capacity;
+    return 0;
+}
+
+// Hands out an unlinked node holding a copy of data, returns its index or NIL on allocation
+// error.  Can move the node array.
+static uint32_t sypha_clist_node_create(struct _sypha_clist * list, void * data) {
+    uint32_t index;
+    size_t capacity;
+
+    if (list->free_first != SYPHA_CLIST_NIL) {
+        index = list->free_first;
+        list->free_first = SYPHA_CLIST_NODE(list, index)->next;
+    } else {
+        if (list->used == list->capacity) {
+            // Doubling, capped at what an index can reach
+            capacity = (list->capacity) ? ((size_t) list->capacity) * 2 : SYPHA_CLIST_MIN_CAPACITY;
+            if (capacity > SYPHA_CLIST_MAX_COUNT) {
+                capacity = SYPHA_CLIST_MAX_COUNT;
+            }
+            if (sypha_clist_grow(list, capacity) < 0) {
+                return SYPHA_CLIST_NIL;
+            }
+        }
+        index = list->used++;
+    }
+
+    memcpy(SYPHA_CLIST_NODE(list, index)->elem, data, list->elem_sz);
+    return index;
+}
+
+// Links node index in after "after", NIL after means at the front
+static void sypha_clist_node_link_after(struct _sypha_clist * list, uint32_t after, uint32_t index) {
+    struct _sypha_clist_node * node = SYPHA_CLIST_NODE(list, index);
+
+    node->prev = after;
+    node->next = (after != SYPHA_CLIST_NIL) ? SYPHA_CLIST_NODE(list, after)->next : list->first;
+    if (node->next != SYPHA_CLIST_NIL) {
+        SYPHA_CLIST_NODE(list, node->next)->prev = index;
+    } else {
+        list->last = index;
+    }
+    if (after != SYPHA_CLIST_NIL) {
+        SYPHA_CLIST_NODE(list, after)->next = index;
+    } else {
+        list->first = index;
+    }
+    list->count++;
+}
+
+// Links node index in before "before", NIL before means at the back
+static void sypha_clist_node_link_before(struct _sypha_clist * list, uint32_t before, uint32_t index) {
+    sypha_clist_node_link_after(list, (before != SYPHA_CLIST_NIL) ? SYPHA_CLIST_NODE(list, before)->prev : list->last, index);
+}
+
+// Unlinks node index and puts it on the free list
+static void sypha_clist_node_release(struct _sypha_clist * list, uint32_t index) {
+    struct _sypha_clist_node * node = SYPHA_CLIST_NODE(list, index);
+
+    if (node->prev != SYPHA_CLIST_NIL) {
+        SYPHA_CLIST_NODE(list, node->prev)->next = node->next;
+    } else {
+        list->first = node->next;
+    }
+    if (node->next != SYPHA_CLIST_NIL) {
+        SYPHA_CLIST_NODE(list, node->next)->prev = node->prev;
+    } else {
+        list->last = node->prev;
+    }
+
+    node->next = list->free_first;
+    list->free_first = index;
+    list->count--;
+}
+
+SYPHA_CLIST sypha_clist_create(size_t elem_sz) {
+    return sypha_clist_create_with_allocator(NULL, elem_sz);
+}
+
+SYPHA_CLIST sypha_clist_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz) {
+    struct _sypha_clist * list;
+
+    if (elem_sz == 0) {
+        return NULL;
+    }
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(list = (struct _sypha_clist *) sypha_alloc(allocator, sizeof(struct _sypha_clist)))) {
+        return NULL;
+    }
+    memset(list, 0x0, sizeof(struct _sypha_clist));
+    list->allocator = *allocator;
+    sypha_arena_scratch_allocator(allocator, &list->scratch_allocator);
+    list->elem_sz = elem_sz;
+
+    // Keep the links 4 byte aligned, and 8 byte elements 8 byte aligned
+    list->node_sz = sizeof(struct _sypha_clist_node) + elem_sz;
+    list->node_sz = (elem_sz % 8) ? ((list->node_sz + 3) & ~((size_t) 3)) : list->node_sz;
+
+    list->first = SYPHA_CLIST_NIL;
+    list->last = SYPHA_CLIST_NIL;
+    list->free_first = SYPHA_CLIST_NIL;
+
+    return (SYPHA_CLIST) list;
+}
+
+void sypha_clist_destroy(SYPHA_CLIST list) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+    if (!_list) {
+        return;
+    }
+
+    sypha_free(&_list->allocator, _list->nodes);
+    sypha_free(&_list->allocator, _list);
+}
+
+size_t sypha_clist_count(SYPHA_CLIST list) {
+    return ((struct _sypha_clist *) list)->count;
+}
+
+int sypha_clist_reserve(SYPHA_CLIST list, size_t count) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+
+    // Recycled nodes count toward it
+    if (count <= _list->count) {
+        return 0;
+    }
+    return sypha_clist_grow(_list, _list->used + (count - _list->count));
+}
+
+int sypha_clist_append_item(SYPHA_CLIST list, void * data) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+    uint32_t index;
+
+    if ((index = sypha_clist_node_create(_list, data)) == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+    sypha_clist_node_link_after(_list, _list->last, index);
+    return 0;
+}
+
+int sypha_clist_prepend_item(SYPHA_CLIST list, void * data) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+    uint32_t index;
+
+    if ((index = sypha_clist_node_create(_list, data)) == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+    sypha_clist_node_link_after(_list, SYPHA_CLIST_NIL, index);
+    return 0;
+}
+
+size_t sypha_clist_serialized_sz(SYPHA_CLIST list) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+    return sizeof(struct _sypha_clist_image) + ((size_t) _list->used) * _list->node_sz;
+}
+
+void sypha_clist_serialize(SYPHA_CLIST list, void * buffer) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+    struct _sypha_clist_image image;
+
+    memset(&image, 0x0, sizeof(image));
+    image.magic = SYPHA_CLIST_IMAGE_MAGIC;
+    image.first = _list->first;
+    image.last = _list->last;
+    image.free_first = _list->free_first;
+    image.used = _list->used;
+    image.count = _list->count;
+    image.elem_sz = _list->elem_sz;
+
+    memcpy(buffer, &image, sizeof(image));
+    if (_list->used) {
+        memcpy(((unsigned char *) buffer) + sizeof(image), _list->nodes, ((size_t) _list->used) * _list->node_sz);
+    }
+}
+
+// Checks the links of a freshly loaded image: the free list and the live chain have to hold
+// every used node exactly once between them, and the live chain has to link up both ways from
+// first to last.  Returns 0 if they do, otherwise < 0.
+static int sypha_clist_check_links(struct _sypha_clist * list) {
+    struct _sypha_clist_node * node;
+    uint32_t prev = SYPHA_CLIST_NIL;
+    uint32_t index;
+    size_t i;
+
+    // Free nodes get marked so the live chain can't run into one, nor the free list into itself
+    index = list->free_first;
+    for (i=0;i < list->used - list->count;i++) {
+        if (index >= list->used || (node = SYPHA_CLIST_NODE(list, index))->prev == SYPHA_CLIST_FREE_MARK) {
+            return -1;
+        }
+        node->prev = SYPHA_CLIST_FREE_MARK;
+        index = node->next;
+    }
+    if (index != SYPHA_CLIST_NIL) {
+        return -1;
+    }
+
+    // A node seen twice would need two different prevs, so this can't loop either
+    index = list->first;
+    for (i=0;i < list->count;i++) {
+        if (index >= list->used || (node = SYPHA_CLIST_NODE(list, index))->prev != prev) {
+            return -1;
+        }
+        prev = index;
+        index = node->next;
+    }
+    return (index == SYPHA_CLIST_NIL && prev == list->last) ? 0 : -1;
+}
+
+SYPHA_CLIST sypha_clist_create_from_serialized(const SYPHA_ALLOCATOR * allocator, const void * buffer, size_t buffer_sz) {
+    struct _sypha_clist * list;
+    struct _sypha_clist_image image;
+
+    if (buffer_sz < sizeof(image)) {
+        return NULL;
+    }
+    memcpy(&image, buffer, sizeof(image));
+
+    if (image.magic != SYPHA_CLIST_IMAGE_MAGIC || image.elem_sz == 0 || image.elem_sz > ((size_t) -1) / 2 || image.count > image.used) {
+        return NULL;
+    }
+
+    if (!(list = (struct _sypha_clist *) sypha_clist_create_with_allocator(allocator, (size_t) image.elem_sz))) {
+        return NULL;
+    }
+
+    // The ends and free list have to point into the image
+    if (buffer_sz != sizeof(image) + ((size_t) image.used) * list->node_sz ||
+            (image.first != SYPHA_CLIST_NIL && image.first >= image.used) ||
+            (image.last != SYPHA_CLIST_NIL && image.last >= image.used) ||
+            (image.free_first != SYPHA_CLIST_NIL && image.free_first >= image.used) ||
+            ((image.first == SYPHA_CLIST_NIL) != (image.count == 0)) ||
+            sypha_clist_grow(list, image.used) < 0) {
+        sypha_clist_destroy(list);
+        return NULL;
+    }
+
+    if (image.used) {
+        memcpy(list->nodes, ((const unsigned char *) buffer) + sizeof(image), ((size_t) image.used) * list->node_sz);
+    }
+    list->first = image.first;
+    list->last = image.last;
+    list->free_first = image.free_first;
+    list->used = image.used;
+    list->count = (size_t) image.count;
+
+    if (sypha_clist_check_links(list) < 0) {
+        sypha_clist_destroy(list);
+        return NULL;
+    }
+
+    return (SYPHA_CLIST) list;
+}
+
+SYPHA_CLIST_ITERATOR sypha_clist_get_iterator_front(SYPHA_CLIST list) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+    struct _sypha_clist_iterator * iterator;
+    if (!(iterator = (struct _sypha_clist_iterator *) sypha_alloc(&_list->scratch_allocator, sizeof(struct _sypha_clist_iterator)))) {
+        return NULL;
+    }
+
+    iterator->list = _list;
+    iterator->curr = _list->first;
+    iterator->forward = 1;
+    iterator->is_pristine = 1;
+
+    return (SYPHA_CLIST_ITERATOR) iterator;
+}
+
+SYPHA_CLIST_ITERATOR sypha_clist_get_iterator_back(SYPHA_CLIST list) {
+    struct _sypha_clist * _list = (struct _sypha_clist *) list;
+    struct _sypha_clist_iterator * iterator;
+    if (!(iterator = (struct _sypha_clist_iterator *) sypha_alloc(&_list->scratch_allocator, sizeof(struct _sypha_clist_iterator)))) {
+        return NULL;
+    }
+
+    iterator->list = _list;
+    iterator->curr = _list->last;
+    iterator->forward = 0;
+    iterator->is_pristine = 1;
+
+    return (SYPHA_CLIST_ITERATOR) iterator;
+}
+
+void sypha_clist_destroy_iterator(SYPHA_CLIST_ITERATOR iterator) {
+    struct _sypha_clist_iterator * _iterator = (struct _sypha_clist_iterator *) iterator;
+    if (!_iterator) {
+        return;
+    }
+    sypha_free(&_iterator->list->scratch_allocator, _iterator);
+}
+
+void * sypha_clist_iterator_get(SYPHA_CLIST_ITERATOR iterator) {
+    struct _sypha_clist_iterator * _iterator = (struct _sypha_clist_iterator *) iterator;
+
+    // Iterator not started OR empty list
+    if (_iterator->is_pristine || _iterator->curr == SYPHA_CLIST_NIL) {
+        return NULL;
+    }
+
+    return SYPHA_CLIST_NODE(_iterator->list, _iterator->curr)->elem;
+}
+
+int sypha_clist_iterator_next(SYPHA_CLIST_ITERATOR iterator) {
+    struct _sypha_clist_iterator * _iterator = (struct _sypha_clist_iterator *) iterator;
+    struct _sypha_clist_node * node;
+    uint32_t next;
+
+    // Empty list case
+    if (_iterator->curr == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+
+    // In the initial state so don't move and clense that state
+    if (_iterator->is_pristine) {
+        _iterator->is_pristine = 0;
+        return 0;
+    }
+
+    node = SYPHA_CLIST_NODE(_iterator->list, _iterator->curr);
+    if ((next = (_iterator->forward) ? node->next : node->prev) == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+    _iterator->curr = next;
+
+    return 0;
+}
+
+int sypha_clist_iterator_previous(SYPHA_CLIST_ITERATOR iterator) {
+    struct _sypha_clist_iterator * _iterator = (struct _sypha_clist_iterator *) iterator;
+    struct _sypha_clist_node * node;
+    uint32_t next;
+
+    // Empty list case, and you can't move to the previous node from the initial state
+    if (_iterator->curr == SYPHA_CLIST_NIL || _iterator->is_pristine) {
+        return -1;
+    }
+
+    node = SYPHA_CLIST_NODE(_iterator->list, _iterator->curr);
+    if ((next = (_iterator->forward) ? node->prev : node->next) == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+    _iterator->curr = next;
+
+    return 0;
+}
+
+int sypha_clist_iterator_insert_after(SYPHA_CLIST_ITERATOR iterator, void * data) {
+    struct _sypha_clist_iterator * _iterator = (struct _sypha_clist_iterator *) iterator;
+    struct _sypha_clist * _list = _iterator->list;
+    uint32_t index;
+
+    if ((index = sypha_clist_node_create(_list, data)) == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+
+    // You can add an item from initial state since it is suppose to be one behind it.  So allow this
+    // and leave the initial state in tact so next() still has to be called.  Same goes for an
+    // iterator on an empty list.
+    if (_iterator->is_pristine || _iterator->curr == SYPHA_CLIST_NIL) {
+        if (_iterator->forward) {
+            sypha_clist_node_link_after(_list, SYPHA_CLIST_NIL, index);
+        } else {
+            sypha_clist_node_link_before(_list, SYPHA_CLIST_NIL, index);
+        }
+        _iterator->curr = index;
+    } else if (_iterator->forward) {
+        sypha_clist_node_link_after(_list, _iterator->curr, index);
+    } else {
+        sypha_clist_node_link_before(_list, _iterator->curr, index);
+    }
+
+    return 0;
+}
+
+int sypha_clist_iterator_insert_before(SYPHA_CLIST_ITERATOR iterator, void * data) {
+    struct _sypha_clist_iterator * _iterator = (struct _sypha_clist_iterator *) iterator;
+    struct _sypha_clist * _list = _iterator->list;
+    uint32_t index;
+
+    // Can't add anything from initial state.  Regardless of moving forward or backward, the iterator
+    // is intially positioned "before" a first item so adding BEFORE THAT doesn't make sense.
+    if (_iterator->is_pristine || _iterator->curr == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+
+    if ((index = sypha_clist_node_create(_list, data)) == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+
+    if (_iterator->forward) {
+        sypha_clist_node_link_before(_list, _iterator->curr, index);
+    } else {
+        sypha_clist_node_link_after(_list, _iterator->curr, index);
+    }
+
+    return 0;
+}
+
+int sypha_clist_iterator_delete_current(SYPHA_CLIST_ITERATOR iterator) {
+    struct _sypha_clist_iterator * _iterator = (struct _sypha_clist_iterator *) iterator;
+    struct _sypha_clist * _list = _iterator->list;
+    struct _sypha_clist_node * node;
+    uint32_t curr = _iterator->curr;
+    uint32_t curr_prev, curr_next;
+
+    // Can't remove anything from initial state, or an empty list
+    if (_iterator->is_pristine || curr == SYPHA_CLIST_NIL) {
+        return -1;
+    }
+
+    node = SYPHA_CLIST_NODE(_list, curr);
+    curr_prev = node->prev;
+    curr_next = node->next;
+    sypha_clist_node_release(_list, curr);
+
+    // Reposition to the "previous" item from the iterator's perspective.  If there isn't one
+    // then we deleted the head of the iteration so go back to the initial state in front of
+    // the new head.
+    if ((_iterator->curr = (_iterator->forward) ? curr_prev : curr_next) == SYPHA_CLIST_NIL) {
+        _iterator->curr = (_iterator->forward) ? curr_next : curr_prev;
+        _iterator->is_pristine = 1;
+    }
+
+    return 0;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,275 @@
+/* sypha_deque.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <memory.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_deque.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+// Blocks are sized to about this many bytes, rounded down to a power of 2 count of elements
+#define SYPHA_DEQUE_BLOCK_SZ        4096
+
+// But never hold fewer elements than this
+#define SYPHA_DEQUE_MIN_BLOCK_ELEMS 8
+
+struct _sypha_deque {
+    size_t elem_sz;
+    size_t block_shift;     // log2 of the elements per block
+    size_t count;
+
+    // Ring of block_count (power of 2) block slots, positions run around all
+    // block_count << block_shift elements.  Slots get a block the first time they're used.
+    unsigned char ** blocks;
+    size_t block_count;
+    size_t head;            // ring position of the front element
+
+    SYPHA_ALLOCATOR allocator;
+};
+
+#define SYPHA_DEQUE_BLOCK_ELEMS(deque)  (((size_t) 1) << (deque)->block_shift)
+#define SYPHA_DEQUE_CAPACITY(deque)     ((deque)->block_count << (deque)->block_shift)
+
+// Element at ring position pos, its block has to be there
+static inline unsigned char * sypha_deque_slot(struct _sypha_deque * deque, size_t pos) {
+    return deque->blocks[pos >> deque->block_shift] + (pos & (SYPHA_DEQUE_BLOCK_ELEMS(deque) - 1)) * deque->elem_sz;
+}
+
+// Doubles the ring (or makes the first one).  Positions past head keep their place, the ones
+// that had wrapped around to the start move up by the old capacity so the elements stay in
+// order.  Returns 0 on success, otherwise < 0 and the deque is left as it was.
+static int sypha_deque_grow(struct _sypha_deque * deque) {
+    size_t block_count = (deque->block_count) ? deque->block_count * 2 : 1;
+    size_t capacity = SYPHA_DEQUE_CAPACITY(deque);
+    size_t head_block = deque->head >> deque->block_shift;
+    size_t wrapped = (deque->head + deque->count > capacity) ? deque->head + deque->count - capacity : 0;
+    unsigned char ** blocks;
+    unsigned char * split = NULL;
+    size_t i;
+
+    if (block_count > ((size_t) -1) / sizeof(unsigned char *) || (block_count << deque->block_shift) >> deque->block_shift != block_count) {
+        return -1;
+    }
+    if (!(blocks = (unsigned char **) sypha_alloc(&deque->allocator, block_count * sizeof(unsigned char *)))) {
+        return -1;
+    }
+
+    // When the back has wrapped all the way into the front's block, that block holds both
+    // ends and the back's part gets a block of its own
+    if (wrapped > (head_block << deque->block_shift)) {
+        if (!(split = (unsigned char *) sypha_alloc(&deque->allocator, deque->elem_sz << deque->block_shift))) {
+            sypha_free(&deque->allocator, blocks);
+            return -1;
+        }
+        memcpy(split, deque->blocks[head_block], (wrapped - (head_block << deque->block_shift)) * deque->elem_sz);
+    }
+
+    memset(blocks, 0x0, block_count * sizeof(unsigned char *));
+    for (i=0;i < deque->block_count;i++) {
+        blocks[(i < head_block) ? i + deque->block_count : i] = deque->blocks[i];
+    }
+    if (split) {
+        blocks[head_block + deque->block_count] = split;
+    }
+
+    sypha_free(&deque->allocator, deque->blocks);
+    deque->blocks = blocks;
+    deque->block_count = block_count;
+    return 0;
+}
+
+// Makes sure the block for ring position pos is there
+static inline int sypha_deque_ensure_block(struct _sypha_deque * deque, size_t pos) {
+    unsigned char ** block = &deque->blocks[pos >> deque->block_shift];
+    if (!*block && !(*block = (unsigned char *) sypha_alloc(&deque->allocator, deque->elem_sz << deque->block_shift))) {
+        return -1;
+    }
+    return 0;
+}
+
+SYPHA_DEQUE sypha_deque_create(size_t elem_sz) {
+    return sypha_deque_create_with_allocator(NULL, elem_sz);
+}
+
+SYPHA_DEQUE sypha_deque_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz) {
+    struct _sypha_deque * deque;
+
+    if (!elem_sz || elem_sz > ((size_t) -1) / (SYPHA_DEQUE_MIN_BLOCK_ELEMS * 2)) {
+        return NULL;
+    }
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(deque = (struct _sypha_deque *) sypha_alloc(allocator, sizeof(struct _sypha_deque)))) {
+        return NULL;
+    }
+    memset(deque, 0x0, sizeof(struct _sypha_deque));
+    deque->elem_sz = elem_sz;
+    deque->allocator = *allocator;
+
+    while ((((size_t) 2) << deque->block_shift) * elem_sz <= SYPHA_DEQUE_BLOCK_SZ || (((size_t) 1) << deque->block_shift) < SYPHA_DEQUE_MIN_BLOCK_ELEMS) {
+        deque->block_shift++;
+    }
+
+    return (SYPHA_DEQUE) deque;
+}
+
+void sypha_deque_destroy(SYPHA_DEQUE deque) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+    size_t i;
+    if (!_deque) {
+        return;
+    }
+
+    for (i=0;i < _deque->block_count;i++) {
+        sypha_free(&_deque->allocator, _deque->blocks[i]);
+    }
+    sypha_free(&_deque->allocator, _deque->blocks);
+    sypha_free(&_deque->allocator, _deque);
+}
+
+size_t sypha_deque_count(SYPHA_DEQUE deque) {
+    return ((struct _sypha_deque *) deque)->count;
+}
+
+size_t sypha_deque_capacity(SYPHA_DEQUE deque) {
+    return SYPHA_DEQUE_CAPACITY((struct _sypha_deque *) deque);
+}
+
+int sypha_deque_reserve(SYPHA_DEQUE deque, size_t count) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+    while (SYPHA_DEQUE_CAPACITY(_deque) < count) {
+        if (sypha_deque_grow(_deque) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void sypha_deque_shrink(SYPHA_DEQUE deque) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+    size_t capacity = SYPHA_DEQUE_CAPACITY(_deque);
+    size_t block_elems = SYPHA_DEQUE_BLOCK_ELEMS(_deque);
+    size_t i;
+    size_t offset;
+
+    for (i=0;i < _deque->block_count;i++) {
+        // Where the block starts counting from the front, a block straddling the front holds it
+        offset = ((i << _deque->block_shift) - _deque->head) & (capacity - 1);
+        if (_deque->count && (offset < _deque->count || offset + block_elems > capacity)) {
+            continue;
+        }
+        sypha_free(&_deque->allocator, _deque->blocks[i]);
+        _deque->blocks[i] = NULL;
+    }
+}
+
+void sypha_deque_clear(SYPHA_DEQUE deque) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+    _deque->count = 0;
+    _deque->head = 0;
+}
+
+int sypha_deque_push_back(SYPHA_DEQUE deque, const void * data) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+    size_t pos;
+
+    if (_deque->count == SYPHA_DEQUE_CAPACITY(_deque) && sypha_deque_grow(_deque) < 0) {
+        return -1;
+    }
+
+    pos = (_deque->head + _deque->count) & (SYPHA_DEQUE_CAPACITY(_deque) - 1);
+    if (sypha_deque_ensure_block(_deque, pos) < 0) {
+        return -1;
+    }
+    memcpy(sypha_deque_slot(_deque, pos), data, _deque->elem_sz);
+    _deque->count++;
+    return 0;
+}
+
+int sypha_deque_push_front(SYPHA_DEQUE deque, const void * data) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+    size_t pos;
+
+    if (_deque->count == SYPHA_DEQUE_CAPACITY(_deque) && sypha_deque_grow(_deque) < 0) {
+        return -1;
+    }
+
+    pos = (_deque->head - 1) & (SYPHA_DEQUE_CAPACITY(_deque) - 1);
+    if (sypha_deque_ensure_block(_deque, pos) < 0) {
+        return -1;
+    }
+    memcpy(sypha_deque_slot(_deque, pos), data, _deque->elem_sz);
+    _deque->head = pos;
+    _deque->count++;
+    return 0;
+}
+
+int sypha_deque_pop_back(SYPHA_DEQUE deque, void * data) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+
+    if (!_deque->count) {
+        return -1;
+    }
+
+    _deque->count--;
+    if (data) {
+        memcpy(data, sypha_deque_slot(_deque, (_deque->head + _deque->count) & (SYPHA_DEQUE_CAPACITY(_deque) - 1)), _deque->elem_sz);
+    }
+    return 0;
+}
+
+int sypha_deque_pop_front(SYPHA_DEQUE deque, void * data) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+
+    if (!_deque->count) {
+        return -1;
+    }
+
+    if (data) {
+        memcpy(data, sypha_deque_slot(_deque, _deque->head), _deque->elem_sz);
+    }
+    _deque->head = (_deque->head + 1) & (SYPHA_DEQUE_CAPACITY(_deque) - 1);
+    _deque->count--;
+    return 0;
+}
+
+void * sypha_deque_at(SYPHA_DEQUE deque, size_t index) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+
+    if (index >= _deque->count) {
+        return NULL;
+    }
+    return sypha_deque_slot(_deque, (_deque->head + index) & (SYPHA_DEQUE_CAPACITY(_deque) - 1));
+}
+
+void * sypha_deque_front(SYPHA_DEQUE deque) {
+    return sypha_deque_at(deque, 0);
+}
+
+void * sypha_deque_back(SYPHA_DEQUE deque) {
+    struct _sypha_deque * _deque = (struct _sypha_deque *) deque;
+    return (_deque->count) ? sypha_deque_at(deque, _deque->count - 1) : NULL;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,418 @@
+/* sypha_heap.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <memory.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_heap.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+// Children per node
+#define SYPHA_HEAP_ARITY            4
+
+// Room the first growth makes
+#define SYPHA_HEAP_MIN_CAPACITY     16
+
+// Ends the free handle chain
+#define SYPHA_HEAP_NO_HANDLE        ((size_t) -1)
+
+#define SYPHA_HEAP_ALIGN(sz)        (((sz) + 7) & ~((size_t) 7))
+
+// Address of the element at heap position i
+#define SYPHA_HEAP_ELEM(heap, i)    ((heap)->elems + (i) * (heap)->elem_sz)
+
+struct _sypha_heap {
+    size_t count;
+    size_t capacity;
+    size_t elem_sz;
+
+    // One allocation: capacity + 1 elements in heap order (the extra one holds an element
+    // being sifted), the handle at each position and the position of each handle.  A free
+    // handle's position is the next free handle instead.
+    unsigned char * elems;
+    size_t * handles;
+    size_t * positions;
+    size_t next_handle;     // handles below this have been given out
+    size_t free_handle;
+
+    SYPHA_LIST_COMPARATOR cmp;
+    void * ctx;
+    SYPHA_ALLOCATOR allocator;
+};
+
+// Element copy, common sizes get a fixed size copy the compiler can inline
+static inline void sypha_heap_copy(struct _sypha_heap * heap, void * dst, const void * src) {
+    switch (heap->elem_sz) {
+        case 8:
+            memcpy(dst, src, 8);
+            break;
+        case 16:
+            memcpy(dst, src, 16);
+            break;
+        default:
+            memcpy(dst, src, heap->elem_sz);
+    }
+}
+
+static inline int sypha_heap_less(struct _sypha_heap * heap, const void * a, const void * b) {
+    return heap->cmp(a, heap->elem_sz, b, heap->elem_sz, heap->ctx) < 0;
+}
+
+// Puts the element and handle held aside in the spare slot at position i
+static inline void sypha_heap_place(struct _sypha_heap * heap, size_t i, size_t handle) {
+    sypha_heap_copy(heap, SYPHA_HEAP_ELEM(heap, i), SYPHA_HEAP_ELEM(heap, heap->capacity));
+    heap->handles[i] = handle;
+    heap->positions[handle] = i;
+}
+
+// Moves the element at from into the hole at to
+static inline void sypha_heap_move(struct _sypha_heap * heap, size_t from, size_t to) {
+    sypha_heap_copy(heap, SYPHA_HEAP_ELEM(heap, to), SYPHA_HEAP_ELEM(heap, from));
+    heap->handles[to] = heap->handles[from];
+    heap->positions[heap->handles[to]] = to;
+}
+
+// Moves the element at i up past any larger parents
+static void sypha_heap_sift_up(struct _sypha_heap * heap, size_t i) {
+    unsigned char * held = SYPHA_HEAP_ELEM(heap, heap->capacity);
+    size_t handle = heap->handles[i];
+    size_t parent;
+
+    sypha_heap_copy(heap, held, SYPHA_HEAP_ELEM(heap, i));
+    while (i > 0) {
+        parent = (i - 1) / SYPHA_HEAP_ARITY;
+        if (!sypha_heap_less(heap, held, SYPHA_HEAP_ELEM(heap, parent))) {
+            break;
+        }
+        sypha_heap_move(heap, parent, i);
+        i = parent;
+    }
+    sypha_heap_place(heap, i, handle);
+}
+
+// Moves the element at i down past any smaller children
+static void sypha_heap_sift_down(struct _sypha_heap * heap, size_t i) {
+    unsigned char * held = SYPHA_HEAP_ELEM(heap, heap->capacity);
+    size_t handle = heap->handles[i];
+    size_t child;
+    size_t last;
+    size_t smallest;
+
+    sypha_heap_copy(heap, held, SYPHA_HEAP_ELEM(heap, i));
+    while ((child = i * SYPHA_HEAP_ARITY + 1) < heap->count) {
+        last = (child + SYPHA_HEAP_ARITY < heap->count) ? child + SYPHA_HEAP_ARITY : heap->count;
+        for (smallest=child++;child < last;child++) {
+            if (sypha_heap_less(heap, SYPHA_HEAP_ELEM(heap, child), SYPHA_HEAP_ELEM(heap, smallest))) {
+                smallest = child;
+            }
+        }
+        if (!sypha_heap_less(heap, SYPHA_HEAP_ELEM(heap, smallest), held)) {
+            break;
+        }
+        sypha_heap_move(heap, smallest, i);
+        i = smallest;
+    }
+    sypha_heap_place(heap, i, handle);
+}
+
+// Fills the hole at i with the element moved from the end.  That element is usually among the
+// largest, so rather than comparing it at every level the hole goes all the way down along the
+// smallest children and the element sifts up from there, which is nearly always a short trip.
+static void sypha_heap_refill(struct _sypha_heap * heap, size_t i) {
+    unsigned char * held = SYPHA_HEAP_ELEM(heap, heap->capacity);
+    size_t handle = heap->handles[heap->count];
+    size_t child;
+    size_t last;
+    size_t smallest;
+    size_t parent;
+
+    sypha_heap_copy(heap, held, SYPHA_HEAP_ELEM(heap, heap->count));
+    while ((child = i * SYPHA_HEAP_ARITY + 1) < heap->count) {
+        last = (child + SYPHA_HEAP_ARITY < heap->count) ? child + SYPHA_HEAP_ARITY : heap->count;
+        for (smallest=child++;child < last;child++) {
+            if (sypha_heap_less(heap, SYPHA_HEAP_ELEM(heap, child), SYPHA_HEAP_ELEM(heap, smallest))) {
+                smallest = child;
+            }
+        }
+        sypha_heap_move(heap, smallest, i);
+        i = smallest;
+    }
+    while (i > 0) {
+        parent = (i - 1) / SYPHA_HEAP_ARITY;
+        if (!sypha_heap_less(heap, held, SYPHA_HEAP_ELEM(heap, parent))) {
+            break;
+        }
+        sypha_heap_move(heap, parent, i);
+        i = parent;
+    }
+    sypha_heap_place(heap, i, handle);
+}
+
+// Sets the room to exactly capacity elements, returns 0 on success, otherwise < 0 and the heap
+// is left as it was
+static int sypha_heap_resize(struct _sypha_heap * heap, size_t capacity) {
+    size_t elems_sz;
+    unsigned char * block;
+
+    if (capacity >= ((size_t) -1) / 2 / heap->elem_sz || capacity >= ((size_t) -1) / 4 / sizeof(size_t)) {
+        return -1;
+    }
+    elems_sz = SYPHA_HEAP_ALIGN((capacity + 1) * heap->elem_sz);
+    if (!(block = (unsigned char *) sypha_alloc(&heap->allocator, elems_sz + 2 * capacity * sizeof(size_t)))) {
+        return -1;
+    }
+
+    if (heap->elems) {
+        memcpy(block, heap->elems, heap->count * heap->elem_sz);
+        memcpy(block + elems_sz, heap->handles, heap->count * sizeof(size_t));
+        memcpy(block + elems_sz + capacity * sizeof(size_t), heap->positions, heap->next_handle * sizeof(size_t));
+        sypha_free(&heap->allocator, heap->elems);
+    }
+    heap->elems = block;
+    heap->handles = (size_t *) (block + elems_sz);
+    heap->positions = heap->handles + capacity;
+    heap->capacity = capacity;
+    return 0;
+}
+
+// Makes room for count more elements, doubling so pushes stay amortized O(1)
+static int sypha_heap_grow(struct _sypha_heap * heap, size_t count) {
+    size_t capacity;
+
+    if (count > ((size_t) -1) / 4 - heap->count) {
+        return -1;
+    }
+    if (heap->count + count <= heap->capacity) {
+        return 0;
+    }
+
+    capacity = (heap->capacity) ? heap->capacity : SYPHA_HEAP_MIN_CAPACITY;
+    while (capacity < heap->count + count) {
+        capacity *= 2;
+    }
+    return sypha_heap_resize(heap, capacity);
+}
+
+// Hands out a handle for the element at position i.  There are never more handles in use than
+// elements, so next_handle stays within capacity.
+static inline size_t sypha_heap_new_handle(struct _sypha_heap * heap, size_t i) {
+    size_t handle = heap->free_handle;
+
+    if (handle != SYPHA_HEAP_NO_HANDLE) {
+        heap->free_handle = heap->positions[handle];
+    } else {
+        handle = heap->next_handle++;
+    }
+    heap->handles[i] = handle;
+    heap->positions[handle] = i;
+    return handle;
+}
+
+// Position of the element handle names, count if the handle isn't live
+static inline size_t sypha_heap_position(struct _sypha_heap * heap, SYPHA_HEAP_HANDLE handle) {
+    size_t i;
+
+    if (handle >= heap->next_handle || (i = heap->positions[handle]) >= heap->count || heap->handles[i] != handle) {
+        return heap->count;
+    }
+    return i;
+}
+
+// Takes the element at position i out, filling the hole from the end
+static void sypha_heap_remove_at(struct _sypha_heap * heap, size_t i, void * data) {
+    size_t handle = heap->handles[i];
+
+    if (data) {
+        memcpy(data, SYPHA_HEAP_ELEM(heap, i), heap->elem_sz);
+    }
+
+    heap->count--;
+    if (i != heap->count) {
+        sypha_heap_refill(heap, i);
+    }
+
+    heap->positions[handle] = heap->free_handle;
+    heap->free_handle = handle;
+}
+
+SYPHA_HEAP sypha_heap_create(size_t elem_sz, SYPHA_LIST_COMPARATOR cmp, void * ctx) {
+    return sypha_heap_create_with_allocator(NULL, elem_sz, cmp, ctx);
+}
+
+SYPHA_HEAP sypha_heap_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz, SYPHA_LIST_COMPARATOR cmp, void * ctx) {
+    struct _sypha_heap * heap;
+
+    if (elem_sz == 0 || !cmp) {
+        return NULL;
+    }
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(heap = (struct _sypha_heap *) sypha_alloc(allocator, sizeof(struct _sypha_heap)))) {
+        return NULL;
+    }
+    memset(heap, 0x0, sizeof(struct _sypha_heap));
+    heap->elem_sz = elem_sz;
+    heap->free_handle = SYPHA_HEAP_NO_HANDLE;
+    heap->cmp = cmp;
+    heap->ctx = ctx;
+    heap->allocator = *allocator;
+
+    return (SYPHA_HEAP) heap;
+}
+
+void sypha_heap_destroy(SYPHA_HEAP heap) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+    if (!_heap) {
+        return;
+    }
+
+    sypha_free(&_heap->allocator, _heap->elems);
+    sypha_free(&_heap->allocator, _heap);
+}
+
+size_t sypha_heap_count(SYPHA_HEAP heap) {
+    return ((struct _sypha_heap *) heap)->count;
+}
+
+int sypha_heap_reserve(SYPHA_HEAP heap, size_t count) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+
+    if (count <= _heap->capacity) {
+        return 0;
+    }
+    return sypha_heap_resize(_heap, count);
+}
+
+void sypha_heap_clear(SYPHA_HEAP heap) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+
+    _heap->count = 0;
+    _heap->next_handle = 0;
+    _heap->free_handle = SYPHA_HEAP_NO_HANDLE;
+}
+
+int sypha_heap_push(SYPHA_HEAP heap, const void * data, SYPHA_HEAP_HANDLE * handle) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+    size_t new_handle;
+
+    if (sypha_heap_grow(_heap, 1) < 0) {
+        return -1;
+    }
+
+    memcpy(SYPHA_HEAP_ELEM(_heap, _heap->count), data, _heap->elem_sz);
+    new_handle = sypha_heap_new_handle(_heap, _heap->count);
+    _heap->count++;
+    sypha_heap_sift_up(_heap, _heap->count - 1);
+
+    if (handle) {
+        *handle = new_handle;
+    }
+    return 0;
+}
+
+int sypha_heap_push_many(SYPHA_HEAP heap, const void * base, size_t count, SYPHA_HEAP_HANDLE * handles) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+    size_t first = _heap->count;
+    size_t i;
+
+    if (sypha_heap_grow(_heap, count) < 0) {
+        return -1;
+    }
+
+    memcpy(SYPHA_HEAP_ELEM(_heap, first), base, count * _heap->elem_sz);
+    for (i=0;i < count;i++) {
+        size_t handle = sypha_heap_new_handle(_heap, first + i);
+        if (handles) {
+            handles[i] = handle;
+        }
+    }
+    _heap->count += count;
+
+    // Sifting each new element up costs about count * log(count), rebuilding the whole heap
+    // bottom up costs about the total count
+    if (count >= first) {
+        for (i=(_heap->count + SYPHA_HEAP_ARITY - 2) / SYPHA_HEAP_ARITY;i > 0;i--) {
+            sypha_heap_sift_down(_heap, i - 1);
+        }
+    } else {
+        for (i=first;i < _heap->count;i++) {
+            sypha_heap_sift_up(_heap, i);
+        }
+    }
+    return 0;
+}
+
+void * sypha_heap_peek(SYPHA_HEAP heap) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+    return (_heap->count) ? _heap->elems : NULL;
+}
+
+int sypha_heap_pop(SYPHA_HEAP heap, void * data) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+
+    if (!_heap->count) {
+        return -1;
+    }
+
+    sypha_heap_remove_at(_heap, 0, data);
+    return 0;
+}
+
+void * sypha_heap_get(SYPHA_HEAP heap, SYPHA_HEAP_HANDLE handle) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+    size_t i = sypha_heap_position(_heap, handle);
+
+    return (i < _heap->count) ? SYPHA_HEAP_ELEM(_heap, i) : NULL;
+}
+
+int sypha_heap_update(SYPHA_HEAP heap, SYPHA_HEAP_HANDLE handle, const void * data) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+    size_t i = sypha_heap_position(_heap, handle);
+
+    if (i >= _heap->count) {
+        return -1;
+    }
+
+    memcpy(SYPHA_HEAP_ELEM(_heap, i), data, _heap->elem_sz);
+    if (i > 0 && sypha_heap_less(_heap, SYPHA_HEAP_ELEM(_heap, i), SYPHA_HEAP_ELEM(_heap, (i - 1) / SYPHA_HEAP_ARITY))) {
+        sypha_heap_sift_up(_heap, i);
+    } else {
+        sypha_heap_sift_down(_heap, i);
+    }
+    return 0;
+}
+
+int sypha_heap_remove(SYPHA_HEAP heap, SYPHA_HEAP_HANDLE handle, void * data) {
+    struct _sypha_heap * _heap = (struct _sypha_heap *) heap;
+    size_t i = sypha_heap_position(_heap, handle);
+
+    if (i >= _heap->count) {
+        return -1;
+    }
+
+    sypha_heap_remove_at(_heap, i, data);
+    return 0;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
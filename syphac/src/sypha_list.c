@@ -17,248 +17,1289 @@
 
 #include <stdlib.h>
 #include <memory.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
 #include "syphac/sypha_list.h"
+#include "syphac/sypha_list_inline.h"
+#include "syphac/sypha_pool.h"
 
 #if defined(__cplusplus)
 extern "C" {
 #endif // __cplusplus
 
-struct _sypha_list_item {
-    void * data;
-    size_t data_sz;
-    
-    struct _sypha_list_item * prev;
-    struct _sypha_list_item * next;
+// Largest single allocation a batch insert makes, keeps it under the heap's mmap threshold
+#define SYPHA_LIST_BLOCK_MAX_SZ     (64 * 1024)
+
+// Parallel sort won't bother with threads unless each gets at least this many items
+#define SYPHA_LIST_SORT_MIN_PER_THREAD  16384
+
+// Parallel algorithms cut the list into this many segments per pool thread so a slow segment
+// doesn't hold everyone up, but no segment smaller than the minimum
+#define SYPHA_LIST_PARALLEL_SEGMENTS_PER_THREAD     4
+#define SYPHA_LIST_PARALLEL_MIN_SEGMENT             256
+#define SYPHA_LIST_PARALLEL_MAX_SEGMENTS            256
+
+// Slab slots (and their payloads) are kept 8 byte aligned like the item header
+#define SYPHA_LIST_SLAB_ALIGN(sz)   (((sz) + 7) & ~((size_t) 7))
+
+// Pooled lists carve their items out of slabs, the slots follow the header.  Batch blocks from
+// append_many / prepend_many use the same header and are chained in with the slabs.  Every slot
+// starts with a pointer back to its slab, the item follows it.
+//
+// A slab lives as long as it has refs: one for each of its slots handed out, plus one for the
+// list whose chain it is on.  Pool slots released by that list go on its free list for reuse and
+// keep their ref, so recycling a slot never touches the count.  A batch block goes as soon as its
+// last item does.
+struct _sypha_list_slab {
+    struct _sypha_list_slab * next;
+    struct _sypha_list_slab * prev;
+    struct _sypha_list * owner;
+    size_t slot_sz;
+    size_t refs;
 };
 
-struct _sypha_list {
-    size_t count;
-    struct _sypha_list_item * first;
-    struct _sypha_list_item * last;
-};
+// Room taken up by the back pointer in front of each slab item
+#define SYPHA_LIST_SLOT_HEADER_SZ   sizeof(struct _sypha_list_slab *)
+
+// Item flags for items living in a slab or batch block
+#define SYPHA_LIST_ITEM_IN_SLAB     (SYPHA_LIST_ITEM_POOLED | SYPHA_LIST_ITEM_BLOCK)
+
+static inline struct _sypha_list_slab * sypha_list_item_slab(struct _sypha_list_item * list_item) {
+    return ((struct _sypha_list_slab **) list_item)[-1];
+}
+
+// Puts the item in slot and points it back at slab
+static inline struct _sypha_list_item * sypha_list_slot_item(struct _sypha_list_slab * slab, unsigned char * slot) {
+    *((struct _sypha_list_slab **) slot) = slab;
+    return (struct _sypha_list_item *) (slot + SYPHA_LIST_SLOT_HEADER_SZ);
+}
+
+// Links a new slab in at the head of the list's chain, holding the list's ref
+static void sypha_list_slab_link(struct _sypha_list * list, struct _sypha_list_slab * slab, size_t slot_sz) {
+    slab->prev = NULL;
+    slab->next = list->slabs;
+    if (slab->next) {
+        slab->next->prev = slab;
+    } else {
+        list->slabs_last = slab;
+    }
+    list->slabs = slab;
+    slab->owner = list;
+    slab->slot_sz = slot_sz;
+    slab->refs = 1;
+}
+
+// Takes a slab out of the list's chain
+static void sypha_list_slab_unlink(struct _sypha_list * list, struct _sypha_list_slab * slab) {
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        list->slabs = slab->next;
+    }
+    if (slab->next) {
+        slab->next->prev = slab->prev;
+    } else {
+        list->slabs_last = slab->prev;
+    }
+}
+
+// Marks a change to the list's links
+static inline void sypha_list_touch(struct _sypha_list * list) {
+    __atomic_add_fetch(&list->version, 1, __ATOMIC_RELEASE);
+}
+
+// Grabs a pool slot from the free list or the current slab, returns NULL on allocation error
+static struct _sypha_list_item * sypha_list_slot_alloc(struct _sypha_list * list) {
+    struct _sypha_list_item * list_item;
+    struct _sypha_list_slab * slab;
+    size_t slab_header_sz = SYPHA_LIST_SLAB_ALIGN(sizeof(struct _sypha_list_slab));
+
+    // Recycle deleted items first
+    if ((list_item = list->free_items)) {
+        list->free_items = list_item->next;
+        return list_item;
+    }
+
+    // Current slab used up?
+    if (list->slab_next == list->slab_end) {
+        if (!(slab = (struct _sypha_list_slab *) sypha_alloc(&list->allocator, slab_header_sz + list->slot_sz * list->slots_per_slab))) {
+            return NULL;
+        }
+        sypha_list_slab_link(list, slab, list->slot_sz);
+        list->slab_next = ((unsigned char *) slab) + slab_header_sz;
+        list->slab_end = list->slab_next + list->slot_sz * list->slots_per_slab;
+    }
+
+    // Batch blocks may have gone in ahead of the current slab, find it from where it ends
+    slab = (struct _sypha_list_slab *) (list->slab_end - list->slot_sz * list->slots_per_slab - slab_header_sz);
+    list_item = sypha_list_slot_item(slab, list->slab_next);
+    list->slab_next += list->slot_sz;
+    __atomic_add_fetch(&slab->refs, 1, __ATOMIC_RELAXED);
+    return list_item;
+}
+
+// Allocates an unlinked item holding a copy of data, or just the pointer for a ref, returns NULL
+// on allocation error
+static struct _sypha_list_item * sypha_list_item_create(struct _sypha_list * list, void * data, size_t data_sz, int is_ref) {
+    struct _sypha_list_item * list_item;
+    size_t stored_sz = (is_ref) ? sizeof(void *) : data_sz;
+
+    if (list->slot_sz && stored_sz <= list->slot_data_sz) {
+        if (!(list_item = sypha_list_slot_alloc(list))) {
+            return NULL;
+        }
+        list_item->flags = SYPHA_LIST_ITEM_POOLED;
+    } else {
+        // Not pooled or too big for a slot
+        if (!(list_item = (struct _sypha_list_item *) sypha_alloc(&list->allocator, sizeof(struct _sypha_list_item) + stored_sz))) {
+            return NULL;
+        }
+        list_item->flags = 0;
+        list->heap_item_count++;
+    }
+
+    if (is_ref) {
+        *((void **) list_item->data) = data;
+        list_item->flags |= SYPHA_LIST_ITEM_REF;
+        list->ref_item_count++;
+    } else {
+        memcpy(list_item->data, data, data_sz);
+    }
+    list_item->data_sz = data_sz;
+
+    return list_item;
+}
+
+// Drops the ref a slab item holds on its slab.  The owning list keeps slots of its pool size for
+// reuse, other slabs go once nothing but the owner's ref is left.  A slab whose item ended up in
+// another list can't be touched from there beyond its refs, it goes with its last ref.
+static void sypha_list_slot_release(struct _sypha_list * list, struct _sypha_list_item * list_item) {
+    struct _sypha_list_slab * slab = sypha_list_item_slab(list_item);
+
+    if (__atomic_load_n(&slab->owner, __ATOMIC_ACQUIRE) != list) {
+        if (__atomic_sub_fetch(&slab->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+            sypha_free(&list->allocator, slab);
+        }
+    } else if (list->slot_sz && slab->slot_sz == list->slot_sz) {
+        list_item->next = list->free_items;
+        list->free_items = list_item;
+    } else if (__atomic_sub_fetch(&slab->refs, 1, __ATOMIC_ACQ_REL) == 1) {
+        sypha_list_slab_unlink(list, slab);
+        sypha_free(&list->allocator, slab);
+    }
+}
+
+// Gives an unlinked item back to the pool or the heap, handing ref data to the destructor
+static void sypha_list_item_release(struct _sypha_list * list, struct _sypha_list_item * list_item) {
+    if (list_item->flags & SYPHA_LIST_ITEM_REF) {
+        if (list->destructor) {
+            list->destructor(*((void **) list_item->data), list_item->data_sz, list->destructor_ctx);
+        }
+        list->ref_item_count--;
+    }
+
+    if (list_item->flags & SYPHA_LIST_ITEM_IN_SLAB) {
+        sypha_list_slot_release(list, list_item);
+    } else {
+        sypha_free(&list->allocator, list_item);
+        list->heap_item_count--;
+    }
+}
+
+// Allocates count items with copies of the elem_sz sized elements at base and links them to each
+// other in order, returns the first item or NULL on allocation error.  The items come in blocks of
+// up to SYPHA_LIST_BLOCK_MAX_SZ so a big batch is a handful of allocations the heap can serve from
+// memory it already has, rather than one huge mapping that faults in page by page.
+static struct _sypha_list_item * sypha_list_block_create(struct _sypha_list * list, void * base, size_t elem_sz, size_t count, struct _sypha_list_item ** last) {
+    struct _sypha_list_slab * block, * slabs = list->slabs;
+    struct _sypha_list_item * list_item, * first = NULL, * prev = NULL;
+    size_t slab_header_sz = SYPHA_LIST_SLAB_ALIGN(sizeof(struct _sypha_list_slab));
+    size_t slot_sz, flags, block_count;
+    unsigned char * slot;
+    unsigned char * elem = (unsigned char *) base;
+
+    // Pooled lists use their own slot size when the elements fit so deleted items recycle into
+    // the pool like any other
+    if (list->slot_sz && elem_sz <= list->slot_data_sz) {
+        slot_sz = list->slot_sz;
+        flags = SYPHA_LIST_ITEM_POOLED;
+    } else {
+        slot_sz = SYPHA_LIST_SLAB_ALIGN(SYPHA_LIST_SLOT_HEADER_SZ + sizeof(struct _sypha_list_item) + elem_sz);
+        flags = SYPHA_LIST_ITEM_BLOCK;
+    }
+
+    block_count = (SYPHA_LIST_BLOCK_MAX_SZ - slab_header_sz) / slot_sz;
+    if (!block_count) {
+        block_count = 1;
+    }
+
+    while (count) {
+        if (block_count > count) {
+            block_count = count;
+        }
+        if (!(block = (struct _sypha_list_slab *) sypha_alloc(&list->allocator, slab_header_sz + slot_sz * block_count))) {
+            // Give back what this batch already took, the list itself hasn't been touched
+            while (list->slabs != slabs) {
+                block = list->slabs;
+                sypha_list_slab_unlink(list, block);
+                sypha_free(&list->allocator, block);
+            }
+            return NULL;
+        }
+        sypha_list_slab_link(list, block, slot_sz);
+        block->refs += block_count;
+
+        slot = ((unsigned char *) block) + slab_header_sz;
+        for (size_t i=0;i < block_count;i++) {
+            list_item = sypha_list_slot_item(block, slot);
+            list_item->prev = prev;
+            if (prev) {
+                prev->next = list_item;
+            } else {
+                first = list_item;
+            }
+            list_item->data_sz = elem_sz;
+            list_item->flags = flags;
+            memcpy(list_item->data, elem, elem_sz);
+
+            prev = list_item;
+            slot += slot_sz;
+            elem += elem_sz;
+        }
+        count -= block_count;
+    }
+    prev->next = NULL;
+
+    *last = prev;
+    return first;
+}
+
+// Gives an item back like release but without handing ref data to the destructor, for items
+// whose data has moved on to another item
+static void sypha_list_item_discard(struct _sypha_list * list, struct _sypha_list_item * list_item) {
+    if (list_item->flags & SYPHA_LIST_ITEM_REF) {
+        list_item->flags &= ~((size_t) SYPHA_LIST_ITEM_REF);
+        list->ref_item_count--;
+    }
+    sypha_list_item_release(list, list_item);
+}
+
+// Whether memory from one allocator can be given back through the other
+static int sypha_list_same_allocator(const SYPHA_ALLOCATOR * a, const SYPHA_ALLOCATOR * b) {
+    return a->alloc == b->alloc && a->realloc == b->realloc && a->free == b->free && a->ctx == b->ctx;
+}
+
+// Links the chain first..last of count items into the list after the item after, NULL for the front
+static void sypha_list_link_chain(struct _sypha_list * list, struct _sypha_list_item * after, struct _sypha_list_item * first, struct _sypha_list_item * last, size_t count) {
+    struct _sypha_list_item * before = (after) ? after->next : list->first;
+
+    first->prev = after;
+    last->next = before;
+    if (after) {
+        after->next = first;
+    } else {
+        list->first = first;
+    }
+    if (before) {
+        before->prev = last;
+    } else {
+        list->last = last;
+    }
+    list->count += count;
+    sypha_list_touch(list);
+}
+
+// Moves the items first..last out of src and into dst after the item after (NULL for the front).
+// When both lists share an allocator every item is relinked as is, slab items keeping their slab
+// alive through its refs.  Otherwise dst gets a copy of each of them.  Returns 0 if moved, < 0 on
+// allocation error with both lists unchanged.
+static int sypha_list_move_range(struct _sypha_list * dst, struct _sypha_list_item * after, struct _sypha_list * src, struct _sypha_list_item * first, struct _sypha_list_item * last, size_t count) {
+    struct _sypha_list_item * list_item, * list_item_next, * copy, * copies = NULL, * copies_last = NULL;
+    int same_allocator = sypha_list_same_allocator(&dst->allocator, &src->allocator);
+    size_t stop = 0;
+
+    // Make all the copies up front so running out of memory leaves everything as it was
+    for (list_item = first; !same_allocator && !stop; list_item = list_item->next) {
+        stop = (list_item == last);
+        if (list_item->flags & SYPHA_LIST_ITEM_REF) {
+            copy = sypha_list_item_create(dst, *((void **) list_item->data), list_item->data_sz, 1);
+        } else {
+            copy = sypha_list_item_create(dst, list_item->data, list_item->data_sz, 0);
+        }
+        if (!copy) {
+            while ((copy = copies)) {
+                copies = copy->next;
+                sypha_list_item_discard(dst, copy);
+            }
+            return -1;
+        }
+        copy->prev = copies_last;
+        copy->next = NULL;
+        if (copies_last) {
+            copies_last->next = copy;
+        } else {
+            copies = copy;
+        }
+        copies_last = copy;
+    }
+
+    // Unlink the range from src
+    if (first->prev) {
+        first->prev->next = last->next;
+    } else {
+        src->first = last->next;
+    }
+    if (last->next) {
+        last->next->prev = first->prev;
+    } else {
+        src->last = first->prev;
+    }
+    src->count -= count;
+    sypha_list_touch(src);
+    last->next = NULL;
+
+    if (!same_allocator) {
+        // The originals go, their ref data lives on in the copies
+        for (list_item = first; list_item; list_item = list_item_next) {
+            list_item_next = list_item->next;
+            sypha_list_item_discard(src, list_item);
+        }
+        sypha_list_link_chain(dst, after, copies, copies_last, count);
+        return 0;
+    }
 
-struct _sypha_list_iterator {
+    // Hand the bookkeeping over with the items
+    for (list_item = first; list_item; list_item = list_item->next) {
+        if (list_item->flags & SYPHA_LIST_ITEM_IN_SLAB) {
+            src->shared_slabs = 1;
+            dst->shared_slabs = 1;
+        } else {
+            src->heap_item_count--;
+            dst->heap_item_count++;
+        }
+        if (list_item->flags & SYPHA_LIST_ITEM_REF) {
+            src->ref_item_count--;
+            dst->ref_item_count++;
+        }
+    }
+
+    sypha_list_link_chain(dst, after, first, last, count);
+    return 0;
+}
+
+SYPHA_LIST sypha_list_create() {
+    return sypha_list_create_with_allocator(NULL);
+}
+
+SYPHA_LIST sypha_list_create_with_allocator(const SYPHA_ALLOCATOR * allocator) {
     struct _sypha_list * list;
-    struct _sypha_list_item * curr;
-    unsigned int forward;
-    unsigned int is_pristine;
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(list = (struct _sypha_list *) sypha_alloc(allocator, sizeof(struct _sypha_list)))) {
+        return NULL;
+    }
+    memset(list, 0x0, sizeof(struct _sypha_list));
+    list->allocator = *allocator;
+    list->arena = sypha_arena_from_allocator(allocator);
+    sypha_arena_scratch_allocator(allocator, &list->scratch_allocator);
+    return (SYPHA_LIST) list;
+}
+
+SYPHA_LIST sypha_list_create_in_arena(SYPHA_ARENA arena) {
+    SYPHA_ALLOCATOR allocator;
+    struct _sypha_list * list;
+
+    if (arena) {
+        sypha_arena_get_allocator(arena, &allocator);
+        return sypha_list_create_with_allocator(&allocator);
+    }
+
+    // List owned arena, the list goes in first
+    if (!(arena = sypha_arena_create(0))) {
+        return NULL;
+    }
+    sypha_arena_get_allocator(arena, &allocator);
+    if (!(list = (struct _sypha_list *) sypha_list_create_with_allocator(&allocator))) {
+        sypha_arena_destroy(arena);
+        return NULL;
+    }
+    list->owns_arena = 1;
+    list->arena_mark = sypha_arena_mark(arena);
+    return (SYPHA_LIST) list;
+}
+
+SYPHA_LIST sypha_list_create_pooled(size_t node_payload_hint, size_t nodes_per_slab) {
+    return sypha_list_create_pooled_with_allocator(NULL, node_payload_hint, nodes_per_slab);
+}
+
+SYPHA_LIST sypha_list_create_pooled_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t node_payload_hint, size_t nodes_per_slab) {
+    struct _sypha_list * list;
+
+    if (nodes_per_slab == 0) {
+        return NULL;
+    }
+
+    if (!(list = (struct _sypha_list *) sypha_list_create_with_allocator(allocator))) {
+        return NULL;
+    }
+    list->slot_sz = SYPHA_LIST_SLAB_ALIGN(SYPHA_LIST_SLOT_HEADER_SZ + sizeof(struct _sypha_list_item) + node_payload_hint);
+    list->slot_data_sz = list->slot_sz - SYPHA_LIST_SLOT_HEADER_SZ - sizeof(struct _sypha_list_item);
+    list->slots_per_slab = nodes_per_slab;
+    return (SYPHA_LIST) list;
+}
+
+// Drops one ref on a slab the list no longer holds, freeing it with the last one
+static void sypha_list_slab_put(struct _sypha_list * list, struct _sypha_list_slab * slab) {
+    if (__atomic_sub_fetch(&slab->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        sypha_free(&list->allocator, slab);
+    }
+}
+
+// Lets go of every item and slab, leaving the list itself as is
+static void sypha_list_release_all(struct _sypha_list * _list) {
+    int free_items = _list->heap_item_count && !_list->arena;
+    struct _sypha_list_item * list_item, * list_item_next;
+    struct _sypha_list_slab * slab, * slab_next;
+
+    // Only items with their own heap block, data for the destructor or slabs shared with other
+    // lists need a walk, otherwise slabs go in one shot each
+    if (free_items || (_list->destructor && _list->ref_item_count) || _list->shared_slabs) {
+        for (list_item = _list->first; list_item; list_item = list_item_next) {
+            list_item_next = list_item->next;
+            if ((list_item->flags & SYPHA_LIST_ITEM_REF) && _list->destructor) {
+                _list->destructor(*((void **) list_item->data), list_item->data_sz, _list->destructor_ctx);
+            }
+            if (list_item->flags & SYPHA_LIST_ITEM_IN_SLAB) {
+                if (_list->shared_slabs) {
+                    sypha_list_slab_put(_list, sypha_list_item_slab(list_item));
+                }
+            } else if (free_items) {
+                sypha_free(&_list->allocator, list_item);
+            }
+        }
+    }
+
+    // Slabs with items out in other lists outlive the list, the last of those items frees them
+    if (_list->shared_slabs) {
+        for (list_item = _list->free_items; list_item; list_item = list_item->next) {
+            __atomic_sub_fetch(&sypha_list_item_slab(list_item)->refs, 1, __ATOMIC_RELAXED);
+        }
+        for (slab = _list->slabs; slab; slab = slab_next) {
+            slab_next = slab->next;
+            __atomic_store_n(&slab->owner, NULL, __ATOMIC_RELEASE);
+            sypha_list_slab_put(_list, slab);
+        }
+        return;
+    }
+
+    for (slab = _list->slabs; slab && !_list->arena; slab = slab_next) {
+        slab_next = slab->next;
+        sypha_free(&_list->allocator, slab);
+    }
+}
+
+void sypha_list_destroy(SYPHA_LIST list) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    if (!_list) {
+        return;
+    }
+
+    sypha_list_release_all(_list);
+
+    // An owned arena takes the list with it
+    if (_list->owns_arena) {
+        sypha_arena_destroy(_list->arena);
+    } else {
+        sypha_free(&_list->allocator, _list);
+    }
+}
+
+int sypha_list_clear(SYPHA_LIST list) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    long iterators = 0;
+
+    // Iterators would be left on released items
+    if (!__atomic_compare_exchange_n(&_list->iterators, &iterators, SYPHA_LIST_ITERATOR_WRITER, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return -1;
+    }
+
+    sypha_list_release_all(_list);
+    if (_list->owns_arena) {
+        sypha_arena_rewind(_list->arena, _list->arena_mark);
+    }
+
+    _list->first = NULL;
+    _list->last = NULL;
+    _list->count = 0;
+    _list->slabs = NULL;
+    _list->slabs_last = NULL;
+    _list->slab_next = NULL;
+    _list->slab_end = NULL;
+    _list->free_items = NULL;
+    _list->heap_item_count = 0;
+    _list->shared_slabs = 0;
+    _list->ref_item_count = 0;
+    sypha_list_touch(_list);
+
+    __atomic_store_n(&_list->iterators, 0, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void sypha_list_set_destructor(SYPHA_LIST list, SYPHA_LIST_DESTRUCTOR destructor, void * ctx) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    _list->destructor = destructor;
+    _list->destructor_ctx = ctx;
+}
+
+// Links an unlinked item in at the end of the list
+static void sypha_list_link_last(struct _sypha_list * _list, struct _sypha_list_item * list_item) {
+    // Set the new item as last, update old last to point to this
+    list_item->prev = _list->last;
+    list_item->next = NULL;
+    if (_list->last) {
+        _list->last->next = list_item;
+    }
+    _list->last = list_item;
+
+    // Is it also the first item?
+    if (!_list->first) {
+        _list->first = list_item;
+    }
+
+    _list->count++;
+    sypha_list_touch(_list);
+}
+
+// Links an unlinked item in at the front of the list
+static void sypha_list_link_first(struct _sypha_list * _list, struct _sypha_list_item * list_item) {
+    // Set the new item as first, have it point to old first
+    list_item->prev = NULL;
+    list_item->next = _list->first;
+    if (_list->first) {
+        _list->first->prev = list_item;
+    }
+    _list->first = list_item;
+
+    // Is it also the last item?
+    if (!_list->last) {
+        _list->last = list_item;
+    }
+
+    _list->count++;
+    sypha_list_touch(_list);
+}
+
+void sypha_list_append_item(SYPHA_LIST list, void * data, size_t data_sz) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_item * list_item;
+    if (!(list_item = sypha_list_item_create(_list, data, data_sz, 0))) {
+        return;
+    }
+    sypha_list_link_last(_list, list_item);
+}
+
+void sypha_list_prepend_item(SYPHA_LIST list, void * data, size_t data_sz) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_item * list_item;
+    if (!(list_item = sypha_list_item_create(_list, data, data_sz, 0))) {
+        return;
+    }
+    sypha_list_link_first(_list, list_item);
+}
+
+void sypha_list_append_ref(SYPHA_LIST list, void * data, size_t data_sz) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_item * list_item;
+    if (!(list_item = sypha_list_item_create(_list, data, data_sz, 1))) {
+        return;
+    }
+    sypha_list_link_last(_list, list_item);
+}
+
+void sypha_list_prepend_ref(SYPHA_LIST list, void * data, size_t data_sz) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_item * list_item;
+    if (!(list_item = sypha_list_item_create(_list, data, data_sz, 1))) {
+        return;
+    }
+    sypha_list_link_first(_list, list_item);
+}
+
+int sypha_list_append_many(SYPHA_LIST list, void * base, size_t elem_sz, size_t count) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_item * first, * last;
+
+    if (!count) {
+        return 0;
+    }
+    if (!(first = sypha_list_block_create(_list, base, elem_sz, count, &last))) {
+        return -1;
+    }
+
+    // Splice the whole chain in after the old last
+    first->prev = _list->last;
+    if (_list->last) {
+        _list->last->next = first;
+    } else {
+        _list->first = first;
+    }
+    _list->last = last;
+    _list->count += count;
+    sypha_list_touch(_list);
+
+    return 0;
+}
+
+int sypha_list_prepend_many(SYPHA_LIST list, void * base, size_t elem_sz, size_t count) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_item * first, * last;
+
+    if (!count) {
+        return 0;
+    }
+    if (!(first = sypha_list_block_create(_list, base, elem_sz, count, &last))) {
+        return -1;
+    }
+
+    // Splice the whole chain in before the old first
+    last->next = _list->first;
+    if (_list->first) {
+        _list->first->prev = last;
+    } else {
+        _list->last = last;
+    }
+    _list->first = first;
+    _list->count += count;
+    sypha_list_touch(_list);
+
+    return 0;
+}
+
+int sypha_list_concat(SYPHA_LIST dst, SYPHA_LIST src) {
+    struct _sypha_list * _dst = (struct _sypha_list *) dst;
+    struct _sypha_list * _src = (struct _sypha_list *) src;
+    struct _sypha_list_item * list_item, * free_last;
+    struct _sypha_list_slab * slab, * slab_next;
+
+    if (_dst == _src || __atomic_load_n(&_src->iterators, __ATOMIC_ACQUIRE) == SYPHA_LIST_ITERATOR_WRITER) {
+        return -1;
+    }
+    if (!_src->first) {
+        return 0;
+    }
+
+    // Items in different heaps have to be copied over one by one
+    if (!sypha_list_same_allocator(&_dst->allocator, &_src->allocator)) {
+        return sypha_list_move_range(_dst, _dst->last, _src, _src->first, _src->last, _src->count);
+    }
+
+    // Otherwise the items move as is and dst takes over src's slabs.  Free slots of the same size
+    // go on dst's free list, others can't be recycled by dst so give up their refs.
+    if (_src->free_items && _src->slot_sz == _dst->slot_sz) {
+        for (free_last = _src->free_items; free_last->next; free_last = free_last->next);
+        free_last->next = _dst->free_items;
+        _dst->free_items = _src->free_items;
+    } else {
+        for (list_item = _src->free_items; list_item; list_item = list_item->next) {
+            __atomic_sub_fetch(&sypha_list_item_slab(list_item)->refs, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    // Slabs down to the owner's ref have nothing left in them, those go now rather than with dst
+    for (slab = _src->slabs; slab; slab = slab_next) {
+        slab_next = slab->next;
+        if (__atomic_load_n(&slab->refs, __ATOMIC_ACQUIRE) == 1) {
+            sypha_list_slab_unlink(_src, slab);
+            sypha_free(&_src->allocator, slab);
+        } else {
+            __atomic_store_n(&slab->owner, _dst, __ATOMIC_RELEASE);
+        }
+    }
+    if (_src->slabs) {
+        _src->slabs_last->next = _dst->slabs;
+        if (_dst->slabs) {
+            _dst->slabs->prev = _src->slabs_last;
+        } else {
+            _dst->slabs_last = _src->slabs_last;
+        }
+        _dst->slabs = _src->slabs;
+    }
+
+    sypha_list_link_chain(_dst, _dst->last, _src->first, _src->last, _src->count);
+    _dst->heap_item_count += _src->heap_item_count;
+    _dst->ref_item_count += _src->ref_item_count;
+    _dst->shared_slabs |= _src->shared_slabs;
+
+    // src keeps its settings but is back to empty
+    _src->first = NULL;
+    _src->last = NULL;
+    _src->count = 0;
+    _src->slabs = NULL;
+    _src->slabs_last = NULL;
+    _src->slab_next = NULL;
+    _src->slab_end = NULL;
+    _src->free_items = NULL;
+    _src->heap_item_count = 0;
+    _src->shared_slabs = 0;
+    _src->ref_item_count = 0;
+    sypha_list_touch(_src);
+
+    return 0;
+}
+
+// Registers a new iterator with the list, returns NULL if the list's iterators don't allow it or
+// on allocation error
+static SYPHA_LIST_ITERATOR sypha_list_iterator_create(struct _sypha_list * list, unsigned int forward, unsigned int read_only) {
+    struct _sypha_list_iterator * iterator;
+    long iterators = __atomic_load_n(&list->iterators, __ATOMIC_RELAXED);
+
+    // Readers share the list with each other, a mutating iterator has it to itself
+    do {
+        if (iterators == SYPHA_LIST_ITERATOR_WRITER || (!read_only && iterators)) {
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&list->iterators, &iterators, (read_only) ? iterators + 1 : SYPHA_LIST_ITERATOR_WRITER,
+        0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    if (!(iterator = (struct _sypha_list_iterator *) sypha_alloc(&list->scratch_allocator, sizeof(struct _sypha_list_iterator)))) {
+        if (read_only) {
+            __atomic_sub_fetch(&list->iterators, 1, __ATOMIC_RELEASE);
+        } else {
+            __atomic_store_n(&list->iterators, 0, __ATOMIC_RELEASE);
+        }
+        return NULL;
+    }
+
+    iterator->list = list;
+    iterator->version = __atomic_load_n(&list->version, __ATOMIC_ACQUIRE);
+    iterator->curr = (forward) ? list->first : list->last;
+    iterator->forward = forward;
+    iterator->is_pristine = 1;
+    iterator->read_only = read_only;
+
+    return (SYPHA_LIST_ITERATOR) iterator;
+}
+
+// Comparator and its context, threaded through the sort
+struct _sypha_list_sort_ctx {
+    SYPHA_LIST_COMPARATOR cmp;
+    void * ctx;
 };
 
-SYPHA_LIST sypha_list_create() {
-    struct _sypha_list * list;
-    if (!(list = (struct _sypha_list *) malloc(sizeof(struct _sypha_list)))) {
-        return NULL;
+static inline int sypha_list_sort_cmp(const struct _sypha_list_sort_ctx * sort_ctx, struct _sypha_list_item * a, struct _sypha_list_item * b) {
+    return sort_ctx->cmp(SYPHA_LIST_ITEM_DATA(a), a->data_sz, SYPHA_LIST_ITEM_DATA(b), b->data_sz, sort_ctx->ctx);
+}
+
+// Merges two sorted NULL terminated next chains, a's items come first on ties to keep it stable.
+// Only next links are kept up, prev gets fixed once the sort is done.
+static struct _sypha_list_item * sypha_list_sort_merge(const struct _sypha_list_sort_ctx * sort_ctx, struct _sypha_list_item * a, struct _sypha_list_item * b) {
+    struct _sypha_list_item * head = NULL;
+    struct _sypha_list_item ** tail = &head;
+
+    while (a && b) {
+        if (sypha_list_sort_cmp(sort_ctx, a, b) <= 0) {
+            *tail = a;
+            tail = &a->next;
+            a = a->next;
+            // The list is scattered through memory, start on the item after next while cmp runs
+            if (a) {
+                __builtin_prefetch(a->next);
+            }
+        } else {
+            *tail = b;
+            tail = &b->next;
+            b = b->next;
+            if (b) {
+                __builtin_prefetch(b->next);
+            }
+        }
+    }
+    *tail = (a) ? a : b;
+
+    return head;
+}
+
+// Natural bottom-up merge sort of a NULL terminated next chain.  The chain is cut into the
+// ascending runs already in it, and runs are merged like a binary counter: pending[i] holds a
+// merge of 2^i runs, so every item takes part in about log2(runs) merges and already sorted
+// input is a single pass of compares.
+static struct _sypha_list_item * sypha_list_sort_chain(const struct _sypha_list_sort_ctx * sort_ctx, struct _sypha_list_item * first) {
+    struct _sypha_list_item * pending[sizeof(size_t) * 8];
+    struct _sypha_list_item * run, * run_last, * result = NULL;
+    size_t i, levels = 0;
+
+    while (first) {
+        // Cut the next run
+        run = first;
+        run_last = first;
+        while (run_last->next && sypha_list_sort_cmp(sort_ctx, run_last, run_last->next) <= 0) {
+            run_last = run_last->next;
+        }
+        first = run_last->next;
+        run_last->next = NULL;
+
+        // Carry it up, pending runs all came before this one
+        for (i=0;i < levels && pending[i];i++) {
+            run = sypha_list_sort_merge(sort_ctx, pending[i], run);
+            pending[i] = NULL;
+        }
+        if (i == levels) {
+            levels++;
+        }
+        pending[i] = run;
+    }
+
+    // Higher levels hold earlier items
+    for (i=0;i < levels;i++) {
+        if (pending[i]) {
+            result = (result) ? sypha_list_sort_merge(sort_ctx, pending[i], result) : pending[i];
+        }
+    }
+
+    return result;
+}
+
+// Puts a sorted next chain back into the list, fixing up prev and last on the way
+static void sypha_list_sort_relink(struct _sypha_list * list, struct _sypha_list_item * first) {
+    struct _sypha_list_item * prev = NULL;
+
+    list->first = first;
+    for (; first; first = first->next) {
+        first->prev = prev;
+        prev = first;
+    }
+    list->last = prev;
+    sypha_list_touch(list);
+}
+
+int sypha_list_sort(SYPHA_LIST list, SYPHA_LIST_COMPARATOR cmp, void * ctx) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_sort_ctx sort_ctx = { cmp, ctx };
+
+    if (!cmp) {
+        return -1;
+    }
+    if (_list->count > 1) {
+        sypha_list_sort_relink(_list, sypha_list_sort_chain(&sort_ctx, _list->first));
+    }
+    return 0;
+}
+
+// A span of segments for the parallel sort, sorted and merged into segments[0]
+struct _sypha_list_sort_task {
+    const struct _sypha_list_sort_ctx * sort_ctx;
+    struct _sypha_list_item ** segments;
+    size_t segment_count;
+};
+
+// Sorts the right half of the segments on a new thread while this one does the left half, then
+// merges the two, so the merges run in parallel too all the way up the tree
+static void * sypha_list_sort_task(void * arg) {
+    struct _sypha_list_sort_task * task = (struct _sypha_list_sort_task *) arg;
+    struct _sypha_list_sort_task left, right;
+    pthread_t thread;
+    int threaded;
+
+    if (task->segment_count == 1) {
+        task->segments[0] = sypha_list_sort_chain(task->sort_ctx, task->segments[0]);
+        return NULL;
+    }
+
+    left.sort_ctx = task->sort_ctx;
+    left.segments = task->segments;
+    left.segment_count = task->segment_count / 2;
+    right.sort_ctx = task->sort_ctx;
+    right.segments = task->segments + left.segment_count;
+    right.segment_count = task->segment_count - left.segment_count;
+
+    // No thread to be had, just do it here
+    threaded = (pthread_create(&thread, NULL, sypha_list_sort_task, &right) == 0);
+    if (!threaded) {
+        sypha_list_sort_task(&right);
+    }
+    sypha_list_sort_task(&left);
+    if (threaded) {
+        pthread_join(thread, NULL);
+    }
+
+    task->segments[0] = sypha_list_sort_merge(task->sort_ctx, left.segments[0], right.segments[0]);
+    return NULL;
+}
+
+int sypha_list_sort_parallel(SYPHA_LIST list, SYPHA_LIST_COMPARATOR cmp, void * ctx, size_t nthreads) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_sort_ctx sort_ctx = { cmp, ctx };
+    struct _sypha_list_item * segments[SYPHA_LIST_SORT_MAX_THREADS];
+    struct _sypha_list_item * list_item;
+    struct _sypha_list_sort_task task;
+    size_t segment_sz;
+
+    if (!cmp) {
+        return -1;
+    }
+
+    if (!nthreads) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (online > 0) ? (size_t) online : 1;
+    }
+    if (nthreads > SYPHA_LIST_SORT_MAX_THREADS) {
+        nthreads = SYPHA_LIST_SORT_MAX_THREADS;
+    }
+    if (nthreads > _list->count / SYPHA_LIST_SORT_MIN_PER_THREAD) {
+        nthreads = _list->count / SYPHA_LIST_SORT_MIN_PER_THREAD;
+    }
+    if (nthreads < 2) {
+        return sypha_list_sort(list, cmp, ctx);
+    }
+
+    // Cut the list into nthreads even segments, the last one takes the remainder
+    segment_sz = _list->count / nthreads;
+    list_item = _list->first;
+    for (size_t i=0;i < nthreads;i++) {
+        segments[i] = list_item;
+        if (i + 1 < nthreads) {
+            for (size_t j=1;j < segment_sz;j++) {
+                list_item = list_item->next;
+            }
+            struct _sypha_list_item * segment_last = list_item;
+            list_item = list_item->next;
+            segment_last->next = NULL;
+        }
+    }
+
+    task.sort_ctx = &sort_ctx;
+    task.segments = segments;
+    task.segment_count = nthreads;
+    sypha_list_sort_task(&task);
+
+    sypha_list_sort_relink(_list, segments[0]);
+    return 0;
+}
+
+// What a parallel algorithm does with each item
+struct _sypha_list_parallel_op {
+    SYPHA_LIST_VISITOR visit;
+    SYPHA_LIST_PREDICATE keep;
+    SYPHA_LIST_REDUCER reduce;
+    void * ctx;
+};
+
+// A run of items handed to one pool task, plus what the task made of it
+struct _sypha_list_segment {
+    struct _sypha_list_item * first;
+    size_t count;
+    const struct _sypha_list_parallel_op * op;
+
+    // Reduce: the segment's own accumulator
+    void * acc;
+
+    // Filter: kept items relinked among themselves, dropped ones chained through next
+    struct _sypha_list_item * kept_first;
+    struct _sypha_list_item * kept_last;
+    struct _sypha_list_item * dropped;
+    size_t kept;
+};
+
+// Cuts the list into balanced segments in one pass, returns the number of segments
+static size_t sypha_list_partition(struct _sypha_list * list, SYPHA_POOL pool, const struct _sypha_list_parallel_op * op, struct _sypha_list_segment * segments) {
+    struct _sypha_list_item * list_item = list->first;
+    size_t segment_count = 1, segment_sz, remainder;
+
+    if (pool) {
+        segment_count = sypha_pool_thread_count(pool) * SYPHA_LIST_PARALLEL_SEGMENTS_PER_THREAD;
+    }
+    if (segment_count > SYPHA_LIST_PARALLEL_MAX_SEGMENTS) {
+        segment_count = SYPHA_LIST_PARALLEL_MAX_SEGMENTS;
+    }
+    if (segment_count > list->count / SYPHA_LIST_PARALLEL_MIN_SEGMENT) {
+        segment_count = list->count / SYPHA_LIST_PARALLEL_MIN_SEGMENT;
+    }
+    if (!segment_count) {
+        segment_count = 1;
+    }
+
+    // Spread the remainder over the first segments
+    segment_sz = list->count / segment_count;
+    remainder = list->count % segment_count;
+    for (size_t i=0;i < segment_count;i++) {
+        memset(&segments[i], 0x0, sizeof(struct _sypha_list_segment));
+        segments[i].first = list_item;
+        segments[i].count = segment_sz + ((i < remainder) ? 1 : 0);
+        segments[i].op = op;
+        for (size_t j=0;j < segments[i].count;j++) {
+            list_item = list_item->next;
+        }
+    }
+
+    return segment_count;
+}
+
+// Runs task over the segments on the pool, or right here without one
+static int sypha_list_run_segments(SYPHA_POOL pool, SYPHA_POOL_TASK task, struct _sypha_list_segment * segments, size_t segment_count) {
+    if (pool && segment_count > 1) {
+        return sypha_pool_run(pool, task, segments, sizeof(struct _sypha_list_segment), segment_count);
+    }
+    for (size_t i=0;i < segment_count;i++) {
+        task(&segments[i]);
+    }
+    return 0;
+}
+
+static void sypha_list_for_each_task(void * arg) {
+    struct _sypha_list_segment * segment = (struct _sypha_list_segment *) arg;
+    struct _sypha_list_item * list_item = segment->first;
+
+    for (size_t i=0;i < segment->count;i++) {
+        segment->op->visit(SYPHA_LIST_ITEM_DATA(list_item), list_item->data_sz, segment->op->ctx);
+        list_item = list_item->next;
     }
-    memset(list, 0x0, sizeof(struct _sypha_list));
-    return (SYPHA_LIST) list;
 }
 
-void sypha_list_destroy(SYPHA_LIST list) {
+int sypha_list_parallel_for_each(SYPHA_LIST list, SYPHA_POOL pool, SYPHA_LIST_VISITOR visit, void * ctx) {
     struct _sypha_list * _list = (struct _sypha_list *) list;
-    if (!_list) {
-        return;
+    struct _sypha_list_segment segments[SYPHA_LIST_PARALLEL_MAX_SEGMENTS];
+    struct _sypha_list_parallel_op op = { visit, NULL, NULL, ctx };
+    size_t segment_count;
+
+    if (!visit) {
+        return -1;
+    }
+    if (!_list->count) {
+        return 0;
     }
 
-    struct _sypha_list_item * list_item_next = NULL;
-    struct _sypha_list_item * list_item = _list->first;
-    while (list_item) {
-        list_item_next = list_item->next;
-        
-        free(list_item->data);
-        free(list_item);
+    segment_count = sypha_list_partition(_list, pool, &op, segments);
+    return sypha_list_run_segments(pool, sypha_list_for_each_task, segments, segment_count);
+}
+
+// Only touches the links of the segment's own items, so segments can be filtered side by side
+static void sypha_list_filter_task(void * arg) {
+    struct _sypha_list_segment * segment = (struct _sypha_list_segment *) arg;
+    struct _sypha_list_item * list_item = segment->first, * list_item_next;
+    struct _sypha_list_item ** dropped_tail = &segment->dropped;
 
+    for (size_t i=0;i < segment->count;i++) {
+        list_item_next = list_item->next;
+        if (segment->op->keep(SYPHA_LIST_ITEM_DATA(list_item), list_item->data_sz, segment->op->ctx)) {
+            list_item->prev = segment->kept_last;
+            if (segment->kept_last) {
+                segment->kept_last->next = list_item;
+            } else {
+                segment->kept_first = list_item;
+            }
+            segment->kept_last = list_item;
+            segment->kept++;
+        } else {
+            *dropped_tail = list_item;
+            dropped_tail = &list_item->next;
+        }
         list_item = list_item_next;
     }
+    *dropped_tail = NULL;
 }
 
-void sypha_list_append_item(SYPHA_LIST list, void * data, size_t data_sz) {
+int sypha_list_parallel_filter(SYPHA_LIST list, SYPHA_POOL pool, SYPHA_LIST_PREDICATE keep, void * ctx) {
     struct _sypha_list * _list = (struct _sypha_list *) list;
-    struct _sypha_list_item * list_item;
-    if (!(list_item = (struct _sypha_list_item *) malloc(sizeof(struct _sypha_list_item)))) {
-        return;
+    struct _sypha_list_segment segments[SYPHA_LIST_PARALLEL_MAX_SEGMENTS];
+    struct _sypha_list_parallel_op op = { NULL, keep, NULL, ctx };
+    struct _sypha_list_item * list_item, * list_item_next, * last = NULL;
+    size_t segment_count;
+    long iterators = 0;
+
+    if (!keep) {
+        return -1;
+    }
+    if (!_list->count) {
+        return 0;
     }
 
-    if (!(list_item->data = (void *) malloc(sizeof(data_sz)))) {
-        free(list_item);
-        return;
+    // Items are about to go away, so like a changing iterator this needs the list to itself
+    if (!__atomic_compare_exchange_n(&_list->iterators, &iterators, SYPHA_LIST_ITERATOR_WRITER, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return -1;
     }
-    memcpy(list_item->data, data, data_sz);
-    list_item->data_sz = data_sz;
 
-    // Set the new item as last, update old last to point to this
-    list_item->prev = _list->last;
-    list_item->next = NULL;
-    if (_list->last) {
-        _list->last->next = list_item;
+    segment_count = sypha_list_partition(_list, pool, &op, segments);
+    if (sypha_list_run_segments(pool, sypha_list_filter_task, segments, segment_count) < 0) {
+        __atomic_store_n(&_list->iterators, 0, __ATOMIC_RELEASE);
+        return -1;
     }
-    _list->last = list_item;
 
-    // Is it also the first item?
-    if (!_list->first) {
-        _list->first = list_item;
+    // Stitch the kept runs together and let the dropped ones go
+    _list->first = NULL;
+    _list->count = 0;
+    for (size_t i=0;i < segment_count;i++) {
+        if (segments[i].kept_first) {
+            segments[i].kept_first->prev = last;
+            if (last) {
+                last->next = segments[i].kept_first;
+            } else {
+                _list->first = segments[i].kept_first;
+            }
+            last = segments[i].kept_last;
+            _list->count += segments[i].kept;
+        }
+        for (list_item = segments[i].dropped; list_item; list_item = list_item_next) {
+            list_item_next = list_item->next;
+            sypha_list_item_release(_list, list_item);
+        }
     }
+    if (last) {
+        last->next = NULL;
+    }
+    _list->last = last;
+    sypha_list_touch(_list);
 
-    _list->count++;
+    __atomic_store_n(&_list->iterators, 0, __ATOMIC_RELEASE);
+    return 0;
 }
 
-void sypha_list_prepend_item(SYPHA_LIST list, void * data, size_t data_sz) {
-    struct _sypha_list * _list = (struct _sypha_list *) list;
-    struct _sypha_list_item * list_item;
-    if (!(list_item = (struct _sypha_list_item *) malloc(sizeof(struct _sypha_list_item)))) {
-        return;
+static void sypha_list_reduce_task(void * arg) {
+    struct _sypha_list_segment * segment = (struct _sypha_list_segment *) arg;
+    struct _sypha_list_item * list_item = segment->first;
+
+    for (size_t i=0;i < segment->count;i++) {
+        segment->op->reduce(segment->acc, SYPHA_LIST_ITEM_DATA(list_item), list_item->data_sz, segment->op->ctx);
+        list_item = list_item->next;
     }
+}
 
-    if (!(list_item->data = (void *) malloc(sizeof(data_sz)))) {
-        free(list_item);
-        return;
+int sypha_list_parallel_reduce(SYPHA_LIST list, SYPHA_POOL pool, void * acc, const void * identity, size_t acc_sz, SYPHA_LIST_REDUCER reduce, SYPHA_LIST_COMBINER combine, void * ctx) {
+    struct _sypha_list * _list = (struct _sypha_list *) list;
+    struct _sypha_list_segment segments[SYPHA_LIST_PARALLEL_MAX_SEGMENTS];
+    struct _sypha_list_parallel_op op = { NULL, NULL, reduce, ctx };
+    unsigned char * partials;
+    size_t segment_count;
+    int rc;
+
+    if (!reduce || !combine || !identity) {
+        return -1;
+    }
+    if (!_list->count) {
+        return 0;
     }
-    memcpy(list_item->data, data, data_sz);
-    list_item->data_sz = data_sz;
 
-    // Set the new item as first, have it point to old first
-    list_item->prev = NULL;
-    list_item->next = _list->first;
-    if (_list->first) {
-        _list->first->prev = list_item;
+    // Every segment folds into its own accumulator, started off from identity
+    segment_count = sypha_list_partition(_list, pool, &op, segments);
+    if (!(partials = (unsigned char *) sypha_alloc(&_list->scratch_allocator, acc_sz * segment_count))) {
+        return -1;
+    }
+    for (size_t i=0;i < segment_count;i++) {
+        segments[i].acc = partials + i * acc_sz;
+        memcpy(segments[i].acc, identity, acc_sz);
     }
-    _list->first = list_item;
 
-    // Is it also the last item?
-    if (!_list->last) {
-        _list->last = list_item;
+    // Partials are combined in list order so the operation only has to be associative
+    if ((rc = sypha_list_run_segments(pool, sypha_list_reduce_task, segments, segment_count)) == 0) {
+        for (size_t i=0;i < segment_count;i++) {
+            combine(acc, segments[i].acc, ctx);
+        }
     }
 
-    _list->count++;
+    sypha_free(&_list->scratch_allocator, partials);
+    return rc;
 }
 
 SYPHA_LIST_ITERATOR sypha_list_get_iterator_front(SYPHA_LIST list) {
-    struct _sypha_list * _list = (struct _sypha_list *) list;
-    struct _sypha_list_iterator * iterator;
-    if (!(iterator = (struct _sypha_list_iterator *) malloc(sizeof(struct _sypha_list_iterator)))) {
-        return NULL;
-    }
-
-    iterator->list = _list;
-    iterator->curr = _list->first;
-    iterator->forward = 1;
-    iterator->is_pristine = 1;
-
-    return (SYPHA_LIST_ITERATOR) iterator;
+    return sypha_list_iterator_create((struct _sypha_list *) list, 1, 0);
 }
 
 SYPHA_LIST_ITERATOR sypha_list_get_iterator_back(SYPHA_LIST list) {
-    struct _sypha_list * _list = (struct _sypha_list *) list;
-    struct _sypha_list_iterator * iterator;
-    if (!(iterator = (struct _sypha_list_iterator *) malloc(sizeof(struct _sypha_list_iterator)))) {
-        return NULL;
-    }
+    return sypha_list_iterator_create((struct _sypha_list *) list, 0, 0);
+}
 
-    iterator->list = _list;
-    iterator->curr = _list->last;
-    iterator->forward = 0;
-    iterator->is_pristine = 1;
+SYPHA_LIST_ITERATOR sypha_list_get_read_iterator_front(SYPHA_LIST list) {
+    return sypha_list_iterator_create((struct _sypha_list *) list, 1, 1);
+}
 
-    return (SYPHA_LIST_ITERATOR) iterator;
+SYPHA_LIST_ITERATOR sypha_list_get_read_iterator_back(SYPHA_LIST list) {
+    return sypha_list_iterator_create((struct _sypha_list *) list, 0, 1);
 }
 
 void sypha_list_destroy_iterator(SYPHA_LIST_ITERATOR iterator) {
     struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
-    free(_iterator);
+    struct _sypha_list * _list;
+    if (!_iterator) {
+        return;
+    }
+
+    _list = _iterator->list;
+    if (_iterator->read_only) {
+        __atomic_sub_fetch(&_list->iterators, 1, __ATOMIC_RELEASE);
+    } else {
+        __atomic_store_n(&_list->iterators, 0, __ATOMIC_RELEASE);
+    }
+    sypha_free(&_list->scratch_allocator, _iterator);
 }
 
 void * sypha_list_iterator_get(SYPHA_LIST_ITERATOR iterator, size_t * data_sz) {
-    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
-    struct _sypha_list_item * curr = _iterator->curr;
-
-    // Iterator not started OR empty list
-    if (_iterator->is_pristine || !curr) {
-        return NULL;
-    }
+    return sypha_list_iterator_get_inline(iterator, data_sz);
+}
 
-    *data_sz = curr->data_sz;
-    return curr->data;
+unsigned int sypha_list_layout_version() {
+    return SYPHA_LIST_LAYOUT_VERSION;
 }
 
 int sypha_list_iterator_next(SYPHA_LIST_ITERATOR iterator) {
+    return sypha_list_iterator_next_inline(iterator);
+}
+
+size_t sypha_list_iterator_next_batch(SYPHA_LIST_ITERATOR iterator, void ** out_ptrs, size_t * out_sizes, size_t max) {
     struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
-    struct _sypha_list_item * curr = _iterator->curr;
+    struct _sypha_list_item * list_item = _iterator->curr;
     struct _sypha_list_item * next;
+    size_t count = 0;
 
-    // Empty list case
-    if (!curr) {
-        return -1;
+    // Empty list case, or list changed under a read iterator
+    if (!list_item || max == 0 || sypha_list_iterator_is_stale(_iterator)) {
+        return 0;
     }
 
-    // Advance the iterator to the next, which depends on the
-    // perspective of moving from front-to-back or back-to-front.
+    // From the initial state the current item is the first one out
     if (!_iterator->is_pristine) {
-        next = (_iterator->forward) ? curr->next : curr->prev;
-
-        // We hit the "end", return NULL and stay where we are
-        if (!next) {
-            return -1;
-        }
-
-        // Fully move
-        _iterator->curr = next;
-    } else {
-        // else we were in the initial state so don't move and clense that state
-        _iterator->is_pristine = 0;
+        list_item = (_iterator->forward) ? list_item->next : list_item->prev;
     }
 
-    return 0;
-}
-
-int sypha_list_iterator_previous(SYPHA_LIST_ITERATOR iterator) {
-    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
-    struct _sypha_list_item * curr = _iterator->curr;
-    struct _sypha_list_item * next;
+    while (list_item && count < max) {
+        // Get the next item on its way in while this one is copied out
+        next = (_iterator->forward) ? list_item->next : list_item->prev;
+        if (next) {
+            __builtin_prefetch(next);
+        }
 
-    // Empty list case
-    if (!curr) {
-        return -1;
-    }
+        out_ptrs[count] = SYPHA_LIST_ITEM_DATA(list_item);
+        if (out_sizes) {
+            out_sizes[count] = list_item->data_sz;
+        }
+        count++;
 
-    if (_iterator->is_pristine) {
-        // You can't move to the previous node from the initial state
-        return -1;
+        _iterator->curr = list_item;
+        list_item = next;
     }
 
-    // Advance the iterator to the previous, which depends on the
-    // perspective of moving from front-to-back or back-to-front.
-    next = (_iterator->forward) ? curr->prev : curr->next;
-
-    // We hit the "end", return NULL and stay where we are
-    if (!next) {
-        return -1;
+    if (count) {
+        _iterator->is_pristine = 0;
     }
 
-    // Fully move
-    _iterator->curr = next;
+    return count;
+}
 
-    return 0;
+int sypha_list_iterator_previous(SYPHA_LIST_ITERATOR iterator) {
+    return sypha_list_iterator_previous_inline(iterator);
 }
 
-int sypha_list_iterator_insert_after(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz) {
-    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+// Links an unlinked item in after the iterator's current item
+static void sypha_list_iterator_link_after(struct _sypha_list_iterator * _iterator, struct _sypha_list_item * list_item) {
     struct _sypha_list_item * curr = _iterator->curr;
     struct _sypha_list * _list = (struct _sypha_list *) _iterator->list;
 
     // You can add an item from initial state since it is suppose to be one behind it.  So allow this
     // and leave the initial state in tact so next() still has to be called.
 
-    struct _sypha_list_item * list_item;
-    if (!(list_item = (struct _sypha_list_item *) malloc(sizeof(struct _sypha_list_item)))) {
-        return -1;
-    }
-
-    if (!(list_item->data = (void *) malloc(sizeof(data_sz)))) {
-        free(list_item);
-        return -1;
-    }
-    memcpy(list_item->data, data, data_sz);
-    list_item->data_sz = data_sz;
-
     if (curr) {
         // If we haven't moved yet, this is sort of a prepend
         if (_iterator->is_pristine) {
@@ -312,33 +1353,14 @@ int sypha_list_iterator_insert_after(SYPHA_LIST_ITERATOR iterator, void * data,
     }
 
     _list->count++;
-
-    return 0;
+    sypha_list_touch(_list);
 }
 
-int sypha_list_iterator_insert_before(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz) {
-    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+// Links an unlinked item in before the iterator's current item, iterator can't be pristine
+static void sypha_list_iterator_link_before(struct _sypha_list_iterator * _iterator, struct _sypha_list_item * list_item) {
     struct _sypha_list_item * curr = _iterator->curr;
     struct _sypha_list * _list = (struct _sypha_list *) _iterator->list;
 
-    // Can't add anything from initial state.  Regardless of moving forward or backward, the iterator
-    // is intially positioned "before" a first item so adding BEFORE THAT doesn't make sense.
-    if (_iterator->is_pristine) {
-        return -1;
-    }
-
-    struct _sypha_list_item * list_item;
-    if (!(list_item = (struct _sypha_list_item *) malloc(sizeof(struct _sypha_list_item)))) {
-        return -1;
-    }
-
-    if (!(list_item->data = (void *) malloc(sizeof(data_sz)))) {
-        free(list_item);
-        return -1;
-    }
-    memcpy(list_item->data, data, data_sz);
-    list_item->data_sz = data_sz;
-
     if (curr) {
         if (_iterator->forward) {
             list_item->next = curr;
@@ -376,7 +1398,69 @@ int sypha_list_iterator_insert_before(SYPHA_LIST_ITERATOR iterator, void * data,
     }
 
     _list->count++;
+    sypha_list_touch(_list);
+}
+
+int sypha_list_iterator_insert_after(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list_item * list_item;
+
+    if (_iterator->read_only) {
+        return -1;
+    }
+
+    if (!(list_item = sypha_list_item_create(_iterator->list, data, data_sz, 0))) {
+        return -1;
+    }
+    sypha_list_iterator_link_after(_iterator, list_item);
+    return 0;
+}
+
+int sypha_list_iterator_insert_before(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list_item * list_item;
+
+    // Can't add anything from initial state.  Regardless of moving forward or backward, the iterator
+    // is intially positioned "before" a first item so adding BEFORE THAT doesn't make sense.
+    if (_iterator->is_pristine || _iterator->read_only) {
+        return -1;
+    }
+
+    if (!(list_item = sypha_list_item_create(_iterator->list, data, data_sz, 0))) {
+        return -1;
+    }
+    sypha_list_iterator_link_before(_iterator, list_item);
+    return 0;
+}
+
+int sypha_list_iterator_insert_after_ref(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list_item * list_item;
+
+    if (_iterator->read_only) {
+        return -1;
+    }
+
+    if (!(list_item = sypha_list_item_create(_iterator->list, data, data_sz, 1))) {
+        return -1;
+    }
+    sypha_list_iterator_link_after(_iterator, list_item);
+    return 0;
+}
+
+int sypha_list_iterator_insert_before_ref(SYPHA_LIST_ITERATOR iterator, void * data, size_t data_sz) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list_item * list_item;
+
+    // Same rule as sypha_list_iterator_insert_before
+    if (_iterator->is_pristine || _iterator->read_only) {
+        return -1;
+    }
 
+    if (!(list_item = sypha_list_item_create(_iterator->list, data, data_sz, 1))) {
+        return -1;
+    }
+    sypha_list_iterator_link_before(_iterator, list_item);
     return 0;
 }
 
@@ -386,8 +1470,8 @@ int sypha_list_iterator_delete_current(SYPHA_LIST_ITERATOR iterator) {
     struct _sypha_list * _list = (struct _sypha_list *) _iterator->list;
     struct _sypha_list_item * curr_prev, * curr_next;
 
-    // Can't remove anything from initial state, or an empty list
-    if (_iterator->is_pristine || !curr) {
+    // Can't remove anything from initial state, or an empty list, or through a read iterator
+    if (_iterator->is_pristine || !curr || _iterator->read_only) {
         return -1;
     }
 
@@ -405,23 +1489,139 @@ int sypha_list_iterator_delete_current(SYPHA_LIST_ITERATOR iterator) {
     // Was the curr item either the first or last one?
     if (_list->first == curr) {
         _list->first = curr_next;
-        _iterator->curr = curr_next;
-        _iterator->is_pristine = 1;
     }
     if (_list->last == curr) {
         _list->last = curr_prev;
-        _iterator->curr = curr_prev;
+    }
+
+    // Reposition to the "previous" item from the iterator's perspective.  If there isn't one
+    // then we deleted the head of the iteration so go back to the initial state in front of
+    // the new head.
+    if ((_iterator->curr = (_iterator->forward) ? curr_prev : curr_next) == NULL) {
+        _iterator->curr = (_iterator->forward) ? curr_next : curr_prev;
+        _iterator->is_pristine = 1;
     }
 
     // free the item
-    free(curr->data);
-    free(curr);
+    sypha_list_item_release(_list, curr);
 
     _list->count--;
+    sypha_list_touch(_list);
+
+    return 0;
+}
+
+int sypha_list_splice(SYPHA_LIST_ITERATOR dst_iterator, SYPHA_LIST src, SYPHA_LIST_ITERATOR src_begin_iterator, SYPHA_LIST_ITERATOR src_end_iterator) {
+    struct _sypha_list_iterator * _dst_iterator = (struct _sypha_list_iterator *) dst_iterator;
+    struct _sypha_list_iterator * _begin = (struct _sypha_list_iterator *) src_begin_iterator;
+    struct _sypha_list_iterator * _end = (struct _sypha_list_iterator *) src_end_iterator;
+    struct _sypha_list * _dst = _dst_iterator->list;
+    struct _sypha_list * _src = (struct _sypha_list *) src;
+    struct _sypha_list_item * first, * last, * list_item, * after;
+    size_t count = 1;
+
+    if (_dst == _src || _dst_iterator->read_only) {
+        return -1;
+    }
+    if (__atomic_load_n(&_src->iterators, __ATOMIC_ACQUIRE) == SYPHA_LIST_ITERATOR_WRITER) {
+        return -1;
+    }
+
+    // The range runs between the items the src iterators are on, missing ones meaning the ends
+    if (_begin) {
+        if (_begin->list != _src || _begin->is_pristine || !_begin->curr || sypha_list_iterator_is_stale(_begin)) {
+            return -1;
+        }
+        first = _begin->curr;
+    } else {
+        first = _src->first;
+    }
+    if (_end) {
+        if (_end->list != _src || _end->is_pristine || !_end->curr || sypha_list_iterator_is_stale(_end)) {
+            return -1;
+        }
+        last = _end->curr;
+    } else {
+        last = _src->last;
+    }
+    if (!first) {
+        return 0;
+    }
+
+    // Make sure last really comes at or after first
+    for (list_item = first; list_item != last; list_item = list_item->next) {
+        if (!list_item->next) {
+            return -1;
+        }
+        count++;
+    }
+
+    // Land the range where an insert_after through dst_iterator would put an item
+    if (!_dst_iterator->curr) {
+        after = NULL;
+    } else if (_dst_iterator->is_pristine) {
+        after = (_dst_iterator->forward) ? NULL : _dst->last;
+    } else {
+        after = (_dst_iterator->forward) ? _dst_iterator->curr : _dst_iterator->curr->prev;
+    }
+
+    if (sypha_list_move_range(_dst, after, _src, first, last, count) < 0) {
+        return -1;
+    }
+
+    // A pristine iterator stays one behind the first item in its direction
+    if (_dst_iterator->is_pristine) {
+        _dst_iterator->curr = (_dst_iterator->forward) ? _dst->first : _dst->last;
+    }
 
     return 0;
 }
 
+SYPHA_LIST sypha_list_split_at(SYPHA_LIST_ITERATOR iterator) {
+    struct _sypha_list_iterator * _iterator = (struct _sypha_list_iterator *) iterator;
+    struct _sypha_list * _list = _iterator->list;
+    struct _sypha_list * split;
+    struct _sypha_list_item * list_item;
+    const SYPHA_ALLOCATOR * allocator;
+    size_t count = 0;
+
+    if (_iterator->is_pristine || !_iterator->curr || _iterator->read_only) {
+        return NULL;
+    }
+
+    // New list is set up just like this one, except that a list's own arena goes when it does so
+    // the split off items are copied out to the default allocator
+    allocator = (_list->owns_arena) ? NULL : &_list->allocator;
+    if (_list->slot_sz) {
+        split = (struct _sypha_list *) sypha_list_create_pooled_with_allocator(allocator, _list->slot_data_sz, _list->slots_per_slab);
+    } else {
+        split = (struct _sypha_list *) sypha_list_create_with_allocator(allocator);
+    }
+    if (!split) {
+        return NULL;
+    }
+    split->destructor = _list->destructor;
+    split->destructor_ctx = _list->destructor_ctx;
+
+    for (list_item = _iterator->curr; list_item; list_item = list_item->next) {
+        count++;
+    }
+    if (sypha_list_move_range(split, NULL, _list, _iterator->curr, _list->last, count) < 0) {
+        sypha_list_destroy(split);
+        return NULL;
+    }
+
+    // Iterator carries on from what is now the end of the list
+    if (_list->last) {
+        _iterator->curr = _list->last;
+    } else {
+        _iterator->curr = NULL;
+        _iterator->is_pristine = 1;
+    }
+
+    return (SYPHA_LIST) split;
+}
+
 #if defined(__cplusplus)
 }
 #endif // __cplusplus
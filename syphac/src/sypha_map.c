@@ -0,0 +1,495 @@
+/* sypha_map.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif // __SSE2__
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_map.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+// Control bytes looked at in one go
+#define SYPHA_MAP_GROUP_WIDTH       16
+
+// Smallest table, has to be at least a group wide
+#define SYPHA_MAP_MIN_CAPACITY      16
+
+// Control byte values, full slots hold the low 7 bits of their hash so only the empty and
+// deleted markers have the top bit set
+#define SYPHA_MAP_CTRL_EMPTY        ((int8_t) -128)
+#define SYPHA_MAP_CTRL_DELETED      ((int8_t) -2)
+#define SYPHA_MAP_CTRL_IS_FULL(c)   ((c) >= 0)
+
+// Tables are filled to 7/8 at most
+#define SYPHA_MAP_MAX_LOAD(cap)     ((cap) - (cap) / 8)
+
+#define SYPHA_MAP_ALIGN(sz)         (((sz) + 7) & ~((size_t) 7))
+
+// Entries keep their hash so growing never rehashes a key.  The key comes first, the value
+// follows at the next 8 byte boundary.
+struct _sypha_map_entry {
+    uint64_t hash;
+    size_t key_sz;
+    size_t value_sz;
+    unsigned char data[];
+};
+
+#define SYPHA_MAP_ENTRY_VALUE(entry)    ((entry)->data + SYPHA_MAP_ALIGN((entry)->key_sz))
+
+struct _sypha_map {
+    size_t count;
+    size_t capacity;        // power of 2, 0 until the first put
+    size_t growth_left;     // empty slots that can still be filled before the table has to grow
+
+    // capacity + SYPHA_MAP_GROUP_WIDTH control bytes, the tail mirrors the first group so a group
+    // can be read from any slot without wrapping.  Shares its allocation with slots.
+    int8_t * ctrl;
+    struct _sypha_map_entry ** slots;
+
+    SYPHA_ALLOCATOR allocator;
+    // Iterators come from here, see sypha_arena_scratch_allocator
+    SYPHA_ALLOCATOR scratch_allocator;
+};
+
+struct _sypha_map_iterator {
+    struct _sypha_map * map;
+    size_t index;
+    unsigned int is_pristine;
+    unsigned int has_current;
+};
+
+// Group matching, a bit per control byte
+#if defined(__SSE2__)
+static inline unsigned int sypha_map_group_match(const int8_t * ctrl, int8_t value) {
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value)));
+}
+
+static inline unsigned int sypha_map_group_match_free(const int8_t * ctrl) {
+    // Empty and deleted are the only ones with the top bit set
+    return (unsigned int) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+}
+#else
+static inline unsigned int sypha_map_group_match(const int8_t * ctrl, int8_t value) {
+    unsigned int mask = 0;
+    for (int i=0;i < SYPHA_MAP_GROUP_WIDTH;i++) {
+        mask |= (unsigned int) (ctrl[i] == value) << i;
+    }
+    return mask;
+}
+
+static inline unsigned int sypha_map_group_match_free(const int8_t * ctrl) {
+    unsigned int mask = 0;
+    for (int i=0;i < SYPHA_MAP_GROUP_WIDTH;i++) {
+        mask |= (unsigned int) (!SYPHA_MAP_CTRL_IS_FULL(ctrl[i])) << i;
+    }
+    return mask;
+}
+#endif // __SSE2__
+
+static inline uint64_t sypha_map_mix(uint64_t a, uint64_t b) {
+    __uint128_t product = ((__uint128_t) a) * b;
+    return ((uint64_t) product) ^ ((uint64_t) (product >> 64));
+}
+
+// 16 bytes per multiply, the length goes in up front so keys that differ only in trailing zeros
+// don't collide
+static uint64_t sypha_map_hash(const void * key, size_t key_sz) {
+    const unsigned char * bytes = (const unsigned char *) key;
+    unsigned char tail[16];
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ sypha_map_mix(key_sz, 0xa0761d6478bd642fULL);
+    uint64_t a, b;
+
+    while (key_sz >= 16) {
+        memcpy(&a, bytes, sizeof(a));
+        memcpy(&b, bytes + 8, sizeof(b));
+        hash = sypha_map_mix(a ^ 0xe7037ed1a0b428dbULL, b ^ hash);
+        bytes += 16;
+        key_sz -= 16;
+    }
+
+    memset(tail, 0x0, sizeof(tail));
+    memcpy(tail, bytes, key_sz);
+    memcpy(&a, tail, sizeof(a));
+    memcpy(&b, tail + 8, sizeof(b));
+    hash = sypha_map_mix(a ^ 0xe7037ed1a0b428dbULL, b ^ hash);
+
+    return sypha_map_mix(hash, 0x8ebc6af09c88c6e3ULL);
+}
+
+#define SYPHA_MAP_H1(hash)  ((size_t) ((hash) >> 7))
+#define SYPHA_MAP_H2(hash)  ((int8_t) ((hash) & 0x7f))
+
+// Sets slot i's control byte and its mirror past the end
+static inline void sypha_map_set_ctrl(struct _sypha_map * map, size_t i, int8_t value) {
+    map->ctrl[i] = value;
+    map->ctrl[((i - SYPHA_MAP_GROUP_WIDTH) & (map->capacity - 1)) + SYPHA_MAP_GROUP_WIDTH] = value;
+}
+
+// Slot holding key, or capacity if it isn't there.  Groups are probed at triangular offsets
+// which visits every group of a power of 2 table.
+static size_t sypha_map_find(struct _sypha_map * map, const void * key, size_t key_sz, uint64_t hash) {
+    size_t mask = map->capacity - 1;
+    size_t pos = SYPHA_MAP_H1(hash) & mask;
+    size_t stride = 0;
+    size_t i;
+    unsigned int match;
+    struct _sypha_map_entry * entry;
+
+    if (!map->capacity) {
+        return 0;
+    }
+
+    while (1) {
+        for (match = sypha_map_group_match(map->ctrl + pos, SYPHA_MAP_H2(hash)); match; match &= match - 1) {
+            i = (pos + __builtin_ctz(match)) & mask;
+            entry = map->slots[i];
+            if (entry->hash == hash && entry->key_sz == key_sz && memcmp(entry->data, key, key_sz) == 0) {
+                return i;
+            }
+        }
+
+        // An empty slot ends the probe, the key would have gone there
+        if (sypha_map_group_match(map->ctrl + pos, SYPHA_MAP_CTRL_EMPTY)) {
+            return map->capacity;
+        }
+
+        stride += SYPHA_MAP_GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+// First empty or deleted slot along hash's probe sequence, the table is never full so there is one
+static size_t sypha_map_find_free(struct _sypha_map * map, uint64_t hash) {
+    size_t mask = map->capacity - 1;
+    size_t pos = SYPHA_MAP_H1(hash) & mask;
+    size_t stride = 0;
+    unsigned int match;
+
+    while (!(match = sypha_map_group_match_free(map->ctrl + pos))) {
+        stride += SYPHA_MAP_GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+    return (pos + __builtin_ctz(match)) & mask;
+}
+
+// Moves every entry into a fresh table of capacity slots, returns 0 on success, otherwise < 0 and
+// the map is left as it was
+static int sypha_map_resize(struct _sypha_map * map, size_t capacity) {
+    size_t ctrl_sz = SYPHA_MAP_ALIGN(capacity + SYPHA_MAP_GROUP_WIDTH);
+    int8_t * old_ctrl = map->ctrl;
+    struct _sypha_map_entry ** old_slots = map->slots;
+    size_t old_capacity = map->capacity;
+    unsigned char * table;
+    size_t i;
+
+    if (capacity > (((size_t) -1) - ctrl_sz) / sizeof(struct _sypha_map_entry *)) {
+        return -1;
+    }
+    if (!(table = (unsigned char *) sypha_alloc(&map->allocator, ctrl_sz + capacity * sizeof(struct _sypha_map_entry *)))) {
+        return -1;
+    }
+
+    map->ctrl = (int8_t *) table;
+    map->slots = (struct _sypha_map_entry **) (table + ctrl_sz);
+    map->capacity = capacity;
+    memset(map->ctrl, (unsigned char) SYPHA_MAP_CTRL_EMPTY, capacity + SYPHA_MAP_GROUP_WIDTH);
+
+    for (i=0;i < old_capacity;i++) {
+        if (SYPHA_MAP_CTRL_IS_FULL(old_ctrl[i])) {
+            size_t slot = sypha_map_find_free(map, old_slots[i]->hash);
+            sypha_map_set_ctrl(map, slot, old_ctrl[i]);
+            map->slots[slot] = old_slots[i];
+        }
+    }
+    map->growth_left = SYPHA_MAP_MAX_LOAD(capacity) - map->count;
+
+    sypha_free(&map->allocator, old_ctrl);
+    return 0;
+}
+
+// Smallest table that holds count entries
+static size_t sypha_map_capacity_for(size_t count) {
+    size_t capacity = SYPHA_MAP_MIN_CAPACITY;
+    while (SYPHA_MAP_MAX_LOAD(capacity) < count) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// Empties slot i, marking it deleted only if a probe could have run past it
+static void sypha_map_erase(struct _sypha_map * map, size_t i) {
+    size_t before = (i - SYPHA_MAP_GROUP_WIDTH) & (map->capacity - 1);
+    unsigned int empty_after = sypha_map_group_match(map->ctrl + i, SYPHA_MAP_CTRL_EMPTY);
+    unsigned int empty_before = sypha_map_group_match(map->ctrl + before, SYPHA_MAP_CTRL_EMPTY);
+
+    // If the empties on either side are within a group of each other no group read covering i
+    // ever saw it without an empty, so no probe went on past it
+    if (empty_before && empty_after && (unsigned int) (__builtin_ctz(empty_after) + __builtin_clz(empty_before << 16)) < SYPHA_MAP_GROUP_WIDTH) {
+        sypha_map_set_ctrl(map, i, SYPHA_MAP_CTRL_EMPTY);
+        map->growth_left++;
+    } else {
+        sypha_map_set_ctrl(map, i, SYPHA_MAP_CTRL_DELETED);
+    }
+
+    sypha_free(&map->allocator, map->slots[i]);
+    map->count--;
+}
+
+SYPHA_MAP sypha_map_create() {
+    return sypha_map_create_with_allocator(NULL);
+}
+
+SYPHA_MAP sypha_map_create_with_allocator(const SYPHA_ALLOCATOR * allocator) {
+    struct _sypha_map * map;
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(map = (struct _sypha_map *) sypha_alloc(allocator, sizeof(struct _sypha_map)))) {
+        return NULL;
+    }
+    memset(map, 0x0, sizeof(struct _sypha_map));
+    map->allocator = *allocator;
+    sypha_arena_scratch_allocator(allocator, &map->scratch_allocator);
+
+    return (SYPHA_MAP) map;
+}
+
+void sypha_map_destroy(SYPHA_MAP map) {
+    struct _sypha_map * _map = (struct _sypha_map *) map;
+    if (!_map) {
+        return;
+    }
+
+    sypha_map_clear(_map);
+    sypha_free(&_map->allocator, _map->ctrl);
+    sypha_free(&_map->allocator, _map);
+}
+
+size_t sypha_map_count(SYPHA_MAP map) {
+    return ((struct _sypha_map *) map)->count;
+}
+
+int sypha_map_reserve(SYPHA_MAP map, size_t count) {
+    struct _sypha_map * _map = (struct _sypha_map *) map;
+    size_t capacity = sypha_map_capacity_for(count);
+
+    if (capacity <= _map->capacity) {
+        return 0;
+    }
+    return sypha_map_resize(_map, capacity);
+}
+
+void sypha_map_clear(SYPHA_MAP map) {
+    struct _sypha_map * _map = (struct _sypha_map *) map;
+    size_t i;
+
+    for (i=0;i < _map->capacity;i++) {
+        if (SYPHA_MAP_CTRL_IS_FULL(_map->ctrl[i])) {
+            sypha_free(&_map->allocator, _map->slots[i]);
+        }
+    }
+    if (_map->capacity) {
+        memset(_map->ctrl, (unsigned char) SYPHA_MAP_CTRL_EMPTY, _map->capacity + SYPHA_MAP_GROUP_WIDTH);
+    }
+    _map->count = 0;
+    _map->growth_left = SYPHA_MAP_MAX_LOAD(_map->capacity);
+}
+
+int sypha_map_put(SYPHA_MAP map, const void * key, size_t key_sz, const void * value, size_t value_sz) {
+    struct _sypha_map * _map = (struct _sypha_map *) map;
+    uint64_t hash = sypha_map_hash(key, key_sz);
+    struct _sypha_map_entry * entry;
+    size_t i;
+
+    if ((i = sypha_map_find(_map, key, key_sz, hash)) < _map->capacity) {
+        // Same size values are overwritten in place
+        entry = _map->slots[i];
+        if (entry->value_sz == value_sz) {
+            memcpy(SYPHA_MAP_ENTRY_VALUE(entry), value, value_sz);
+            return 0;
+        }
+    }
+
+    if (SYPHA_MAP_ALIGN(key_sz) < key_sz || value_sz > ((size_t) -1) - sizeof(struct _sypha_map_entry) - SYPHA_MAP_ALIGN(key_sz)) {
+        return -1;
+    }
+    if (!(entry = (struct _sypha_map_entry *) sypha_alloc(&_map->allocator, sizeof(struct _sypha_map_entry) + SYPHA_MAP_ALIGN(key_sz) + value_sz))) {
+        return -1;
+    }
+    entry->hash = hash;
+    entry->key_sz = key_sz;
+    entry->value_sz = value_sz;
+    memcpy(entry->data, key, key_sz);
+    memcpy(SYPHA_MAP_ENTRY_VALUE(entry), value, value_sz);
+
+    if (i < _map->capacity) {
+        sypha_free(&_map->allocator, _map->slots[i]);
+        _map->slots[i] = entry;
+        return 0;
+    }
+
+    if (!_map->capacity && sypha_map_resize(_map, SYPHA_MAP_MIN_CAPACITY) < 0) {
+        sypha_free(&_map->allocator, entry);
+        return -1;
+    }
+
+    // Reusing a deleted slot costs nothing, an empty one might mean growing first.  A table
+    // that is mostly tombstones is just rebuilt at the same size.
+    i = sypha_map_find_free(_map, hash);
+    if (!_map->growth_left && _map->ctrl[i] == SYPHA_MAP_CTRL_EMPTY) {
+        if (sypha_map_resize(_map, (_map->count < SYPHA_MAP_MAX_LOAD(_map->capacity) / 2) ? _map->capacity : _map->capacity * 2) < 0) {
+            sypha_free(&_map->allocator, entry);
+            return -1;
+        }
+        i = sypha_map_find_free(_map, hash);
+    }
+
+    if (_map->ctrl[i] == SYPHA_MAP_CTRL_EMPTY) {
+        _map->growth_left--;
+    }
+    sypha_map_set_ctrl(_map, i, SYPHA_MAP_H2(hash));
+    _map->slots[i] = entry;
+    _map->count++;
+
+    return 0;
+}
+
+void * sypha_map_get(SYPHA_MAP map, const void * key, size_t key_sz, size_t * value_sz) {
+    struct _sypha_map * _map = (struct _sypha_map *) map;
+    struct _sypha_map_entry * entry;
+    size_t i;
+
+    if ((i = sypha_map_find(_map, key, key_sz, sypha_map_hash(key, key_sz))) >= _map->capacity) {
+        return NULL;
+    }
+
+    entry = _map->slots[i];
+    if (value_sz) {
+        *value_sz = entry->value_sz;
+    }
+    return SYPHA_MAP_ENTRY_VALUE(entry);
+}
+
+int sypha_map_delete(SYPHA_MAP map, const void * key, size_t key_sz) {
+    struct _sypha_map * _map = (struct _sypha_map *) map;
+    size_t i;
+
+    if ((i = sypha_map_find(_map, key, key_sz, sypha_map_hash(key, key_sz))) >= _map->capacity) {
+        return -1;
+    }
+
+    sypha_map_erase(_map, i);
+    return 0;
+}
+
+SYPHA_MAP_ITERATOR sypha_map_get_iterator(SYPHA_MAP map) {
+    struct _sypha_map * _map = (struct _sypha_map *) map;
+    struct _sypha_map_iterator * iterator;
+    if (!(iterator = (struct _sypha_map_iterator *) sypha_alloc(&_map->scratch_allocator, sizeof(struct _sypha_map_iterator)))) {
+        return NULL;
+    }
+
+    iterator->map = _map;
+    iterator->index = 0;
+    iterator->is_pristine = 1;
+    iterator->has_current = 0;
+
+    return (SYPHA_MAP_ITERATOR) iterator;
+}
+
+void sypha_map_destroy_iterator(SYPHA_MAP_ITERATOR iterator) {
+    struct _sypha_map_iterator * _iterator = (struct _sypha_map_iterator *) iterator;
+    if (!_iterator) {
+        return;
+    }
+    sypha_free(&_iterator->map->scratch_allocator, _iterator);
+}
+
+int sypha_map_iterator_next(SYPHA_MAP_ITERATOR iterator) {
+    struct _sypha_map_iterator * _iterator = (struct _sypha_map_iterator *) iterator;
+    struct _sypha_map * _map = _iterator->map;
+    size_t i = (_iterator->is_pristine) ? 0 : _iterator->index + 1;
+
+    while (i < _map->capacity && !SYPHA_MAP_CTRL_IS_FULL(_map->ctrl[i])) {
+        i++;
+    }
+
+    // Stay on the last entry at the end
+    if (i >= _map->capacity) {
+        return -1;
+    }
+
+    _iterator->index = i;
+    _iterator->is_pristine = 0;
+    _iterator->has_current = 1;
+    return 0;
+}
+
+const void * sypha_map_iterator_get_key(SYPHA_MAP_ITERATOR iterator, size_t * key_sz) {
+    struct _sypha_map_iterator * _iterator = (struct _sypha_map_iterator *) iterator;
+    struct _sypha_map_entry * entry;
+
+    if (!_iterator->has_current) {
+        return NULL;
+    }
+
+    entry = _iterator->map->slots[_iterator->index];
+    *key_sz = entry->key_sz;
+    return entry->data;
+}
+
+void * sypha_map_iterator_get(SYPHA_MAP_ITERATOR iterator, size_t * value_sz) {
+    struct _sypha_map_iterator * _iterator = (struct _sypha_map_iterator *) iterator;
+    struct _sypha_map_entry * entry;
+
+    if (!_iterator->has_current) {
+        return NULL;
+    }
+
+    entry = _iterator->map->slots[_iterator->index];
+    if (value_sz) {
+        *value_sz = entry->value_sz;
+    }
+    return SYPHA_MAP_ENTRY_VALUE(entry);
+}
+
+int sypha_map_iterator_delete_current(SYPHA_MAP_ITERATOR iterator) {
+    struct _sypha_map_iterator * _iterator = (struct _sypha_map_iterator *) iterator;
+
+    if (!_iterator->has_current) {
+        return -1;
+    }
+
+    // Deleting never moves other entries so the scan just carries on from here
+    sypha_map_erase(_iterator->map, _iterator->index);
+    _iterator->has_current = 0;
+    return 0;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,297 @@
+/* sypha_mpmc_queue.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <pthread.h>
+#include <sched.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif // __SSE2__
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_mpmc_queue.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+#define SYPHA_MPMC_QUEUE_CACHE_LINE     64
+
+// Failed tries before a waiting push / pop starts yielding, and then before it parks
+#define SYPHA_MPMC_QUEUE_SPINS          64
+#define SYPHA_MPMC_QUEUE_YIELDS         16
+
+#define SYPHA_MPMC_QUEUE_ALIGN(sz)      (((sz) + 7) & ~((size_t) 7))
+
+// Cell header, the element follows it.  A cell at ring position pos is free for the push that
+// claimed pos when sequence == pos, and full for the pop that claims pos when sequence == pos + 1.
+struct _sypha_mpmc_queue_cell {
+    size_t sequence;
+};
+
+#define SYPHA_MPMC_QUEUE_CELL(queue, pos)   ((struct _sypha_mpmc_queue_cell *) ((queue)->cells + ((pos) & (queue)->mask) * (queue)->cell_sz))
+#define SYPHA_MPMC_QUEUE_CELL_DATA(cell)    ((unsigned char *) ((cell) + 1))
+
+struct _sypha_mpmc_queue {
+    // Never change after create
+    unsigned char * cells;
+    size_t mask;
+    size_t elem_sz;
+    size_t cell_sz;
+    SYPHA_ALLOCATOR allocator;
+
+    unsigned char pad0[SYPHA_MPMC_QUEUE_CACHE_LINE];
+    size_t push_pos;    // next ring position to fill
+    unsigned char pad1[SYPHA_MPMC_QUEUE_CACHE_LINE - sizeof(size_t)];
+    size_t pop_pos;     // next ring position to empty
+    unsigned char pad2[SYPHA_MPMC_QUEUE_CACHE_LINE - sizeof(size_t)];
+
+    // Parked waiting calls.  The counts are only bumped under park_lock, successful calls read
+    // them without it and only take the lock when someone is parked.
+    unsigned int push_waiters;
+    unsigned int pop_waiters;
+    pthread_mutex_t park_lock;
+    pthread_cond_t not_full;
+    pthread_cond_t not_empty;
+};
+
+// Waits a little after a failed try, returns 1 once it's time to park instead
+static inline int sypha_mpmc_queue_backoff(unsigned int * tries) {
+    if (++(*tries) < SYPHA_MPMC_QUEUE_SPINS) {
+#if defined(__SSE2__)
+        _mm_pause();
+#endif // __SSE2__
+    } else if (*tries < SYPHA_MPMC_QUEUE_SPINS + SYPHA_MPMC_QUEUE_YIELDS) {
+        sched_yield();
+    } else {
+        return 1;
+    }
+    return 0;
+}
+
+// Wakes one call parked on cond, if waiters says there is one, after a push / pop went through
+static inline void sypha_mpmc_queue_wake(struct _sypha_mpmc_queue * queue, unsigned int * waiters, pthread_cond_t * cond) {
+    // Pairs with the fence in park: either this sees the waiter or its last try sees our cell
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&queue->park_lock);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&queue->park_lock);
+    }
+}
+
+SYPHA_MPMC_QUEUE sypha_mpmc_queue_create(size_t elem_sz, size_t capacity) {
+    return sypha_mpmc_queue_create_with_allocator(NULL, elem_sz, capacity);
+}
+
+SYPHA_MPMC_QUEUE sypha_mpmc_queue_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz, size_t capacity) {
+    struct _sypha_mpmc_queue * queue;
+    size_t ring = 2;
+    size_t i;
+
+    if (elem_sz == 0 || elem_sz > ((size_t) -1) / 4 || capacity > ((size_t) -1) / 4) {
+        return NULL;
+    }
+    while (ring < capacity) {
+        ring *= 2;
+    }
+    if (ring > ((size_t) -1) / SYPHA_MPMC_QUEUE_ALIGN(sizeof(struct _sypha_mpmc_queue_cell) + elem_sz)) {
+        return NULL;
+    }
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(queue = (struct _sypha_mpmc_queue *) sypha_alloc(allocator, sizeof(struct _sypha_mpmc_queue)))) {
+        return NULL;
+    }
+    memset(queue, 0x0, sizeof(struct _sypha_mpmc_queue));
+    queue->mask = ring - 1;
+    queue->elem_sz = elem_sz;
+    queue->cell_sz = SYPHA_MPMC_QUEUE_ALIGN(sizeof(struct _sypha_mpmc_queue_cell) + elem_sz);
+    queue->allocator = *allocator;
+    pthread_mutex_init(&queue->park_lock, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+
+    if (!(queue->cells = (unsigned char *) sypha_alloc(allocator, ring * queue->cell_sz))) {
+        pthread_cond_destroy(&queue->not_empty);
+        pthread_cond_destroy(&queue->not_full);
+        pthread_mutex_destroy(&queue->park_lock);
+        sypha_free(allocator, queue);
+        return NULL;
+    }
+    for (i=0;i < ring;i++) {
+        SYPHA_MPMC_QUEUE_CELL(queue, i)->sequence = i;
+    }
+
+    return (SYPHA_MPMC_QUEUE) queue;
+}
+
+void sypha_mpmc_queue_destroy(SYPHA_MPMC_QUEUE queue) {
+    struct _sypha_mpmc_queue * _queue = (struct _sypha_mpmc_queue *) queue;
+    if (!_queue) {
+        return;
+    }
+
+    pthread_cond_destroy(&_queue->not_empty);
+    pthread_cond_destroy(&_queue->not_full);
+    pthread_mutex_destroy(&_queue->park_lock);
+    sypha_free(&_queue->allocator, _queue->cells);
+    sypha_free(&_queue->allocator, _queue);
+}
+
+size_t sypha_mpmc_queue_capacity(SYPHA_MPMC_QUEUE queue) {
+    return ((struct _sypha_mpmc_queue *) queue)->mask + 1;
+}
+
+size_t sypha_mpmc_queue_count(SYPHA_MPMC_QUEUE queue) {
+    struct _sypha_mpmc_queue * _queue = (struct _sypha_mpmc_queue *) queue;
+    size_t pop_pos = __atomic_load_n(&_queue->pop_pos, __ATOMIC_RELAXED);
+    size_t push_pos = __atomic_load_n(&_queue->push_pos, __ATOMIC_RELAXED);
+
+    // The two loads aren't one snapshot, keep the difference in range
+    if ((intptr_t) (push_pos - pop_pos) < 0) {
+        return 0;
+    }
+    return (push_pos - pop_pos > _queue->mask + 1) ? _queue->mask + 1 : push_pos - pop_pos;
+}
+
+// try_push without waking anyone, returns 0 if added, < 0 if full
+static int sypha_mpmc_queue_put(struct _sypha_mpmc_queue * _queue, const void * data) {
+    struct _sypha_mpmc_queue_cell * cell;
+    size_t pos = __atomic_load_n(&_queue->push_pos, __ATOMIC_RELAXED);
+    intptr_t diff;
+
+    while (1) {
+        cell = SYPHA_MPMC_QUEUE_CELL(_queue, pos);
+        diff = (intptr_t) (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            // Free, claim it unless another producer got there first (which reloads pos)
+            if (__atomic_compare_exchange_n(&_queue->push_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Still holding the element from a lap ago
+            return -1;
+        } else {
+            pos = __atomic_load_n(&_queue->push_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(SYPHA_MPMC_QUEUE_CELL_DATA(cell), data, _queue->elem_sz);
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// try_pop without waking anyone, returns 0 if removed, < 0 if empty
+static int sypha_mpmc_queue_take(struct _sypha_mpmc_queue * _queue, void * data) {
+    struct _sypha_mpmc_queue_cell * cell;
+    size_t pos = __atomic_load_n(&_queue->pop_pos, __ATOMIC_RELAXED);
+    intptr_t diff;
+
+    while (1) {
+        cell = SYPHA_MPMC_QUEUE_CELL(_queue, pos);
+        diff = (intptr_t) (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&_queue->pop_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Not filled yet
+            return -1;
+        } else {
+            pos = __atomic_load_n(&_queue->pop_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(data, SYPHA_MPMC_QUEUE_CELL_DATA(cell), _queue->elem_sz);
+    // Free for the push a lap from now
+    __atomic_store_n(&cell->sequence, pos + _queue->mask + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Parks a waiting push (push_data set) or pop on cond until woken, unless one last try goes
+// through.  The caller is counted in waiters before that try so a wake can't slip past it.
+// Returns the try's result.
+static int sypha_mpmc_queue_park(struct _sypha_mpmc_queue * queue, unsigned int * waiters, pthread_cond_t * cond,
+        const void * push_data, void * pop_data) {
+    int result;
+
+    pthread_mutex_lock(&queue->park_lock);
+    __atomic_add_fetch(waiters, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    result = (push_data) ? sypha_mpmc_queue_put(queue, push_data) : sypha_mpmc_queue_take(queue, pop_data);
+    if (result < 0) {
+        pthread_cond_wait(cond, &queue->park_lock);
+    }
+    __atomic_sub_fetch(waiters, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&queue->park_lock);
+    return result;
+}
+
+int sypha_mpmc_queue_try_push(SYPHA_MPMC_QUEUE queue, const void * data) {
+    struct _sypha_mpmc_queue * _queue = (struct _sypha_mpmc_queue *) queue;
+
+    if (sypha_mpmc_queue_put(_queue, data) < 0) {
+        return -1;
+    }
+    sypha_mpmc_queue_wake(_queue, &_queue->pop_waiters, &_queue->not_empty);
+    return 0;
+}
+
+int sypha_mpmc_queue_try_pop(SYPHA_MPMC_QUEUE queue, void * data) {
+    struct _sypha_mpmc_queue * _queue = (struct _sypha_mpmc_queue *) queue;
+
+    if (sypha_mpmc_queue_take(_queue, data) < 0) {
+        return -1;
+    }
+    sypha_mpmc_queue_wake(_queue, &_queue->push_waiters, &_queue->not_full);
+    return 0;
+}
+
+void sypha_mpmc_queue_push(SYPHA_MPMC_QUEUE queue, const void * data) {
+    struct _sypha_mpmc_queue * _queue = (struct _sypha_mpmc_queue *) queue;
+    unsigned int tries = 0;
+
+    while (sypha_mpmc_queue_put(_queue, data) < 0) {
+        if (sypha_mpmc_queue_backoff(&tries) &&
+                sypha_mpmc_queue_park(_queue, &_queue->push_waiters, &_queue->not_full, data, NULL) == 0) {
+            break;
+        }
+    }
+    sypha_mpmc_queue_wake(_queue, &_queue->pop_waiters, &_queue->not_empty);
+}
+
+void sypha_mpmc_queue_pop(SYPHA_MPMC_QUEUE queue, void * data) {
+    struct _sypha_mpmc_queue * _queue = (struct _sypha_mpmc_queue *) queue;
+    unsigned int tries = 0;
+
+    while (sypha_mpmc_queue_take(_queue, data) < 0) {
+        if (sypha_mpmc_queue_backoff(&tries) &&
+                sypha_mpmc_queue_park(_queue, &_queue->pop_waiters, &_queue->not_empty, NULL, data) == 0) {
+            break;
+        }
+    }
+    sypha_mpmc_queue_wake(_queue, &_queue->push_waiters, &_queue->not_full);
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "syphac/sypha_alloc.h"
 #include "syphac/sypha_opt.h"
 
 #if defined(__cplusplus)
@@ -32,6 +33,11 @@ struct _sypha_opt_config_item {
     struct _sypha_opt_config_item * next;
 };
 
+struct _sypha_opt_config {
+    SYPHA_ALLOCATOR allocator;
+    struct _sypha_opt_config_item * items;
+};
+
 struct _sypha_opt_result_item {
     char * short_name;
     char * long_name;
@@ -40,6 +46,7 @@ struct _sypha_opt_result_item {
 };
 
 struct _sypha_opt_result {
+    SYPHA_ALLOCATOR allocator;
     struct _sypha_opt_result_item * items;
     char ** extras;
 };
@@ -55,7 +62,23 @@ static struct _sypha_opt_config_item * sypha_opt_config_find(struct _sypha_opt_c
     return NULL;
 }
 
+SYPHA_OPT_CONFIG sypha_opt_config_create(const SYPHA_ALLOCATOR * allocator) {
+    struct _sypha_opt_config * config;
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(config = (struct _sypha_opt_config *) sypha_alloc(allocator, sizeof(struct _sypha_opt_config)))) {
+        return NULL;
+    }
+    config->allocator = *allocator;
+    config->items = NULL;
+    return (SYPHA_OPT_CONFIG) config;
+}
+
 SYPHA_OPT_CONFIG sypha_opt_config_add_param(SYPHA_OPT_CONFIG cfg, const char * short_name, const char * long_name, int is_flag, int is_required) {
+    struct _sypha_opt_config * config = (struct _sypha_opt_config *) cfg;
     struct _sypha_opt_config_item * item, * parent;
     
     // TODO: also check that second char is an alpha
@@ -68,48 +91,67 @@ SYPHA_OPT_CONFIG sypha_opt_config_add_param(SYPHA_OPT_CONFIG cfg, const char * s
         return NULL;
     }
 
-    if (!(item = (struct _sypha_opt_config_item *) malloc(sizeof(struct _sypha_opt_config_item)))) {
+    if (!config && !(config = (struct _sypha_opt_config *) sypha_opt_config_create(NULL))) {
+        return NULL;
+    }
+
+    if (!(item = (struct _sypha_opt_config_item *) sypha_alloc(&config->allocator, sizeof(struct _sypha_opt_config_item)))) {
+        if (!cfg) {
+            sypha_opt_config_free(config);
+        }
         return NULL;
     }
     item->short_name = NULL;
     item->long_name = NULL;
-    item->short_name = strdup(short_name);
-    item->long_name = strdup(long_name);
+    item->short_name = sypha_allocator_strdup(&config->allocator, short_name);
+    item->long_name = sypha_allocator_strdup(&config->allocator, long_name);
     item->is_flag = is_flag;
     item->is_required = is_required;
     item->next = NULL;
     if (!item->short_name || !item->long_name) {
-        free(item->short_name);
-        free(item->long_name);
-        free(item);
+        sypha_free(&config->allocator, item->short_name);
+        sypha_free(&config->allocator, item->long_name);
+        sypha_free(&config->allocator, item);
+        if (!cfg) {
+            sypha_opt_config_free(config);
+        }
         return NULL;
     }
 
-    if ((parent = (struct _sypha_opt_config_item *) cfg)) {
+    if ((parent = config->items)) {
         while (parent->next) {
             parent = parent->next;
         }
         parent->next = item;
-        return cfg;
     } else {
-        return (SYPHA_OPT_CONFIG) item;
+        config->items = item;
     }
+
+    return (SYPHA_OPT_CONFIG) config;
 }
 
 void sypha_opt_config_free(SYPHA_OPT_CONFIG cfg) {
+    struct _sypha_opt_config * config = (struct _sypha_opt_config *) cfg;
     struct _sypha_opt_config_item * param, * next;
-    param = (struct _sypha_opt_config_item *) cfg;
+
+    if (!config) {
+        return;
+    }
+
+    param = config->items;
     while (param) {
         next = param->next;
-        free(param->short_name);
-        free(param->long_name);
-        free(param);
+        sypha_free(&config->allocator, param->short_name);
+        sypha_free(&config->allocator, param->long_name);
+        sypha_free(&config->allocator, param);
         param = next;
     }
+
+    sypha_free(&config->allocator, config);
 }
 
 void sypha_opt_config_print(SYPHA_OPT_CONFIG cfg) {
-    struct _sypha_opt_config_item * param = (struct _sypha_opt_config_item *) cfg;
+    struct _sypha_opt_config_item * param = (cfg) ? ((struct _sypha_opt_config *) cfg)->items : NULL;
 
     printf("SYPHA_OPT_CONFIG:\n{\n");
     while (param) {
@@ -136,16 +178,20 @@ static int sypha_validate_required_in_result(struct _sypha_opt_result * result,
 
 SYPHA_OPT_PARSE_RESULT sypha_opt_parse_args(SYPHA_OPT_CONFIG cfg, int argc, char ** argv) {
     struct _sypha_opt_result * result;
-    struct _sypha_opt_config_item * config_items = (struct _sypha_opt_config_item *) cfg;
+    struct _sypha_opt_config * config = (struct _sypha_opt_config *) cfg;
+    struct _sypha_opt_config_item * config_items = (config) ? config->items : NULL;
+    const SYPHA_ALLOCATOR * allocator = (config) ? &config->allocator : sypha_allocator_get_default();
 
-    if (!(result = (struct _sypha_opt_result *) malloc(sizeof(struct _sypha_opt_result)))) {
+    // The result shares the config's allocator
+    if (!(result = (struct _sypha_opt_result *) sypha_alloc(allocator, sizeof(struct _sypha_opt_result)))) {
         return NULL;
     }
+    result->allocator = *allocator;
     result->items = NULL;
     result->extras = NULL;
 
     size_t extras_size = argc * sizeof(char *);
-    if (!(result->extras = (char **) malloc(extras_size))) {
+    if (!(result->extras = (char **) sypha_alloc(allocator, extras_size))) {
         sypha_opt_parse_free(result);
         return NULL;
     }
@@ -166,7 +212,7 @@ SYPHA_OPT_PARSE_RESULT sypha_opt_parse_args(SYPHA_OPT_CONFIG cfg, int argc, char
         if (argLen == 2 && arg[0] == '-') {
             // find it
             if ((config_item = sypha_opt_config_find(config_items, arg))) {
-                if (!(result_item = (struct _sypha_opt_result_item *) malloc(sizeof(struct _sypha_opt_result_item)))) {
+                if (!(result_item = (struct _sypha_opt_result_item *) sypha_alloc(allocator, sizeof(struct _sypha_opt_result_item)))) {
                     sypha_opt_parse_free(result);
                     return NULL;
                 }
@@ -174,8 +220,8 @@ SYPHA_OPT_PARSE_RESULT sypha_opt_parse_args(SYPHA_OPT_CONFIG cfg, int argc, char
                 result_item->long_name = NULL;
                 result_item->value = NULL;
                 result_item->next = NULL;
-                result_item->short_name = strdup(config_item->short_name);
-                result_item->long_name = strdup(config_item->long_name);
+                result_item->short_name = sypha_allocator_strdup(allocator, config_item->short_name);
+                result_item->long_name = sypha_allocator_strdup(allocator, config_item->long_name);
                 if (!result_item->short_name || !result_item->long_name) {
                     sypha_opt_parse_free(result);
                     return NULL;
@@ -199,7 +245,7 @@ SYPHA_OPT_PARSE_RESULT sypha_opt_parse_args(SYPHA_OPT_CONFIG cfg, int argc, char
         if (argLen > 2 && arg[0] == '-' && arg[1] == '-') {
            // find it
             if ((config_item = sypha_opt_config_find(config_items, arg))) {
-                if (!(result_item = (struct _sypha_opt_result_item *) malloc(sizeof(struct _sypha_opt_result_item)))) {
+                if (!(result_item = (struct _sypha_opt_result_item *) sypha_alloc(allocator, sizeof(struct _sypha_opt_result_item)))) {
                     sypha_opt_parse_free(result);
                     return NULL;
                 }
@@ -207,8 +253,8 @@ SYPHA_OPT_PARSE_RESULT sypha_opt_parse_args(SYPHA_OPT_CONFIG cfg, int argc, char
                 result_item->long_name = NULL;
                 result_item->value = NULL;
                 result_item->next = NULL;
-                result_item->short_name = strdup(config_item->short_name);
-                result_item->long_name = strdup(config_item->long_name);
+                result_item->short_name = sypha_allocator_strdup(allocator, config_item->short_name);
+                result_item->long_name = sypha_allocator_strdup(allocator, config_item->long_name);
                 if (!result_item->short_name || !result_item->long_name) {
                     sypha_opt_parse_free(result);
                     return NULL;
@@ -229,14 +275,14 @@ SYPHA_OPT_PARSE_RESULT sypha_opt_parse_args(SYPHA_OPT_CONFIG cfg, int argc, char
         }
 
         if (last_needs_value) {
-            if (!(result_item->value = strdup(arg))) {
+            if (!(result_item->value = sypha_allocator_strdup(allocator, arg))) {
                 sypha_opt_parse_free(result);
                 return NULL;
             }
             last_needs_value = 0;
         } else {
             // add it to rando token list
-            if (!(result->extras[extras_count] = strdup(arg))) {
+            if (!(result->extras[extras_count] = sypha_allocator_strdup(allocator, arg))) {
                 sypha_opt_parse_free(result);
                 return NULL;
             }
@@ -263,26 +309,26 @@ void sypha_opt_parse_free(SYPHA_OPT_PARSE_RESULT parse_result) {
 
     item = opt_result->items;
     while (item) {
-        free(item->short_name);
-        free(item->long_name);
-        free(item->value);
+        sypha_free(&opt_result->allocator, item->short_name);
+        sypha_free(&opt_result->allocator, item->long_name);
+        sypha_free(&opt_result->allocator, item->value);
         item_next = item->next;
-        free(item);
+        sypha_free(&opt_result->allocator, item);
         item = item_next;
     }
     
     extras = opt_result->extras;
     while (extras) {
         if (*extras) {
-            free(*extras);
+            sypha_free(&opt_result->allocator, *extras);
             extras++;
         } else {
             break;
         }
     }
-    free(opt_result->extras);
+    sypha_free(&opt_result->allocator, opt_result->extras);
 
-    free(opt_result);
+    sypha_free(&opt_result->allocator, opt_result);
 }
 
 static struct _sypha_opt_result_item * sypha_opt_parse_result_find(struct _sypha_opt_result_item * items, const char * name) {
@@ -0,0 +1,228 @@
+/* sypha_pool.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_pool.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+struct _sypha_pool {
+    SYPHA_ALLOCATOR allocator;
+
+    pthread_t * workers;
+    size_t worker_count;
+
+    // Guards the batch hand off, workers sleep on work_cond and the caller on done_cond
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    unsigned long generation;
+    int shutdown;
+    size_t active;          // workers inside the current batch
+
+    // One batch at a time
+    pthread_mutex_t run_lock;
+
+    // The current batch, tasks are claimed by bumping next
+    SYPHA_POOL_TASK task;
+    unsigned char * args;
+    size_t arg_sz;
+    size_t count;
+    size_t next;
+    size_t pending;
+};
+
+// The pool whose task this thread is running, if any
+static __thread struct _sypha_pool * sypha_pool_current;
+
+// Claims and runs tasks from the current batch until there are none left
+static void sypha_pool_work(struct _sypha_pool * pool) {
+    struct _sypha_pool * outer = sypha_pool_current;
+    size_t i;
+
+    sypha_pool_current = pool;
+    while ((i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_ACQ_REL)) < pool->count) {
+        pool->task(pool->args + i * pool->arg_sz);
+
+        // Last one out wakes the caller
+        if (__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->done_cond);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+    sypha_pool_current = outer;
+}
+
+static void * sypha_pool_worker(void * arg) {
+    struct _sypha_pool * pool = (struct _sypha_pool *) arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        pool->active++;
+
+        pthread_mutex_unlock(&pool->lock);
+        sypha_pool_work(pool);
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+SYPHA_POOL sypha_pool_create(size_t nthreads) {
+    const SYPHA_ALLOCATOR * allocator = sypha_allocator_get_default();
+    struct _sypha_pool * pool;
+
+    if (!nthreads) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (online > 0) ? (size_t) online : 1;
+    }
+
+    if (!(pool = (struct _sypha_pool *) sypha_alloc(allocator, sizeof(struct _sypha_pool)))) {
+        return NULL;
+    }
+    pool->allocator = *allocator;
+    pool->worker_count = 0;
+    pool->generation = 0;
+    pool->shutdown = 0;
+    pool->active = 0;
+    pool->task = NULL;
+    pool->args = NULL;
+    pool->arg_sz = 0;
+    pool->count = 0;
+    pool->next = 0;
+    pool->pending = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    pthread_mutex_init(&pool->run_lock, NULL);
+
+    if (!(pool->workers = (pthread_t *) sypha_alloc(&pool->allocator, sizeof(pthread_t) * nthreads))) {
+        sypha_pool_destroy((SYPHA_POOL) pool);
+        return NULL;
+    }
+
+    // The caller is the first thread
+    while (pool->worker_count < nthreads - 1) {
+        if (pthread_create(&pool->workers[pool->worker_count], NULL, sypha_pool_worker, pool) != 0) {
+            sypha_pool_destroy((SYPHA_POOL) pool);
+            return NULL;
+        }
+        pool->worker_count++;
+    }
+
+    return (SYPHA_POOL) pool;
+}
+
+void sypha_pool_destroy(SYPHA_POOL pool) {
+    struct _sypha_pool * _pool = (struct _sypha_pool *) pool;
+    if (!_pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&_pool->lock);
+    _pool->shutdown = 1;
+    pthread_cond_broadcast(&_pool->work_cond);
+    pthread_mutex_unlock(&_pool->lock);
+
+    for (size_t i=0;i < _pool->worker_count;i++) {
+        pthread_join(_pool->workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&_pool->lock);
+    pthread_cond_destroy(&_pool->work_cond);
+    pthread_cond_destroy(&_pool->done_cond);
+    pthread_mutex_destroy(&_pool->run_lock);
+    sypha_free(&_pool->allocator, _pool->workers);
+    sypha_free(&_pool->allocator, _pool);
+}
+
+size_t sypha_pool_thread_count(SYPHA_POOL pool) {
+    return ((struct _sypha_pool *) pool)->worker_count + 1;
+}
+
+int sypha_pool_run(SYPHA_POOL pool, SYPHA_POOL_TASK task, void * args, size_t arg_sz, size_t count) {
+    struct _sypha_pool * _pool = (struct _sypha_pool *) pool;
+
+    if (!task) {
+        return -1;
+    }
+    if (!count) {
+        return 0;
+    }
+
+    // A task handing the pool another batch would wait on its own batch forever, the nested batch
+    // runs right here instead
+    if (sypha_pool_current == _pool) {
+        for (size_t i=0;i < count;i++) {
+            task(((unsigned char *) args) + i * arg_sz);
+        }
+        return 0;
+    }
+
+    pthread_mutex_lock(&_pool->run_lock);
+
+    // A worker that woke up late may still be trying to claim from the last batch, wait for it to
+    // leave so nobody claims from this one while it's set up
+    pthread_mutex_lock(&_pool->lock);
+    while (_pool->active) {
+        pthread_cond_wait(&_pool->done_cond, &_pool->lock);
+    }
+    _pool->task = task;
+    _pool->args = (unsigned char *) args;
+    _pool->arg_sz = arg_sz;
+    _pool->count = count;
+    __atomic_store_n(&_pool->pending, count, __ATOMIC_RELEASE);
+    __atomic_store_n(&_pool->next, 0, __ATOMIC_RELEASE);
+    _pool->generation++;
+    pthread_cond_broadcast(&_pool->work_cond);
+    pthread_mutex_unlock(&_pool->lock);
+
+    sypha_pool_work(_pool);
+
+    // Done once every task has finished and every worker has stopped claiming
+    pthread_mutex_lock(&_pool->lock);
+    while (__atomic_load_n(&_pool->pending, __ATOMIC_ACQUIRE) || _pool->active) {
+        pthread_cond_wait(&_pool->done_cond, &_pool->lock);
+    }
+    pthread_mutex_unlock(&_pool->lock);
+
+    pthread_mutex_unlock(&_pool->run_lock);
+    return 0;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,345 @@
+/* sypha_skiplist.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_skiplist.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+// Enough for 4^24 items before the top level stops thinning out
+#define SYPHA_SKIPLIST_MAX_LEVEL    24
+
+// Item node, the data follows its level links
+struct _sypha_skiplist_node {
+    struct _sypha_skiplist_node * prev;     // bottom level only
+    size_t data_sz;
+    unsigned int level;
+    struct _sypha_skiplist_node * next[];
+};
+
+#define SYPHA_SKIPLIST_NODE_DATA(node)  ((unsigned char *) ((node)->next + (node)->level))
+
+// Node owning a links array, links being either a node's or the head's
+#define SYPHA_SKIPLIST_LINKS_NODE(skiplist, links) \
+    (((links) == (skiplist)->head) ? NULL : (struct _sypha_skiplist_node *) (((unsigned char *) (links)) - offsetof(struct _sypha_skiplist_node, next)))
+
+struct _sypha_skiplist {
+    struct _sypha_skiplist_node * head[SYPHA_SKIPLIST_MAX_LEVEL];
+    struct _sypha_skiplist_node * tail;
+    unsigned int level;     // levels in use
+    size_t count;
+    uint64_t seed;          // xorshift state for node levels
+
+    SYPHA_LIST_COMPARATOR cmp;
+    void * ctx;
+    SYPHA_ALLOCATOR allocator;
+    // Iterators come from here, see sypha_arena_scratch_allocator
+    SYPHA_ALLOCATOR scratch_allocator;
+};
+
+struct _sypha_skiplist_iterator {
+    struct _sypha_skiplist * skiplist;
+    struct _sypha_skiplist_node * current;  // NULL when between items
+    struct _sypha_skiplist_node * pending;  // where "next" goes when between items, NULL for the end
+    unsigned int is_forward;
+};
+
+// A new node's level, each level up is a quarter as likely
+static unsigned int sypha_skiplist_random_level(struct _sypha_skiplist * skiplist) {
+    uint64_t bits;
+    unsigned int level = 1;
+
+    skiplist->seed ^= skiplist->seed << 13;
+    skiplist->seed ^= skiplist->seed >> 7;
+    skiplist->seed ^= skiplist->seed << 17;
+    for (bits = skiplist->seed;(bits & 3) == 0 && level < SYPHA_SKIPLIST_MAX_LEVEL;bits >>= 2) {
+        level++;
+    }
+    return level;
+}
+
+// Fills in the links on every level that lead past items less than key (or, with inclusive
+// set, not greater than key), returns the bottom one
+static struct _sypha_skiplist_node ** sypha_skiplist_search(struct _sypha_skiplist * skiplist, const void * key, size_t key_sz, int inclusive, struct _sypha_skiplist_node *** update) {
+    struct _sypha_skiplist_node ** links = skiplist->head;
+    struct _sypha_skiplist_node * next;
+    int level;
+
+    for (level=(int) skiplist->level - 1;level >= 0;level--) {
+        while ((next = links[level]) && skiplist->cmp(SYPHA_SKIPLIST_NODE_DATA(next), next->data_sz, key, key_sz, skiplist->ctx) < inclusive) {
+            links = next->next;
+        }
+        if (update) {
+            update[level] = links;
+        }
+    }
+    return links;
+}
+
+// Unlinks and frees node, update holds the links leading past the items less than it
+static void sypha_skiplist_unlink(struct _sypha_skiplist * skiplist, struct _sypha_skiplist_node * node, struct _sypha_skiplist_node *** update) {
+    unsigned int level;
+
+    for (level=0;level < node->level;level++) {
+        // Items equal to node can sit in between
+        while (update[level][level] != node) {
+            update[level] = update[level][level]->next;
+        }
+        update[level][level] = node->next[level];
+    }
+
+    if (node->next[0]) {
+        node->next[0]->prev = node->prev;
+    } else {
+        skiplist->tail = node->prev;
+    }
+    while (skiplist->level > 1 && !skiplist->head[skiplist->level - 1]) {
+        skiplist->level--;
+    }
+
+    sypha_free(&skiplist->allocator, node);
+    skiplist->count--;
+}
+
+SYPHA_SKIPLIST sypha_skiplist_create(SYPHA_LIST_COMPARATOR cmp, void * ctx) {
+    return sypha_skiplist_create_with_allocator(NULL, cmp, ctx);
+}
+
+SYPHA_SKIPLIST sypha_skiplist_create_with_allocator(const SYPHA_ALLOCATOR * allocator, SYPHA_LIST_COMPARATOR cmp, void * ctx) {
+    struct _sypha_skiplist * skiplist;
+
+    if (!cmp) {
+        return NULL;
+    }
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(skiplist = (struct _sypha_skiplist *) sypha_alloc(allocator, sizeof(struct _sypha_skiplist)))) {
+        return NULL;
+    }
+    memset(skiplist, 0x0, sizeof(struct _sypha_skiplist));
+    skiplist->level = 1;
+    skiplist->seed = 0x9e3779b97f4a7c15ULL ^ (uint64_t) (uintptr_t) skiplist;
+    skiplist->cmp = cmp;
+    skiplist->ctx = ctx;
+    skiplist->allocator = *allocator;
+    sypha_arena_scratch_allocator(allocator, &skiplist->scratch_allocator);
+
+    return (SYPHA_SKIPLIST) skiplist;
+}
+
+void sypha_skiplist_destroy(SYPHA_SKIPLIST skiplist) {
+    struct _sypha_skiplist * _skiplist = (struct _sypha_skiplist *) skiplist;
+    struct _sypha_skiplist_node * node;
+    struct _sypha_skiplist_node * node_next;
+    if (!_skiplist) {
+        return;
+    }
+
+    for (node = _skiplist->head[0];node;node = node_next) {
+        node_next = node->next[0];
+        sypha_free(&_skiplist->allocator, node);
+    }
+    sypha_free(&_skiplist->allocator, _skiplist);
+}
+
+size_t sypha_skiplist_count(SYPHA_SKIPLIST skiplist) {
+    return ((struct _sypha_skiplist *) skiplist)->count;
+}
+
+int sypha_skiplist_insert(SYPHA_SKIPLIST skiplist, const void * data, size_t data_sz) {
+    struct _sypha_skiplist * _skiplist = (struct _sypha_skiplist *) skiplist;
+    struct _sypha_skiplist_node ** update[SYPHA_SKIPLIST_MAX_LEVEL];
+    struct _sypha_skiplist_node * node;
+    unsigned int level = sypha_skiplist_random_level(_skiplist);
+    unsigned int i;
+
+    if (data_sz > ((size_t) -1) - sizeof(struct _sypha_skiplist_node) - SYPHA_SKIPLIST_MAX_LEVEL * sizeof(struct _sypha_skiplist_node *)) {
+        return -1;
+    }
+    if (!(node = (struct _sypha_skiplist_node *) sypha_alloc(&_skiplist->allocator, sizeof(struct _sypha_skiplist_node) + level * sizeof(struct _sypha_skiplist_node *) + data_sz))) {
+        return -1;
+    }
+    node->data_sz = data_sz;
+    node->level = level;
+    memcpy(SYPHA_SKIPLIST_NODE_DATA(node), data, data_sz);
+
+    sypha_skiplist_search(_skiplist, data, data_sz, 1, update);
+    for (i=_skiplist->level;i < level;i++) {
+        update[i] = _skiplist->head;
+    }
+    if (level > _skiplist->level) {
+        _skiplist->level = level;
+    }
+
+    for (i=0;i < level;i++) {
+        node->next[i] = update[i][i];
+        update[i][i] = node;
+    }
+
+    node->prev = SYPHA_SKIPLIST_LINKS_NODE(_skiplist, update[0]);
+    if (node->next[0]) {
+        node->next[0]->prev = node;
+    } else {
+        _skiplist->tail = node;
+    }
+    _skiplist->count++;
+
+    return 0;
+}
+
+int sypha_skiplist_delete(SYPHA_SKIPLIST skiplist, const void * key, size_t key_sz) {
+    struct _sypha_skiplist * _skiplist = (struct _sypha_skiplist *) skiplist;
+    struct _sypha_skiplist_node ** update[SYPHA_SKIPLIST_MAX_LEVEL];
+    struct _sypha_skiplist_node * node = sypha_skiplist_search(_skiplist, key, key_sz, 0, update)[0];
+
+    if (!node || _skiplist->cmp(SYPHA_SKIPLIST_NODE_DATA(node), node->data_sz, key, key_sz, _skiplist->ctx) != 0) {
+        return -1;
+    }
+
+    sypha_skiplist_unlink(_skiplist, node, update);
+    return 0;
+}
+
+void * sypha_skiplist_find(SYPHA_SKIPLIST skiplist, const void * key, size_t key_sz, size_t * data_sz) {
+    struct _sypha_skiplist * _skiplist = (struct _sypha_skiplist *) skiplist;
+    struct _sypha_skiplist_node * node = sypha_skiplist_search(_skiplist, key, key_sz, 0, NULL)[0];
+
+    if (!node || _skiplist->cmp(SYPHA_SKIPLIST_NODE_DATA(node), node->data_sz, key, key_sz, _skiplist->ctx) != 0) {
+        return NULL;
+    }
+
+    if (data_sz) {
+        *data_sz = node->data_sz;
+    }
+    return SYPHA_SKIPLIST_NODE_DATA(node);
+}
+
+static SYPHA_SKIPLIST_ITERATOR sypha_skiplist_get_iterator(struct _sypha_skiplist * skiplist, struct _sypha_skiplist_node * pending, unsigned int is_forward) {
+    struct _sypha_skiplist_iterator * iterator;
+    if (!(iterator = (struct _sypha_skiplist_iterator *) sypha_alloc(&skiplist->scratch_allocator, sizeof(struct _sypha_skiplist_iterator)))) {
+        return NULL;
+    }
+
+    iterator->skiplist = skiplist;
+    iterator->current = NULL;
+    iterator->pending = pending;
+    iterator->is_forward = is_forward;
+
+    return (SYPHA_SKIPLIST_ITERATOR) iterator;
+}
+
+SYPHA_SKIPLIST_ITERATOR sypha_skiplist_get_iterator_front(SYPHA_SKIPLIST skiplist) {
+    struct _sypha_skiplist * _skiplist = (struct _sypha_skiplist *) skiplist;
+    return sypha_skiplist_get_iterator(_skiplist, _skiplist->head[0], 1);
+}
+
+SYPHA_SKIPLIST_ITERATOR sypha_skiplist_get_iterator_back(SYPHA_SKIPLIST skiplist) {
+    struct _sypha_skiplist * _skiplist = (struct _sypha_skiplist *) skiplist;
+    return sypha_skiplist_get_iterator(_skiplist, _skiplist->tail, 0);
+}
+
+SYPHA_SKIPLIST_ITERATOR sypha_skiplist_get_iterator_lower_bound(SYPHA_SKIPLIST skiplist, const void * key, size_t key_sz) {
+    struct _sypha_skiplist * _skiplist = (struct _sypha_skiplist *) skiplist;
+    return sypha_skiplist_get_iterator(_skiplist, sypha_skiplist_search(_skiplist, key, key_sz, 0, NULL)[0], 1);
+}
+
+void sypha_skiplist_destroy_iterator(SYPHA_SKIPLIST_ITERATOR iterator) {
+    struct _sypha_skiplist_iterator * _iterator = (struct _sypha_skiplist_iterator *) iterator;
+    if (!_iterator) {
+        return;
+    }
+    sypha_free(&_iterator->skiplist->scratch_allocator, _iterator);
+}
+
+void * sypha_skiplist_iterator_get(SYPHA_SKIPLIST_ITERATOR iterator, size_t * data_sz) {
+    struct _sypha_skiplist_iterator * _iterator = (struct _sypha_skiplist_iterator *) iterator;
+
+    if (!_iterator->current) {
+        return NULL;
+    }
+    if (data_sz) {
+        *data_sz = _iterator->current->data_sz;
+    }
+    return SYPHA_SKIPLIST_NODE_DATA(_iterator->current);
+}
+
+// Neighbours in the iterator's direction
+#define SYPHA_SKIPLIST_AHEAD(iterator, node)    (((iterator)->is_forward) ? (node)->next[0] : (node)->prev)
+#define SYPHA_SKIPLIST_BEHIND(iterator, node)   (((iterator)->is_forward) ? (node)->prev : (node)->next[0])
+
+int sypha_skiplist_iterator_next(SYPHA_SKIPLIST_ITERATOR iterator) {
+    struct _sypha_skiplist_iterator * _iterator = (struct _sypha_skiplist_iterator *) iterator;
+    struct _sypha_skiplist_node * node = (_iterator->current) ? SYPHA_SKIPLIST_AHEAD(_iterator, _iterator->current) : _iterator->pending;
+
+    if (!node) {
+        return -1;
+    }
+    _iterator->current = node;
+    return 0;
+}
+
+int sypha_skiplist_iterator_previous(SYPHA_SKIPLIST_ITERATOR iterator) {
+    struct _sypha_skiplist_iterator * _iterator = (struct _sypha_skiplist_iterator *) iterator;
+    struct _sypha_skiplist * skiplist = _iterator->skiplist;
+    struct _sypha_skiplist_node * node;
+
+    if (_iterator->current) {
+        node = SYPHA_SKIPLIST_BEHIND(_iterator, _iterator->current);
+    } else if (_iterator->pending) {
+        node = SYPHA_SKIPLIST_BEHIND(_iterator, _iterator->pending);
+    } else {
+        // Between the last item and the end
+        node = (_iterator->is_forward) ? skiplist->tail : skiplist->head[0];
+    }
+
+    if (!node) {
+        return -1;
+    }
+    _iterator->current = node;
+    return 0;
+}
+
+int sypha_skiplist_iterator_delete_current(SYPHA_SKIPLIST_ITERATOR iterator) {
+    struct _sypha_skiplist_iterator * _iterator = (struct _sypha_skiplist_iterator *) iterator;
+    struct _sypha_skiplist * skiplist = _iterator->skiplist;
+    struct _sypha_skiplist_node ** update[SYPHA_SKIPLIST_MAX_LEVEL];
+    struct _sypha_skiplist_node * node = _iterator->current;
+
+    if (!node) {
+        return -1;
+    }
+
+    _iterator->current = SYPHA_SKIPLIST_BEHIND(_iterator, node);
+    _iterator->pending = SYPHA_SKIPLIST_AHEAD(_iterator, node);
+
+    sypha_skiplist_search(skiplist, SYPHA_SKIPLIST_NODE_DATA(node), node->data_sz, 0, update);
+    sypha_skiplist_unlink(skiplist, node, update);
+    return 0;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,480 @@
+/* sypha_ulist.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <memory.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_ulist.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+// Target node size when the caller doesn't pick the element count
+#define SYPHA_ULIST_NODE_BYTES      256
+#define SYPHA_ULIST_MIN_NODE_ELEMS  4
+
+// Address of the i'th element in a node
+#define SYPHA_ULIST_ELEM(list, node, i)     ((node)->elems + (i) * (list)->elem_sz)
+
+// Nodes are never empty, a node is released as soon as its last element goes
+struct _sypha_ulist_node {
+    struct _sypha_ulist_node * prev;
+    struct _sypha_ulist_node * next;
+
+    size_t count;
+    unsigned char elems[];
+};
+
+struct _sypha_ulist {
+    size_t count;
+    size_t elem_sz;
+    size_t node_cap;
+    struct _sypha_ulist_node * first;
+    struct _sypha_ulist_node * last;
+
+    SYPHA_ALLOCATOR allocator;
+    // Iterators come from here, see sypha_arena_scratch_allocator
+    SYPHA_ALLOCATOR scratch_allocator;
+};
+
+// The current item is elems[index] of node
+struct _sypha_ulist_iterator {
+    struct _sypha_ulist * list;
+    struct _sypha_ulist_node * node;
+    size_t index;
+    unsigned int forward;
+    unsigned int is_pristine;
+};
+
+// Allocates an empty, unlinked node, returns NULL on allocation error
+static struct _sypha_ulist_node * sypha_ulist_node_create(struct _sypha_ulist * list) {
+    struct _sypha_ulist_node * node;
+    if (!(node = (struct _sypha_ulist_node *) sypha_alloc(&list->allocator, sizeof(struct _sypha_ulist_node) + list->node_cap * list->elem_sz))) {
+        return NULL;
+    }
+    node->prev = NULL;
+    node->next = NULL;
+    node->count = 0;
+    return node;
+}
+
+// Links node in after "after", NULL after means at the front
+static void sypha_ulist_node_link(struct _sypha_ulist * list, struct _sypha_ulist_node * after, struct _sypha_ulist_node * node) {
+    node->prev = after;
+    node->next = (after) ? after->next : list->first;
+    if (node->next) {
+        node->next->prev = node;
+    } else {
+        list->last = node;
+    }
+    if (after) {
+        after->next = node;
+    } else {
+        list->first = node;
+    }
+}
+
+static void sypha_ulist_node_unlink(struct _sypha_ulist * list, struct _sypha_ulist_node * node) {
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        list->first = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    } else {
+        list->last = node->prev;
+    }
+}
+
+// Inserts a copy of data at physical position pos (0 to count) of node, NULL node meaning an empty
+// list.  A full node spills into a neighbour with room or is split in half.  Keeps the iterator
+// (if any) on the same element and reports where the new element ended up.  Returns 0 if the item
+// was added, otherwise < 0.
+static int sypha_ulist_insert_at(struct _sypha_ulist * list, struct _sypha_ulist_node * node, size_t pos, void * data,
+        struct _sypha_ulist_iterator * iterator, struct _sypha_ulist_node ** at_node, size_t * at_index) {
+    struct _sypha_ulist_node * split;
+    size_t half;
+
+    if (!node) {
+        if (!(node = sypha_ulist_node_create(list))) {
+            return -1;
+        }
+        sypha_ulist_node_link(list, NULL, node);
+        pos = 0;
+    } else if (node->count == list->node_cap) {
+        if (pos == node->count && node->next && node->next->count < list->node_cap) {
+            // After the last element, same as in front of the next node's first
+            node = node->next;
+            pos = 0;
+        } else if (pos == 0 && node->prev && node->prev->count < list->node_cap) {
+            // Before the first element, same as after the previous node's last
+            node = node->prev;
+            pos = node->count;
+        } else {
+            if (!(split = sypha_ulist_node_create(list))) {
+                return -1;
+            }
+
+            if (pos == node->count) {
+                // Start a fresh node rather than splitting so appends leave full nodes behind
+                sypha_ulist_node_link(list, node, split);
+                node = split;
+                pos = 0;
+            } else if (pos == 0) {
+                sypha_ulist_node_link(list, node->prev, split);
+                node = split;
+            } else {
+                // Move the upper half into the new node
+                half = node->count / 2;
+                memcpy(split->elems, SYPHA_ULIST_ELEM(list, node, half), (node->count - half) * list->elem_sz);
+                split->count = node->count - half;
+                node->count = half;
+                sypha_ulist_node_link(list, node, split);
+
+                if (iterator && iterator->node == node && iterator->index >= half) {
+                    iterator->node = split;
+                    iterator->index -= half;
+                }
+
+                if (pos > half) {
+                    node = split;
+                    pos -= half;
+                }
+            }
+        }
+    }
+
+    memmove(SYPHA_ULIST_ELEM(list, node, pos + 1), SYPHA_ULIST_ELEM(list, node, pos), (node->count - pos) * list->elem_sz);
+    memcpy(SYPHA_ULIST_ELEM(list, node, pos), data, list->elem_sz);
+    node->count++;
+    list->count++;
+
+    if (iterator && iterator->node == node && iterator->index >= pos) {
+        iterator->index++;
+    }
+
+    if (at_node) {
+        *at_node = node;
+        *at_index = pos;
+    }
+
+    return 0;
+}
+
+SYPHA_ULIST sypha_ulist_create(size_t elem_sz, size_t elems_per_node) {
+    return sypha_ulist_create_with_allocator(NULL, elem_sz, elems_per_node);
+}
+
+SYPHA_ULIST sypha_ulist_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz, size_t elems_per_node) {
+    struct _sypha_ulist * list;
+
+    if (elem_sz == 0) {
+        return NULL;
+    }
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(list = (struct _sypha_ulist *) sypha_alloc(allocator, sizeof(struct _sypha_ulist)))) {
+        return NULL;
+    }
+    memset(list, 0x0, sizeof(struct _sypha_ulist));
+    list->allocator = *allocator;
+    sypha_arena_scratch_allocator(allocator, &list->scratch_allocator);
+    list->elem_sz = elem_sz;
+
+    if (!(list->node_cap = elems_per_node)) {
+        list->node_cap = (SYPHA_ULIST_NODE_BYTES - sizeof(struct _sypha_ulist_node)) / elem_sz;
+        if (list->node_cap < SYPHA_ULIST_MIN_NODE_ELEMS) {
+            list->node_cap = SYPHA_ULIST_MIN_NODE_ELEMS;
+        }
+    }
+
+    return (SYPHA_ULIST) list;
+}
+
+void sypha_ulist_destroy(SYPHA_ULIST list) {
+    struct _sypha_ulist * _list = (struct _sypha_ulist *) list;
+    if (!_list) {
+        return;
+    }
+
+    struct _sypha_ulist_node * node_next = NULL;
+    struct _sypha_ulist_node * node = _list->first;
+    while (node) {
+        node_next = node->next;
+        sypha_free(&_list->allocator, node);
+        node = node_next;
+    }
+
+    sypha_free(&_list->allocator, _list);
+}
+
+size_t sypha_ulist_count(SYPHA_ULIST list) {
+    return ((struct _sypha_ulist *) list)->count;
+}
+
+int sypha_ulist_append_item(SYPHA_ULIST list, void * data) {
+    struct _sypha_ulist * _list = (struct _sypha_ulist *) list;
+    return sypha_ulist_insert_at(_list, _list->last, (_list->last) ? _list->last->count : 0, data, NULL, NULL, NULL);
+}
+
+int sypha_ulist_prepend_item(SYPHA_ULIST list, void * data) {
+    struct _sypha_ulist * _list = (struct _sypha_ulist *) list;
+    return sypha_ulist_insert_at(_list, _list->first, 0, data, NULL, NULL, NULL);
+}
+
+SYPHA_ULIST_ITERATOR sypha_ulist_get_iterator_front(SYPHA_ULIST list) {
+    struct _sypha_ulist * _list = (struct _sypha_ulist *) list;
+    struct _sypha_ulist_iterator * iterator;
+    if (!(iterator = (struct _sypha_ulist_iterator *) sypha_alloc(&_list->scratch_allocator, sizeof(struct _sypha_ulist_iterator)))) {
+        return NULL;
+    }
+
+    iterator->list = _list;
+    iterator->node = _list->first;
+    iterator->index = 0;
+    iterator->forward = 1;
+    iterator->is_pristine = 1;
+
+    return (SYPHA_ULIST_ITERATOR) iterator;
+}
+
+SYPHA_ULIST_ITERATOR sypha_ulist_get_iterator_back(SYPHA_ULIST list) {
+    struct _sypha_ulist * _list = (struct _sypha_ulist *) list;
+    struct _sypha_ulist_iterator * iterator;
+    if (!(iterator = (struct _sypha_ulist_iterator *) sypha_alloc(&_list->scratch_allocator, sizeof(struct _sypha_ulist_iterator)))) {
+        return NULL;
+    }
+
+    iterator->list = _list;
+    iterator->node = _list->last;
+    iterator->index = (_list->last) ? _list->last->count - 1 : 0;
+    iterator->forward = 0;
+    iterator->is_pristine = 1;
+
+    return (SYPHA_ULIST_ITERATOR) iterator;
+}
+
+void sypha_ulist_destroy_iterator(SYPHA_ULIST_ITERATOR iterator) {
+    struct _sypha_ulist_iterator * _iterator = (struct _sypha_ulist_iterator *) iterator;
+    if (!_iterator) {
+        return;
+    }
+    sypha_free(&_iterator->list->scratch_allocator, _iterator);
+}
+
+void * sypha_ulist_iterator_get(SYPHA_ULIST_ITERATOR iterator) {
+    struct _sypha_ulist_iterator * _iterator = (struct _sypha_ulist_iterator *) iterator;
+
+    // Iterator not started OR empty list
+    if (_iterator->is_pristine || !_iterator->node) {
+        return NULL;
+    }
+
+    return SYPHA_ULIST_ELEM(_iterator->list, _iterator->node, _iterator->index);
+}
+
+int sypha_ulist_iterator_next(SYPHA_ULIST_ITERATOR iterator) {
+    struct _sypha_ulist_iterator * _iterator = (struct _sypha_ulist_iterator *) iterator;
+    struct _sypha_ulist_node * node = _iterator->node;
+
+    // Empty list case
+    if (!node) {
+        return -1;
+    }
+
+    // In the initial state so don't move and clense that state
+    if (_iterator->is_pristine) {
+        _iterator->is_pristine = 0;
+        return 0;
+    }
+
+    if (_iterator->forward) {
+        if (_iterator->index + 1 < node->count) {
+            _iterator->index++;
+        } else if (node->next) {
+            _iterator->node = node->next;
+            _iterator->index = 0;
+        } else {
+            return -1;
+        }
+    } else {
+        if (_iterator->index > 0) {
+            _iterator->index--;
+        } else if (node->prev) {
+            _iterator->node = node->prev;
+            _iterator->index = node->prev->count - 1;
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int sypha_ulist_iterator_previous(SYPHA_ULIST_ITERATOR iterator) {
+    struct _sypha_ulist_iterator * _iterator = (struct _sypha_ulist_iterator *) iterator;
+    struct _sypha_ulist_node * node = _iterator->node;
+
+    // Empty list case, and you can't move to the previous node from the initial state
+    if (!node || _iterator->is_pristine) {
+        return -1;
+    }
+
+    if (_iterator->forward) {
+        if (_iterator->index > 0) {
+            _iterator->index--;
+        } else if (node->prev) {
+            _iterator->node = node->prev;
+            _iterator->index = node->prev->count - 1;
+        } else {
+            return -1;
+        }
+    } else {
+        if (_iterator->index + 1 < node->count) {
+            _iterator->index++;
+        } else if (node->next) {
+            _iterator->node = node->next;
+            _iterator->index = 0;
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int sypha_ulist_iterator_insert_after(SYPHA_ULIST_ITERATOR iterator, void * data) {
+    struct _sypha_ulist_iterator * _iterator = (struct _sypha_ulist_iterator *) iterator;
+    struct _sypha_ulist * _list = _iterator->list;
+    struct _sypha_ulist_node * at_node;
+    size_t at_index;
+
+    // You can add an item from initial state since it is suppose to be one behind it.  So allow this
+    // and leave the initial state in tact so next() still has to be called.  Same goes for an
+    // iterator on an empty list.
+    if (_iterator->is_pristine || !_iterator->node) {
+        if (_iterator->forward) {
+            if (sypha_ulist_insert_at(_list, _list->first, 0, data, NULL, &at_node, &at_index) < 0) {
+                return -1;
+            }
+        } else {
+            if (sypha_ulist_insert_at(_list, _list->last, (_list->last) ? _list->last->count : 0, data, NULL, &at_node, &at_index) < 0) {
+                return -1;
+            }
+        }
+        _iterator->node = at_node;
+        _iterator->index = at_index;
+        return 0;
+    }
+
+    if (_iterator->forward) {
+        return sypha_ulist_insert_at(_list, _iterator->node, _iterator->index + 1, data, _iterator, NULL, NULL);
+    } else {
+        return sypha_ulist_insert_at(_list, _iterator->node, _iterator->index, data, _iterator, NULL, NULL);
+    }
+}
+
+int sypha_ulist_iterator_insert_before(SYPHA_ULIST_ITERATOR iterator, void * data) {
+    struct _sypha_ulist_iterator * _iterator = (struct _sypha_ulist_iterator *) iterator;
+    struct _sypha_ulist * _list = _iterator->list;
+
+    // Can't add anything from initial state.  Regardless of moving forward or backward, the iterator
+    // is intially positioned "before" a first item so adding BEFORE THAT doesn't make sense.
+    if (_iterator->is_pristine || !_iterator->node) {
+        return -1;
+    }
+
+    if (_iterator->forward) {
+        return sypha_ulist_insert_at(_list, _iterator->node, _iterator->index, data, _iterator, NULL, NULL);
+    } else {
+        return sypha_ulist_insert_at(_list, _iterator->node, _iterator->index + 1, data, _iterator, NULL, NULL);
+    }
+}
+
+int sypha_ulist_iterator_delete_current(SYPHA_ULIST_ITERATOR iterator) {
+    struct _sypha_ulist_iterator * _iterator = (struct _sypha_ulist_iterator *) iterator;
+    struct _sypha_ulist * _list = _iterator->list;
+    struct _sypha_ulist_node * node = _iterator->node;
+    struct _sypha_ulist_node * next;
+    size_t index = _iterator->index;
+
+    // Can't remove anything from initial state, or an empty list
+    if (_iterator->is_pristine || !node) {
+        return -1;
+    }
+
+    memmove(SYPHA_ULIST_ELEM(_list, node, index), SYPHA_ULIST_ELEM(_list, node, index + 1), (node->count - index - 1) * _list->elem_sz);
+    node->count--;
+    _list->count--;
+
+    // Reposition to the "previous" item from the iterator's perspective.  If there isn't one
+    // then we deleted the head of the iteration so go back to the initial state in front of
+    // the new head.
+    if (_iterator->forward) {
+        if (index > 0) {
+            _iterator->index = index - 1;
+        } else if (node->prev) {
+            _iterator->node = node->prev;
+            _iterator->index = node->prev->count - 1;
+        } else {
+            _iterator->node = (node->count) ? node : node->next;
+            _iterator->index = 0;
+            _iterator->is_pristine = 1;
+        }
+    } else if (index == node->count) {
+        // Otherwise the physical next item has slid into place which is all we need
+        if (node->next) {
+            _iterator->node = node->next;
+            _iterator->index = 0;
+        } else {
+            if (node->count) {
+                _iterator->index = node->count - 1;
+            } else {
+                _iterator->node = node->prev;
+                _iterator->index = (node->prev) ? node->prev->count - 1 : 0;
+            }
+            _iterator->is_pristine = 1;
+        }
+    }
+
+    if (!node->count) {
+        sypha_ulist_node_unlink(_list, node);
+        sypha_free(&_list->allocator, node);
+    } else if ((next = node->next) && node->count + next->count <= _list->node_cap / 2) {
+        // Fold a sparse neighbour back in so scans don't degrade into a pointer chase
+        memcpy(SYPHA_ULIST_ELEM(_list, node, node->count), next->elems, next->count * _list->elem_sz);
+        if (_iterator->node == next) {
+            _iterator->node = node;
+            _iterator->index += node->count;
+        }
+        node->count += next->count;
+        sypha_ulist_node_unlink(_list, next);
+        sypha_free(&_list->allocator, next);
+    }
+
+    return 0;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,403 @@
+/* sypha_vec.c
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <memory.h>
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_vec.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // __cplusplus
+
+// Room the first growth makes
+#define SYPHA_VEC_MIN_CAPACITY  16
+
+// Address of the i'th element
+#define SYPHA_VEC_ELEM(vec, i)  ((vec)->elems + (i) * (vec)->elem_sz)
+
+struct _sypha_vec {
+    size_t count;
+    size_t capacity;
+    size_t elem_sz;
+    unsigned char * elems;
+
+    SYPHA_ALLOCATOR allocator;
+    // Iterators come from here, see sypha_arena_scratch_allocator
+    SYPHA_ALLOCATOR scratch_allocator;
+};
+
+// The current item is elems[index], meaningless while index >= count
+struct _sypha_vec_iterator {
+    struct _sypha_vec * vec;
+    size_t index;
+    unsigned int forward;
+    unsigned int is_pristine;
+};
+
+// Sets the room to exactly capacity elements, returns 0 on success, otherwise < 0
+static int sypha_vec_resize(struct _sypha_vec * vec, size_t capacity) {
+    unsigned char * elems;
+
+    if (capacity > ((size_t) -1) / vec->elem_sz) {
+        return -1;
+    }
+
+    if (capacity == 0) {
+        sypha_free(&vec->allocator, vec->elems);
+        vec->elems = NULL;
+    } else {
+        if (!(elems = (unsigned char *) sypha_realloc(&vec->allocator, vec->elems, capacity * vec->elem_sz))) {
+            return -1;
+        }
+        vec->elems = elems;
+    }
+    vec->capacity = capacity;
+    return 0;
+}
+
+// Makes room for count more elements, doubling so appends stay amortized O(1)
+static int sypha_vec_grow(struct _sypha_vec * vec, size_t count) {
+    size_t capacity;
+
+    if (count > ((size_t) -1) - vec->count) {
+        return -1;
+    }
+    if (vec->count + count <= vec->capacity) {
+        return 0;
+    }
+
+    capacity = (vec->capacity) ? vec->capacity : SYPHA_VEC_MIN_CAPACITY;
+    while (capacity < vec->count + count) {
+        capacity = (capacity > ((size_t) -1) / 2) ? vec->count + count : capacity * 2;
+    }
+    return sypha_vec_resize(vec, capacity);
+}
+
+// Inserts a copy of data at index (0 to count), returns 0 if the item was added, otherwise < 0
+static int sypha_vec_insert_at(struct _sypha_vec * vec, size_t index, void * data) {
+    if (sypha_vec_grow(vec, 1) < 0) {
+        return -1;
+    }
+
+    memmove(SYPHA_VEC_ELEM(vec, index + 1), SYPHA_VEC_ELEM(vec, index), (vec->count - index) * vec->elem_sz);
+    memcpy(SYPHA_VEC_ELEM(vec, index), data, vec->elem_sz);
+    vec->count++;
+    return 0;
+}
+
+SYPHA_VEC sypha_vec_create(size_t elem_sz) {
+    return sypha_vec_create_with_allocator(NULL, elem_sz);
+}
+
+SYPHA_VEC sypha_vec_create_with_allocator(const SYPHA_ALLOCATOR * allocator, size_t elem_sz) {
+    struct _sypha_vec * vec;
+
+    if (elem_sz == 0) {
+        return NULL;
+    }
+
+    if (!allocator) {
+        allocator = sypha_allocator_get_default();
+    }
+
+    if (!(vec = (struct _sypha_vec *) sypha_alloc(allocator, sizeof(struct _sypha_vec)))) {
+        return NULL;
+    }
+    memset(vec, 0x0, sizeof(struct _sypha_vec));
+    vec->allocator = *allocator;
+    sypha_arena_scratch_allocator(allocator, &vec->scratch_allocator);
+    vec->elem_sz = elem_sz;
+
+    return (SYPHA_VEC) vec;
+}
+
+void sypha_vec_destroy(SYPHA_VEC vec) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+    if (!_vec) {
+        return;
+    }
+
+    sypha_free(&_vec->allocator, _vec->elems);
+    sypha_free(&_vec->allocator, _vec);
+}
+
+size_t sypha_vec_count(SYPHA_VEC vec) {
+    return ((struct _sypha_vec *) vec)->count;
+}
+
+size_t sypha_vec_capacity(SYPHA_VEC vec) {
+    return ((struct _sypha_vec *) vec)->capacity;
+}
+
+int sypha_vec_reserve(SYPHA_VEC vec, size_t count) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+
+    if (count <= _vec->capacity) {
+        return 0;
+    }
+    return sypha_vec_resize(_vec, count);
+}
+
+int sypha_vec_shrink(SYPHA_VEC vec) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+
+    if (_vec->count == _vec->capacity) {
+        return 0;
+    }
+    return sypha_vec_resize(_vec, _vec->count);
+}
+
+void sypha_vec_clear(SYPHA_VEC vec) {
+    ((struct _sypha_vec *) vec)->count = 0;
+}
+
+void * sypha_vec_data(SYPHA_VEC vec) {
+    return ((struct _sypha_vec *) vec)->elems;
+}
+
+void * sypha_vec_get(SYPHA_VEC vec, size_t index) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+    return (index < _vec->count) ? SYPHA_VEC_ELEM(_vec, index) : NULL;
+}
+
+int sypha_vec_append_item(SYPHA_VEC vec, void * data) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+
+    if (sypha_vec_grow(_vec, 1) < 0) {
+        return -1;
+    }
+    memcpy(SYPHA_VEC_ELEM(_vec, _vec->count), data, _vec->elem_sz);
+    _vec->count++;
+    return 0;
+}
+
+int sypha_vec_prepend_item(SYPHA_VEC vec, void * data) {
+    return sypha_vec_insert_at((struct _sypha_vec *) vec, 0, data);
+}
+
+int sypha_vec_append_many(SYPHA_VEC vec, const void * base, size_t count) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+
+    if (count == 0) {
+        return 0;
+    }
+    if (sypha_vec_grow(_vec, count) < 0) {
+        return -1;
+    }
+    memcpy(SYPHA_VEC_ELEM(_vec, _vec->count), base, count * _vec->elem_sz);
+    _vec->count += count;
+    return 0;
+}
+
+SYPHA_VEC_ITERATOR sypha_vec_get_iterator_front(SYPHA_VEC vec) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+    struct _sypha_vec_iterator * iterator;
+    if (!(iterator = (struct _sypha_vec_iterator *) sypha_alloc(&_vec->scratch_allocator, sizeof(struct _sypha_vec_iterator)))) {
+        return NULL;
+    }
+
+    iterator->vec = _vec;
+    iterator->index = 0;
+    iterator->forward = 1;
+    iterator->is_pristine = 1;
+
+    return (SYPHA_VEC_ITERATOR) iterator;
+}
+
+SYPHA_VEC_ITERATOR sypha_vec_get_iterator_back(SYPHA_VEC vec) {
+    struct _sypha_vec * _vec = (struct _sypha_vec *) vec;
+    struct _sypha_vec_iterator * iterator;
+    if (!(iterator = (struct _sypha_vec_iterator *) sypha_alloc(&_vec->scratch_allocator, sizeof(struct _sypha_vec_iterator)))) {
+        return NULL;
+    }
+
+    iterator->vec = _vec;
+    iterator->index = (_vec->count) ? _vec->count - 1 : 0;
+    iterator->forward = 0;
+    iterator->is_pristine = 1;
+
+    return (SYPHA_VEC_ITERATOR) iterator;
+}
+
+void sypha_vec_destroy_iterator(SYPHA_VEC_ITERATOR iterator) {
+    struct _sypha_vec_iterator * _iterator = (struct _sypha_vec_iterator *) iterator;
+    if (!_iterator) {
+        return;
+    }
+    sypha_free(&_iterator->vec->scratch_allocator, _iterator);
+}
+
+void * sypha_vec_iterator_get(SYPHA_VEC_ITERATOR iterator, size_t * data_sz) {
+    struct _sypha_vec_iterator * _iterator = (struct _sypha_vec_iterator *) iterator;
+    struct _sypha_vec * _vec = _iterator->vec;
+
+    // Iterator not started OR empty vector
+    if (_iterator->is_pristine || _iterator->index >= _vec->count) {
+        return NULL;
+    }
+
+    if (data_sz) {
+        *data_sz = _vec->elem_sz;
+    }
+    return SYPHA_VEC_ELEM(_vec, _iterator->index);
+}
+
+int sypha_vec_iterator_next(SYPHA_VEC_ITERATOR iterator) {
+    struct _sypha_vec_iterator * _iterator = (struct _sypha_vec_iterator *) iterator;
+    struct _sypha_vec * _vec = _iterator->vec;
+
+    // Empty vector case
+    if (_iterator->index >= _vec->count) {
+        return -1;
+    }
+
+    // In the initial state so don't move and clense that state
+    if (_iterator->is_pristine) {
+        _iterator->is_pristine = 0;
+        return 0;
+    }
+
+    if (_iterator->forward) {
+        if (_iterator->index + 1 >= _vec->count) {
+            return -1;
+        }
+        _iterator->index++;
+    } else {
+        if (_iterator->index == 0) {
+            return -1;
+        }
+        _iterator->index--;
+    }
+
+    return 0;
+}
+
+int sypha_vec_iterator_previous(SYPHA_VEC_ITERATOR iterator) {
+    struct _sypha_vec_iterator * _iterator = (struct _sypha_vec_iterator *) iterator;
+    struct _sypha_vec * _vec = _iterator->vec;
+
+    // Empty vector case, and you can't move to the previous item from the initial state
+    if (_iterator->index >= _vec->count || _iterator->is_pristine) {
+        return -1;
+    }
+
+    if (_iterator->forward) {
+        if (_iterator->index == 0) {
+            return -1;
+        }
+        _iterator->index--;
+    } else {
+        if (_iterator->index + 1 >= _vec->count) {
+            return -1;
+        }
+        _iterator->index++;
+    }
+
+    return 0;
+}
+
+int sypha_vec_iterator_insert_after(SYPHA_VEC_ITERATOR iterator, void * data) {
+    struct _sypha_vec_iterator * _iterator = (struct _sypha_vec_iterator *) iterator;
+    struct _sypha_vec * _vec = _iterator->vec;
+
+    // You can add an item from initial state since it is suppose to be one behind it.  So allow this
+    // and leave the initial state in tact so next() still has to be called.  Same goes for an
+    // iterator on an empty vector.
+    if (_iterator->is_pristine || _iterator->index >= _vec->count) {
+        if (_iterator->forward) {
+            if (sypha_vec_insert_at(_vec, 0, data) < 0) {
+                return -1;
+            }
+            _iterator->index = 0;
+        } else {
+            if (sypha_vec_insert_at(_vec, _vec->count, data) < 0) {
+                return -1;
+            }
+            _iterator->index = _vec->count - 1;
+        }
+        return 0;
+    }
+
+    if (_iterator->forward) {
+        return sypha_vec_insert_at(_vec, _iterator->index + 1, data);
+    }
+
+    // Going backward "after" is physically in front, which pushes the current item up one
+    if (sypha_vec_insert_at(_vec, _iterator->index, data) < 0) {
+        return -1;
+    }
+    _iterator->index++;
+    return 0;
+}
+
+int sypha_vec_iterator_insert_before(SYPHA_VEC_ITERATOR iterator, void * data) {
+    struct _sypha_vec_iterator * _iterator = (struct _sypha_vec_iterator *) iterator;
+    struct _sypha_vec * _vec = _iterator->vec;
+
+    // Can't add anything from initial state.  Regardless of moving forward or backward, the iterator
+    // is intially positioned "before" a first item so adding BEFORE THAT doesn't make sense.
+    if (_iterator->is_pristine || _iterator->index >= _vec->count) {
+        return -1;
+    }
+
+    if (!_iterator->forward) {
+        return sypha_vec_insert_at(_vec, _iterator->index + 1, data);
+    }
+
+    if (sypha_vec_insert_at(_vec, _iterator->index, data) < 0) {
+        return -1;
+    }
+    _iterator->index++;
+    return 0;
+}
+
+int sypha_vec_iterator_delete_current(SYPHA_VEC_ITERATOR iterator) {
+    struct _sypha_vec_iterator * _iterator = (struct _sypha_vec_iterator *) iterator;
+    struct _sypha_vec * _vec = _iterator->vec;
+    size_t index = _iterator->index;
+
+    // Can't remove anything from initial state, or an empty vector
+    if (_iterator->is_pristine || index >= _vec->count) {
+        return -1;
+    }
+
+    memmove(SYPHA_VEC_ELEM(_vec, index), SYPHA_VEC_ELEM(_vec, index + 1), (_vec->count - index - 1) * _vec->elem_sz);
+    _vec->count--;
+
+    // Reposition to the "previous" item from the iterator's perspective.  If there isn't one
+    // then we deleted the head of the iteration so go back to the initial state in front of
+    // the new head.
+    if (_iterator->forward) {
+        if (index > 0) {
+            _iterator->index = index - 1;
+        } else {
+            _iterator->is_pristine = 1;
+        }
+    } else if (index == _vec->count) {
+        // Otherwise the physical next item has slid into place which is all we need
+        _iterator->index = (index) ? index - 1 : 0;
+        _iterator->is_pristine = 1;
+    }
+
+    return 0;
+}
+
+#if defined(__cplusplus)
+}
+#endif // __cplusplus
@@ -0,0 +1,258 @@
+/* test_alloc.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "doctest.h"
+#include "syphac/sypha_alloc.h"
+#include "syphac/sypha_list.h"
+#include "syphac/sypha_opt.h"
+
+#define ARG_MAX_LEN     64
+#define ARG_COUNT_MAX   16
+
+// Counts live blocks so we can tell everything went through the allocator and came back
+struct counting_ctx {
+    long allocs;
+    long frees;
+    long fail_at;       // the allocation number to fail, 0 for never
+};
+
+static void * counting_alloc(void * ctx, size_t sz) {
+    struct counting_ctx * _ctx = (struct counting_ctx *) ctx;
+    if (_ctx->fail_at && _ctx->allocs + 1 == _ctx->fail_at) {
+        return NULL;
+    }
+    _ctx->allocs++;
+    return malloc(sz);
+}
+
+static void * counting_realloc(void * ctx, void * ptr, size_t sz) {
+    if (!ptr) {
+        ((struct counting_ctx *) ctx)->allocs++;
+    }
+    return realloc(ptr, sz);
+}
+
+static void counting_free(void * ctx, void * ptr) {
+    if (ptr) {
+        ((struct counting_ctx *) ctx)->frees++;
+    }
+    free(ptr);
+}
+
+TEST_CASE("Allocator") {
+    struct counting_ctx ctx = { 0, 0, 0 };
+    SYPHA_ALLOCATOR allocator = { counting_alloc, counting_realloc, counting_free, &ctx };
+
+    SUBCASE("List with allocator") {
+        SYPHA_LIST list = sypha_list_create_with_allocator(&allocator);
+        REQUIRE(list != NULL);
+
+        for (unsigned long long i=0;i < 50; i++) {
+            sypha_list_append_item(list, (void *) &i, sizeof(unsigned long long));
+        }
+        CHECK_EQ(ctx.allocs, 51);
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+        sypha_list_destroy_iterator(iterator);
+
+        sypha_list_destroy(list);
+        CHECK_GT(ctx.allocs, 51);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Pooled list with allocator") {
+        SYPHA_LIST list = sypha_list_create_pooled_with_allocator(&allocator, sizeof(unsigned long long), 16);
+        REQUIRE(list != NULL);
+
+        for (unsigned long long i=0;i < 50; i++) {
+            sypha_list_append_item(list, (void *) &i, sizeof(unsigned long long));
+        }
+
+        // list + 4 slabs
+        CHECK_EQ(ctx.allocs, 5);
+
+        sypha_list_destroy(list);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Bulk insert with allocator") {
+        static unsigned long long values[10000];
+        SYPHA_LIST list = sypha_list_create_with_allocator(&allocator);
+        REQUIRE(list != NULL);
+
+        CHECK_EQ(sypha_list_append_many(list, values, sizeof(values[0]), 10000), 0);
+        CHECK_LT(ctx.allocs, 20);
+
+        // fail part way into a batch, whatever it got so far is handed back
+        long allocs = ctx.allocs;
+        ctx.fail_at = ctx.allocs + 3;
+        CHECK_LT(sypha_list_prepend_many(list, values, sizeof(values[0]), 10000), 0);
+        CHECK_EQ(ctx.allocs, allocs + 2);
+        CHECK_EQ(ctx.frees, 2);
+        ctx.fail_at = 0;
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        size_t count = 0;
+        while (sypha_list_iterator_next(iterator) == 0) {
+            count++;
+        }
+        CHECK_EQ(count, 10000);
+        sypha_list_destroy_iterator(iterator);
+
+        sypha_list_destroy(list);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Batch blocks go with their last item") {
+        static unsigned long long values[5000];
+        SYPHA_LIST list = sypha_list_create_with_allocator(&allocator);
+        REQUIRE(list != NULL);
+
+        // used as a queue: batches in at the back, single deletes off the front
+        for (int round=0;round < 20;round++) {
+            CHECK_EQ(sypha_list_append_many(list, values, sizeof(values[0]), 5000), 0);
+            CHECK_GT(ctx.allocs - ctx.frees, 2);
+            SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+            for (int i=0;i < 5000;i++) {
+                REQUIRE_EQ(sypha_list_iterator_next(iterator), 0);
+                REQUIRE_EQ(sypha_list_iterator_delete_current(iterator), 0);
+            }
+            sypha_list_destroy_iterator(iterator);
+
+            // drained, nothing but the list itself is left
+            CHECK_EQ(ctx.allocs - ctx.frees, 1);
+        }
+
+        sypha_list_destroy(list);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Splice and split relink slab items") {
+        static unsigned long long values[1000];
+        SYPHA_LIST src = sypha_list_create_pooled_with_allocator(&allocator, sizeof(unsigned long long), 16);
+        SYPHA_LIST dst = sypha_list_create_with_allocator(&allocator);
+        REQUIRE(src != NULL);
+        REQUIRE(dst != NULL);
+
+        for (unsigned long long i=0;i < 100; i++) {
+            sypha_list_append_item(src, (void *) &i, sizeof(unsigned long long));
+        }
+        CHECK_EQ(sypha_list_append_many(src, values, sizeof(values[0]), 1000), 0);
+        CHECK_EQ(sypha_list_append_many(dst, values, sizeof(values[0]), 1000), 0);
+        long allocs = ctx.allocs;
+
+        // only the iterators and the split off list itself are allocated
+        SYPHA_LIST_ITERATOR dst_iterator = sypha_list_get_iterator_front(dst);
+        CHECK_EQ(sypha_list_splice(dst_iterator, src, NULL, NULL), 0);
+        CHECK_EQ(ctx.allocs, allocs + 1);
+        CHECK_EQ(sypha_list_iterator_next(dst_iterator), 0);
+        SYPHA_LIST split = sypha_list_split_at(dst_iterator);
+        REQUIRE(split != NULL);
+        CHECK_EQ(ctx.allocs, allocs + 2);
+        sypha_list_destroy_iterator(dst_iterator);
+
+        // the slabs stay with whichever list has their last item
+        sypha_list_destroy(src);
+        sypha_list_destroy(split);
+        CHECK_GT(ctx.allocs - ctx.frees, 1);
+        sypha_list_destroy(dst);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Concat lists with different allocators") {
+        SYPHA_LIST dst = sypha_list_create_with_allocator(&allocator);
+        SYPHA_LIST src = sypha_list_create();
+        REQUIRE(dst != NULL);
+
+        for (unsigned long long i=0;i < 50; i++) {
+            sypha_list_append_item(src, (void *) &i, sizeof(unsigned long long));
+        }
+        CHECK_EQ(sypha_list_concat(dst, src), 0);
+        sypha_list_destroy(src);
+
+        // every item was copied into the counting allocator
+        CHECK_EQ(ctx.allocs, 51);
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(dst);
+        size_t value_sz;
+        for (unsigned long long i=0;i < 50; i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            CHECK_EQ(*((unsigned long long *) sypha_list_iterator_get(iterator, &value_sz)), i);
+        }
+        sypha_list_destroy_iterator(iterator);
+
+        sypha_list_destroy(dst);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Opt config and parse result with allocator") {
+        char * argv[ARG_COUNT_MAX];
+        for (int i=0;i < ARG_COUNT_MAX; i++) {
+            argv[i] = (char *) malloc(sizeof(char) * ARG_MAX_LEN);
+            *(argv[i]) = '\0';
+        }
+        strcpy(argv[0], "my_program");
+        strcpy(argv[1], "-h");
+        strcpy(argv[2], "localhost");
+        strcpy(argv[3], "extra");
+        int argc = 4;
+
+        SYPHA_OPT_CONFIG opt_config;
+        REQUIRE((opt_config = sypha_opt_config_create(&allocator)) != NULL);
+        CHECK(sypha_opt_config_add_param(opt_config, "-h", "--host", 0, 1) == opt_config);
+        CHECK(sypha_opt_config_add_param(opt_config, "-f", "--force", 1, 0) == opt_config);
+        long config_allocs = ctx.allocs;
+        CHECK_EQ(config_allocs, 7);
+
+        SYPHA_OPT_PARSE_RESULT opt_parse_result = sypha_opt_parse_args(opt_config, argc, argv);
+        REQUIRE(opt_parse_result != NULL);
+        CHECK_GT(ctx.allocs, config_allocs);
+        CHECK_EQ(strcmp(sypha_opt_parse_get_value(opt_parse_result, "--host"), "localhost"), 0);
+        CHECK_EQ(strcmp(sypha_opt_parse_get_extras(opt_parse_result)[0], "extra"), 0);
+
+        sypha_opt_parse_free(opt_parse_result);
+        sypha_opt_config_free(opt_config);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+
+        for (int i = 0; i < ARG_COUNT_MAX; i++) {
+            free(argv[i]);
+        }
+    }
+
+    SUBCASE("Default allocator") {
+        sypha_allocator_set_default(&allocator);
+        CHECK(sypha_allocator_get_default()->ctx == &ctx);
+
+        SYPHA_LIST list = sypha_list_create();
+        REQUIRE(list != NULL);
+
+        // Restoring the default doesn't change an existing list's allocator
+        sypha_allocator_set_default(NULL);
+        CHECK(sypha_allocator_get_default()->ctx == NULL);
+
+        const char * token = "foo";
+        sypha_list_append_item(list, (void *) token, strlen(token) + 1);
+        CHECK_EQ(ctx.allocs, 2);
+
+        sypha_list_destroy(list);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+}
@@ -0,0 +1,439 @@
+/* test_arena.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_arena.h"
+#include "syphac/sypha_clist.h"
+#include "syphac/sypha_list.h"
+#include "syphac/sypha_map.h"
+#include "syphac/sypha_skiplist.h"
+#include "syphac/sypha_ulist.h"
+#include "syphac/sypha_vec.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Counts what the arena asks of its backing allocator
+struct chunk_count_ctx {
+    long allocs;
+    long frees;
+};
+
+static void * chunk_count_alloc(void * ctx, size_t sz) {
+    ((struct chunk_count_ctx *) ctx)->allocs++;
+    return malloc(sz);
+}
+
+static void * chunk_count_realloc(void * ctx, void * ptr, size_t sz) {
+    if (!ptr) {
+        ((struct chunk_count_ctx *) ctx)->allocs++;
+    }
+    return realloc(ptr, sz);
+}
+
+static void chunk_count_free(void * ctx, void * ptr) {
+    if (ptr) {
+        ((struct chunk_count_ctx *) ctx)->frees++;
+    }
+    free(ptr);
+}
+
+static int cmp_int(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+    return *((const int *) a) - *((const int *) b);
+}
+
+static void count_destructor(void * data, size_t data_sz, void * ctx) {
+    (*((int *) ctx))++;
+}
+
+// Fills list with 0..count-1 and walks it back
+static void fill_and_check(SYPHA_LIST list, int count) {
+    SYPHA_LIST_ITERATOR iterator;
+    size_t value_sz;
+    int expected = 0;
+
+    for (int i=0;i < count;i++) {
+        sypha_list_append_item(list, &i, sizeof(i));
+    }
+
+    iterator = sypha_list_get_read_iterator_front(list);
+    REQUIRE(iterator != NULL);
+    while (sypha_list_iterator_next(iterator) == 0) {
+        CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &value_sz)), expected++);
+    }
+    sypha_list_destroy_iterator(iterator);
+    CHECK_EQ(expected, count);
+}
+
+TEST_CASE("Arena") {
+    struct chunk_count_ctx ctx = { 0, 0 };
+    SYPHA_ALLOCATOR allocator = { chunk_count_alloc, chunk_count_realloc, chunk_count_free, &ctx };
+
+    SUBCASE("Aligned blocks out of shared chunks") {
+        SYPHA_ARENA arena = sypha_arena_create_with_allocator(&allocator, 4096);
+        REQUIRE(arena != NULL);
+
+        char * prev = NULL;
+        for (size_t sz=1;sz < 200;sz++) {
+            char * block = (char *) sypha_arena_alloc(arena, sz);
+            REQUIRE(block != NULL);
+            CHECK_EQ(((uintptr_t) block) % 16, 0);
+            memset(block, (int) sz, sz);
+            if (prev) {
+                CHECK_EQ((unsigned char) prev[0], (unsigned char) (sz - 1));
+            }
+            prev = block;
+        }
+        // 200 blocks of up to 208 bytes need a handful of 4KB chunks, not one each
+        CHECK_LT(ctx.allocs, 15);
+
+        sypha_arena_destroy(arena);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Reset reuses chunks") {
+        SYPHA_ARENA arena = sypha_arena_create_with_allocator(&allocator, 4096);
+        REQUIRE(arena != NULL);
+
+        for (int i=0;i < 1000;i++) {
+            REQUIRE(sypha_arena_alloc(arena, 64) != NULL);
+        }
+        long warm = ctx.allocs;
+
+        for (int round=0;round < 10;round++) {
+            sypha_arena_reset(arena);
+            for (int i=0;i < 1000;i++) {
+                REQUIRE(sypha_arena_alloc(arena, 64) != NULL);
+            }
+        }
+        CHECK_EQ(ctx.allocs, warm);
+        CHECK_EQ(ctx.frees, 0);
+
+        sypha_arena_destroy(arena);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Oversized blocks") {
+        SYPHA_ARENA arena = sypha_arena_create_with_allocator(&allocator, 4096);
+        REQUIRE(arena != NULL);
+
+        char * small = (char *) sypha_arena_alloc(arena, 16);
+        char * big = (char *) sypha_arena_alloc(arena, 100000);
+        REQUIRE(small != NULL);
+        REQUIRE(big != NULL);
+        CHECK_EQ(((uintptr_t) big) % 16, 0);
+        memset(big, 0x5a, 100000);
+        // the current chunk is still the one being used
+        CHECK_EQ((char *) sypha_arena_alloc(arena, 16), small + 16);
+
+        sypha_arena_reset(arena);
+        CHECK_EQ(ctx.frees, 1);
+        CHECK_EQ((char *) sypha_arena_alloc(arena, 16), small);
+
+        sypha_arena_destroy(arena);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Mark and rewind") {
+        SYPHA_ARENA arena = sypha_arena_create_with_allocator(&allocator, 4096);
+        REQUIRE(arena != NULL);
+
+        int * keep = (int *) sypha_arena_alloc(arena, sizeof(int));
+        REQUIRE(keep != NULL);
+        *keep = 42;
+
+        SYPHA_ARENA_MARK mark = sypha_arena_mark(arena);
+        void * first = sypha_arena_alloc(arena, 32);
+        for (int i=0;i < 500;i++) {
+            REQUIRE(sypha_arena_alloc(arena, 32) != NULL);
+        }
+        REQUIRE(sypha_arena_alloc(arena, 10000) != NULL);
+        long warm = ctx.allocs;
+
+        sypha_arena_rewind(arena, mark);
+        CHECK_EQ(*keep, 42);
+        CHECK_EQ(sypha_arena_alloc(arena, 32), first);
+        for (int i=0;i < 500;i++) {
+            REQUIRE(sypha_arena_alloc(arena, 32) != NULL);
+        }
+        CHECK_EQ(ctx.allocs, warm);
+        CHECK_EQ(*keep, 42);
+
+        sypha_arena_destroy(arena);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Allocator") {
+        SYPHA_ARENA arena = sypha_arena_create(0);
+        SYPHA_ALLOCATOR arena_allocator;
+        REQUIRE(arena != NULL);
+
+        sypha_arena_get_allocator(arena, &arena_allocator);
+        CHECK(sypha_arena_from_allocator(&arena_allocator) == arena);
+        CHECK(sypha_arena_from_allocator(&allocator) == NULL);
+        CHECK(sypha_arena_from_allocator(sypha_allocator_get_default()) == NULL);
+
+        // blocks from alloc can be resized too
+        char * block = (char *) sypha_alloc(&arena_allocator, 100);
+        REQUIRE(block != NULL);
+        memset(block, 0x3c, 100);
+        REQUIRE(sypha_alloc(&arena_allocator, 16) != NULL);
+        char * resized = (char *) sypha_realloc(&arena_allocator, block, 300);
+        REQUIRE(resized != NULL);
+        for (int i=0;i < 100;i++) {
+            CHECK_EQ(resized[i], 0x3c);
+        }
+        sypha_free(&arena_allocator, resized);
+
+        // the last block grows in place, others move with their contents
+        char * grown = (char *) sypha_realloc(&arena_allocator, NULL, 100);
+        REQUIRE(grown != NULL);
+        memset(grown, 0x5a, 100);
+        CHECK(sypha_realloc(&arena_allocator, grown, 50) == grown);
+        CHECK(sypha_realloc(&arena_allocator, grown, 1000) == grown);
+        REQUIRE(sypha_alloc(&arena_allocator, 16) != NULL);
+        char * moved = (char *) sypha_realloc(&arena_allocator, grown, 2000);
+        REQUIRE(moved != NULL);
+        CHECK(moved != grown);
+        CHECK_EQ(((uintptr_t) moved) % 16, 0);
+        for (int i=0;i < 100;i++) {
+            CHECK_EQ(moved[i], 0x5a);
+        }
+
+        sypha_arena_destroy(arena);
+    }
+}
+
+TEST_CASE("Lists in arenas") {
+    struct chunk_count_ctx ctx = { 0, 0 };
+    SYPHA_ALLOCATOR allocator = { chunk_count_alloc, chunk_count_realloc, chunk_count_free, &ctx };
+
+    SUBCASE("List owned arena") {
+        SYPHA_LIST list = sypha_list_create_in_arena(NULL);
+        REQUIRE(list != NULL);
+
+        fill_and_check(list, 10000);
+        CHECK_EQ(sypha_list_clear(list), 0);
+        fill_and_check(list, 0);
+        fill_and_check(list, 20000);
+
+        // clearing has to wait for iterators to go
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_read_iterator_front(list);
+        REQUIRE(iterator != NULL);
+        CHECK_LT(sypha_list_clear(list), 0);
+        sypha_list_destroy_iterator(iterator);
+        CHECK_EQ(sypha_list_clear(list), 0);
+
+        sypha_list_destroy(list);
+    }
+
+    SUBCASE("Steady state allocates nothing") {
+        SYPHA_ARENA arena = sypha_arena_create_with_allocator(&allocator, 0);
+        REQUIRE(arena != NULL);
+
+        SYPHA_LIST list = sypha_list_create_in_arena(arena);
+        REQUIRE(list != NULL);
+        fill_and_check(list, 5000);
+        sypha_list_destroy(list);
+        sypha_arena_reset(arena);
+        long warm = ctx.allocs;
+
+        for (int round=0;round < 10;round++) {
+            list = sypha_list_create_in_arena(arena);
+            REQUIRE(list != NULL);
+            fill_and_check(list, 5000);
+            sypha_list_destroy(list);
+            sypha_arena_reset(arena);
+        }
+        CHECK_EQ(ctx.allocs, warm);
+        CHECK_EQ(ctx.frees, 0);
+
+        sypha_arena_destroy(arena);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Iterators and scratch don't pile up in the arena") {
+        SYPHA_ARENA arena = sypha_arena_create_with_allocator(&allocator, 0);
+        REQUIRE(arena != NULL);
+        SYPHA_LIST list = sypha_list_create_in_arena(arena);
+        REQUIRE(list != NULL);
+        fill_and_check(list, 100);
+        long warm = ctx.allocs;
+
+        for (int i=0;i < 100000;i++) {
+            SYPHA_LIST_ITERATOR iterator = sypha_list_get_read_iterator_front(list);
+            REQUIRE(iterator != NULL);
+            sypha_list_destroy_iterator(iterator);
+        }
+        CHECK_EQ(ctx.allocs, warm);
+
+        sypha_list_destroy(list);
+        sypha_arena_destroy(arena);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Container iterators don't pile up in the arena") {
+        SYPHA_ARENA arena = sypha_arena_create_with_allocator(&allocator, 0);
+        SYPHA_ALLOCATOR arena_allocator;
+        REQUIRE(arena != NULL);
+        sypha_arena_get_allocator(arena, &arena_allocator);
+
+        SYPHA_MAP map = sypha_map_create_with_allocator(&arena_allocator);
+        SYPHA_VEC vec = sypha_vec_create_with_allocator(&arena_allocator, sizeof(int));
+        SYPHA_ULIST ulist = sypha_ulist_create_with_allocator(&arena_allocator, sizeof(int), 16);
+        SYPHA_CLIST clist = sypha_clist_create_with_allocator(&arena_allocator, sizeof(int));
+        SYPHA_SKIPLIST skiplist = sypha_skiplist_create_with_allocator(&arena_allocator, cmp_int, NULL);
+        REQUIRE(map != NULL);
+        REQUIRE(vec != NULL);
+        REQUIRE(ulist != NULL);
+        REQUIRE(clist != NULL);
+        REQUIRE(skiplist != NULL);
+        for (int i=0;i < 100;i++) {
+            REQUIRE_EQ(sypha_map_put(map, &i, sizeof(i), &i, sizeof(i)), 0);
+            REQUIRE_EQ(sypha_vec_append_item(vec, &i), 0);
+            REQUIRE_EQ(sypha_ulist_append_item(ulist, &i), 0);
+            REQUIRE_EQ(sypha_clist_append_item(clist, &i), 0);
+            REQUIRE_EQ(sypha_skiplist_insert(skiplist, &i, sizeof(i)), 0);
+        }
+        long warm = ctx.allocs;
+
+        for (int i=0;i < 100000;i++) {
+            SYPHA_MAP_ITERATOR map_iterator = sypha_map_get_iterator(map);
+            SYPHA_VEC_ITERATOR vec_iterator = sypha_vec_get_iterator_front(vec);
+            SYPHA_ULIST_ITERATOR ulist_iterator = sypha_ulist_get_iterator_front(ulist);
+            SYPHA_CLIST_ITERATOR clist_iterator = sypha_clist_get_iterator_back(clist);
+            SYPHA_SKIPLIST_ITERATOR skiplist_iterator = sypha_skiplist_get_iterator_front(skiplist);
+            REQUIRE(map_iterator != NULL);
+            REQUIRE(vec_iterator != NULL);
+            REQUIRE(ulist_iterator != NULL);
+            REQUIRE(clist_iterator != NULL);
+            REQUIRE(skiplist_iterator != NULL);
+            sypha_map_destroy_iterator(map_iterator);
+            sypha_vec_destroy_iterator(vec_iterator);
+            sypha_ulist_destroy_iterator(ulist_iterator);
+            sypha_clist_destroy_iterator(clist_iterator);
+            sypha_skiplist_destroy_iterator(skiplist_iterator);
+        }
+        CHECK_EQ(ctx.allocs, warm);
+
+        sypha_map_destroy(map);
+        sypha_vec_destroy(vec);
+        sypha_ulist_destroy(ulist);
+        sypha_clist_destroy(clist);
+        sypha_skiplist_destroy(skiplist);
+        sypha_arena_destroy(arena);
+        CHECK_EQ(ctx.allocs, ctx.frees);
+    }
+
+    SUBCASE("Growing containers") {
+        SYPHA_ARENA arena = sypha_arena_create(0);
+        SYPHA_ALLOCATOR arena_allocator;
+        REQUIRE(arena != NULL);
+        sypha_arena_get_allocator(arena, &arena_allocator);
+
+        SYPHA_VEC vec = sypha_vec_create_with_allocator(&arena_allocator, sizeof(int));
+        SYPHA_CLIST clist = sypha_clist_create_with_allocator(&arena_allocator, sizeof(int));
+        REQUIRE(vec != NULL);
+        REQUIRE(clist != NULL);
+        for (int i=0;i < 10000;i++) {
+            REQUIRE_EQ(sypha_vec_append_item(vec, &i), 0);
+            REQUIRE_EQ(sypha_clist_append_item(clist, &i), 0);
+        }
+        CHECK_EQ(sypha_vec_count(vec), 10000);
+        CHECK_EQ(sypha_clist_count(clist), 10000);
+        for (int i=0;i < 10000;i++) {
+            REQUIRE_EQ(*((int *) sypha_vec_get(vec, i)), i);
+        }
+
+        sypha_vec_destroy(vec);
+        sypha_clist_destroy(clist);
+        sypha_arena_destroy(arena);
+    }
+
+    SUBCASE("Destructors still run") {
+        SYPHA_ARENA arena = sypha_arena_create(0);
+        REQUIRE(arena != NULL);
+        int destroyed = 0;
+        int values[8];
+
+        SYPHA_LIST list = sypha_list_create_in_arena(arena);
+        REQUIRE(list != NULL);
+        sypha_list_set_destructor(list, count_destructor, &destroyed);
+        for (int i=0;i < 8;i++) {
+            sypha_list_append_ref(list, &values[i], sizeof(int));
+        }
+        CHECK_EQ(sypha_list_clear(list), 0);
+        CHECK_EQ(destroyed, 8);
+
+        for (int i=0;i < 8;i++) {
+            sypha_list_append_ref(list, &values[i], sizeof(int));
+        }
+        sypha_list_destroy(list);
+        CHECK_EQ(destroyed, 16);
+
+        sypha_arena_destroy(arena);
+    }
+
+    SUBCASE("Items move out of and into arena lists") {
+        SYPHA_LIST arena_list = sypha_list_create_in_arena(NULL);
+        SYPHA_LIST heap_list = sypha_list_create();
+        REQUIRE(arena_list != NULL);
+        REQUIRE(heap_list != NULL);
+
+        fill_and_check(arena_list, 100);
+
+        // A split off list can't live in the list's own arena, it would go with it
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(arena_list);
+        REQUIRE(iterator != NULL);
+        for (int i=0;i <= 50;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        }
+        SYPHA_LIST split = sypha_list_split_at(iterator);
+        REQUIRE(split != NULL);
+        sypha_list_destroy_iterator(iterator);
+        sypha_list_destroy(arena_list);
+
+        size_t value_sz;
+        int expected = 50;
+        iterator = sypha_list_get_read_iterator_front(split);
+        REQUIRE(iterator != NULL);
+        while (sypha_list_iterator_next(iterator) == 0) {
+            CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &value_sz)), expected++);
+        }
+        sypha_list_destroy_iterator(iterator);
+        CHECK_EQ(expected, 100);
+
+        // and back into an arena
+        arena_list = sypha_list_create_in_arena(NULL);
+        REQUIRE(arena_list != NULL);
+        fill_and_check(heap_list, 50);
+        CHECK_EQ(sypha_list_concat(heap_list, split), 0);
+        CHECK_EQ(sypha_list_concat(arena_list, heap_list), 0);
+        expected = 0;
+        iterator = sypha_list_get_read_iterator_front(arena_list);
+        REQUIRE(iterator != NULL);
+        while (sypha_list_iterator_next(iterator) == 0) {
+            CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &value_sz)), expected++);
+        }
+        sypha_list_destroy_iterator(iterator);
+        CHECK_EQ(expected, 100);
+
+        sypha_list_destroy(split);
+        sypha_list_destroy(heap_list);
+        sypha_list_destroy(arena_list);
+    }
+}
@@ -0,0 +1,379 @@
+/* test_clist.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_clist.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Walks the whole list both ways and compares against the expected contents
+static void check_contents(SYPHA_CLIST list, const std::vector<int> & expected) {
+    SYPHA_CLIST_ITERATOR iterator;
+
+    CHECK_EQ(sypha_clist_count(list), expected.size());
+
+    iterator = sypha_clist_get_iterator_front(list);
+    REQUIRE(iterator != NULL);
+    for (size_t i=0;i < expected.size();i++) {
+        CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_clist_iterator_get(iterator)), expected[i]);
+    }
+    CHECK_LT(sypha_clist_iterator_next(iterator), 0);
+    sypha_clist_destroy_iterator(iterator);
+
+    iterator = sypha_clist_get_iterator_back(list);
+    REQUIRE(iterator != NULL);
+    for (size_t i=expected.size();i > 0;i--) {
+        CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_clist_iterator_get(iterator)), expected[i - 1]);
+    }
+    CHECK_LT(sypha_clist_iterator_next(iterator), 0);
+    sypha_clist_destroy_iterator(iterator);
+}
+
+TEST_CASE("Happy Path Compact List") {
+    SYPHA_CLIST list = sypha_clist_create(sizeof(int));
+    REQUIRE(list != NULL);
+
+    std::vector<int> expected;
+
+    SUBCASE("Append and prepend past the first growth") {
+        for (int i=0;i < 500;i++) {
+            CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+            expected.push_back(i);
+        }
+        for (int i=-1;i > -500;i--) {
+            CHECK_EQ(sypha_clist_prepend_item(list, &i), 0);
+            expected.insert(expected.begin(), i);
+        }
+        check_contents(list, expected);
+    }
+
+    SUBCASE("Iterator survives the node array moving") {
+        for (int i=0;i < 4;i++) {
+            CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+            expected.push_back(i);
+        }
+
+        SYPHA_CLIST_ITERATOR iterator = sypha_clist_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+        CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+
+        for (int i=100;i < 1100;i++) {
+            CHECK_EQ(sypha_clist_iterator_insert_after(iterator, &i), 0);
+            expected.insert(expected.begin() + 2, i);
+        }
+        CHECK_EQ(*((int *) sypha_clist_iterator_get(iterator)), 1);
+
+        int value = 99;
+        CHECK_EQ(sypha_clist_iterator_insert_before(iterator, &value), 0);
+        expected.insert(expected.begin() + 1, value);
+        CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_clist_iterator_get(iterator)), 1099);
+
+        sypha_clist_destroy_iterator(iterator);
+        check_contents(list, expected);
+    }
+
+    SUBCASE("Deleted nodes are recycled") {
+        for (int i=0;i < 64;i++) {
+            CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+        }
+        size_t image_sz = sypha_clist_serialized_sz(list);
+
+        // Queue churn never needs more nodes than it holds
+        SYPHA_CLIST_ITERATOR iterator = sypha_clist_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+        for (int i=64;i < 10000;i++) {
+            CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+            CHECK_EQ(*((int *) sypha_clist_iterator_get(iterator)), i - 64);
+            CHECK_EQ(sypha_clist_iterator_delete_current(iterator), 0);
+            CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+        }
+        sypha_clist_destroy_iterator(iterator);
+
+        CHECK_EQ(sypha_clist_serialized_sz(list), image_sz);
+        for (int i=10000 - 64;i < 10000;i++) {
+            expected.push_back(i);
+        }
+        check_contents(list, expected);
+    }
+
+    SUBCASE("Reserve") {
+        CHECK_EQ(sypha_clist_reserve(list, 100000), 0);
+        for (int i=0;i < 100000;i++) {
+            CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+            expected.push_back(i);
+        }
+        check_contents(list, expected);
+        CHECK_EQ(sypha_clist_reserve(list, 10), 0);
+    }
+
+    sypha_clist_destroy(list);
+}
+
+TEST_CASE("Compact list layout") {
+    SUBCASE("Element alignment") {
+        for (size_t elem_sz : { 1, 3, 4, 8, 12, 16, 24 }) {
+            SYPHA_CLIST list = sypha_clist_create(elem_sz);
+            REQUIRE(list != NULL);
+
+            std::vector<unsigned char> elem(elem_sz);
+            for (int i=0;i < 100;i++) {
+                memset(elem.data(), i, elem_sz);
+                CHECK_EQ(sypha_clist_append_item(list, elem.data()), 0);
+            }
+
+            SYPHA_CLIST_ITERATOR iterator = sypha_clist_get_iterator_front(list);
+            REQUIRE(iterator != NULL);
+            for (int i=0;i < 100;i++) {
+                CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+                unsigned char * got = (unsigned char *) sypha_clist_iterator_get(iterator);
+                CHECK_EQ(((uintptr_t) got) % ((elem_sz % 8) ? 4 : 8), 0);
+                CHECK_EQ(got[0], (unsigned char) i);
+                CHECK_EQ(got[elem_sz - 1], (unsigned char) i);
+            }
+            sypha_clist_destroy_iterator(iterator);
+            sypha_clist_destroy(list);
+        }
+    }
+
+    SUBCASE("Serialize round trip") {
+        SYPHA_CLIST list = sypha_clist_create(sizeof(int));
+        REQUIRE(list != NULL);
+        std::vector<int> expected;
+
+        for (int i=0;i < 300;i++) {
+            CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+            expected.push_back(i);
+        }
+        // leave some holes on the free list
+        SYPHA_CLIST_ITERATOR iterator = sypha_clist_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+        for (int i=0;i < 300;i++) {
+            CHECK_EQ(sypha_clist_iterator_next(iterator), 0);
+            if (i % 3 == 0) {
+                CHECK_EQ(sypha_clist_iterator_delete_current(iterator), 0);
+            }
+        }
+        sypha_clist_destroy_iterator(iterator);
+        for (size_t i=expected.size();i > 0;i--) {
+            if ((i - 1) % 3 == 0) {
+                expected.erase(expected.begin() + (i - 1));
+            }
+        }
+
+        std::vector<unsigned char> image(sypha_clist_serialized_sz(list));
+        sypha_clist_serialize(list, image.data());
+        sypha_clist_destroy(list);
+
+        list = sypha_clist_create_from_serialized(NULL, image.data(), image.size());
+        REQUIRE(list != NULL);
+        check_contents(list, expected);
+
+        // holes get filled first
+        size_t image_sz = image.size();
+        for (int i=1000;i < 1100;i++) {
+            CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+            expected.push_back(i);
+        }
+        CHECK_EQ(sypha_clist_serialized_sz(list), image_sz);
+        check_contents(list, expected);
+        sypha_clist_destroy(list);
+
+        // Images that don't add up
+        CHECK(sypha_clist_create_from_serialized(NULL, image.data(), image.size() - 1) == NULL);
+        CHECK(sypha_clist_create_from_serialized(NULL, image.data(), 8) == NULL);
+
+        // Links that don't add up, patched into copies of the image.  It's a 40 byte header
+        // (first at 4, last at 8, free_first at 12, count at 24) then 12 byte nodes (prev, next, elem).
+        auto field = [](const std::vector<unsigned char> & bytes, size_t offset) {
+            uint32_t value;
+            memcpy(&value, bytes.data() + offset, sizeof(value));
+            return value;
+        };
+        auto patched = [&](size_t offset, uint32_t value) {
+            std::vector<unsigned char> bad(image);
+            memcpy(bad.data() + offset, &value, sizeof(value));
+            return sypha_clist_create_from_serialized(NULL, bad.data(), bad.size());
+        };
+        uint32_t first = field(image, 4);
+        uint32_t free_first = field(image, 12);
+        uint32_t second = field(image, 40 + first * 12 + 4);
+        CHECK(patched(40 + first * 12 + 4, 0xfffffff0U) == NULL);          // next out of range
+        CHECK(patched(40 + first * 12 + 4, first) == NULL);                // next loops back
+        CHECK(patched(40 + second * 12, second) == NULL);                  // prev doesn't match
+        CHECK(patched(8, first) == NULL);                                  // last isn't the end
+        CHECK(patched(24, 199) == NULL);                                   // count is off by one
+        CHECK(patched(40 + free_first * 12 + 4, first) == NULL);           // free list runs into live nodes
+        CHECK(patched(40 + free_first * 12 + 4, free_first) == NULL);      // free list loops
+        list = patched(20, 0);
+        REQUIRE(list != NULL);
+        sypha_clist_destroy(list);
+
+        image[0] ^= 0xff;
+        CHECK(sypha_clist_create_from_serialized(NULL, image.data(), image.size()) == NULL);
+    }
+
+    SUBCASE("Empty list round trip") {
+        SYPHA_CLIST list = sypha_clist_create(sizeof(int));
+        REQUIRE(list != NULL);
+        std::vector<unsigned char> image(sypha_clist_serialized_sz(list));
+        sypha_clist_serialize(list, image.data());
+        sypha_clist_destroy(list);
+
+        list = sypha_clist_create_from_serialized(NULL, image.data(), image.size());
+        REQUIRE(list != NULL);
+        check_contents(list, std::vector<int>());
+        int value = 7;
+        CHECK_EQ(sypha_clist_append_item(list, &value), 0);
+        check_contents(list, std::vector<int>({ 7 }));
+        sypha_clist_destroy(list);
+    }
+
+    SUBCASE("Bad element size") {
+        CHECK(sypha_clist_create(0) == NULL);
+    }
+}
+
+// Drives the list through random iterator operations and mirrors them on a vector
+static void random_walk(int forward) {
+    SYPHA_CLIST list = sypha_clist_create(sizeof(int));
+    REQUIRE(list != NULL);
+
+    std::vector<int> expected;
+    for (int i=0;i < 20;i++) {
+        CHECK_EQ(sypha_clist_append_item(list, &i), 0);
+        expected.push_back(i);
+    }
+
+    SYPHA_CLIST_ITERATOR iterator = (forward) ? sypha_clist_get_iterator_front(list) : sypha_clist_get_iterator_back(list);
+    REQUIRE(iterator != NULL);
+
+    // Model of the iterator, pos is the physical index of the current item
+    int pristine = 1;
+    long pos = (forward) ? 0 : (long) expected.size() - 1;
+    int value = 1000;
+
+    srand(23);
+    for (int step=0;step < 20000;step++) {
+        long size = (long) expected.size();
+        // second half leans toward deletes so the list drains and refills
+        int op = rand() % ((step < 10000) ? 6 : 9);
+        int ret;
+
+        if (op == 0) {
+            ret = sypha_clist_iterator_next(iterator);
+            if (size == 0) {
+                CHECK_LT(ret, 0);
+            } else if (pristine) {
+                CHECK_EQ(ret, 0);
+                pristine = 0;
+            } else if (forward ? (pos + 1 < size) : (pos > 0)) {
+                CHECK_EQ(ret, 0);
+                pos += (forward) ? 1 : -1;
+            } else {
+                CHECK_LT(ret, 0);
+            }
+        } else if (op == 1) {
+            ret = sypha_clist_iterator_previous(iterator);
+            if (size == 0 || pristine) {
+                CHECK_LT(ret, 0);
+            } else if (forward ? (pos > 0) : (pos + 1 < size)) {
+                CHECK_EQ(ret, 0);
+                pos += (forward) ? -1 : 1;
+            } else {
+                CHECK_LT(ret, 0);
+            }
+        } else if (op == 2) {
+            value++;
+            CHECK_EQ(sypha_clist_iterator_insert_after(iterator, &value), 0);
+            if (pristine || size == 0) {
+                // lands at the head of the iteration and the iterator moves onto it
+                if (forward) {
+                    expected.insert(expected.begin(), value);
+                    pos = 0;
+                } else {
+                    expected.push_back(value);
+                    pos = size;
+                }
+            } else if (forward) {
+                expected.insert(expected.begin() + pos + 1, value);
+            } else {
+                expected.insert(expected.begin() + pos, value);
+                pos++;
+            }
+        } else if (op == 3) {
+            value++;
+            ret = sypha_clist_iterator_insert_before(iterator, &value);
+            if (pristine || size == 0) {
+                CHECK_LT(ret, 0);
+            } else {
+                CHECK_EQ(ret, 0);
+                if (forward) {
+                    expected.insert(expected.begin() + pos, value);
+                    pos++;
+                } else {
+                    expected.insert(expected.begin() + pos + 1, value);
+                }
+            }
+        } else if (op >= 4 && op != 5 && size > 0) {
+            ret = sypha_clist_iterator_delete_current(iterator);
+            if (pristine) {
+                CHECK_LT(ret, 0);
+            } else {
+                CHECK_EQ(ret, 0);
+                expected.erase(expected.begin() + pos);
+                size--;
+                if (forward) {
+                    if (pos > 0) {
+                        pos--;
+                    } else {
+                        pristine = 1;
+                    }
+                } else if (pos == size) {
+                    pos = size - 1;
+                    pristine = 1;
+                }
+            }
+        }
+
+        int * got = (int *) sypha_clist_iterator_get(iterator);
+        if (pristine || expected.empty()) {
+            CHECK(got == NULL);
+        } else {
+            REQUIRE(got != NULL);
+            CHECK_EQ(*got, expected[pos]);
+        }
+    }
+
+    sypha_clist_destroy_iterator(iterator);
+    check_contents(list, expected);
+    sypha_clist_destroy(list);
+}
+
+TEST_CASE("Random walk Compact List") {
+    SUBCASE("Forward") {
+        random_walk(1);
+    }
+    SUBCASE("Backward") {
+        random_walk(0);
+    }
+}
@@ -0,0 +1,209 @@
+/* test_deque.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_deque.h"
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+
+// Elements carry a value and some padding so block sizes other than the int one get exercised
+template <size_t PAD>
+struct padded {
+    int value;
+    char pad[PAD];
+};
+
+template <size_t PAD>
+static void check_contents(SYPHA_DEQUE deque, const std::deque<int> & expected) {
+    CHECK_EQ(sypha_deque_count(deque), expected.size());
+    for (size_t i=0;i < expected.size();i++) {
+        CHECK_EQ(((padded<PAD> *) sypha_deque_at(deque, i))->value, expected[i]);
+    }
+    CHECK(sypha_deque_at(deque, expected.size()) == NULL);
+    if (expected.empty()) {
+        CHECK(sypha_deque_front(deque) == NULL);
+        CHECK(sypha_deque_back(deque) == NULL);
+    } else {
+        CHECK_EQ(((padded<PAD> *) sypha_deque_front(deque))->value, expected.front());
+        CHECK_EQ(((padded<PAD> *) sypha_deque_back(deque))->value, expected.back());
+    }
+}
+
+// Random pushes and pops at both ends mirrored on a std::deque, leaning towards growth first
+// and draining after so the ring wraps, grows while wrapped and empties out
+template <size_t PAD>
+static void random_walk() {
+    SYPHA_DEQUE deque = sypha_deque_create(sizeof(padded<PAD>));
+    REQUIRE(deque != NULL);
+    std::deque<int> expected;
+    padded<PAD> elem;
+    memset(&elem, 0x0, sizeof(elem));
+
+    srand(37);
+    for (int step=0;step < 40000;step++) {
+        int op = rand() % ((step % 10000 < 6000) ? 6 : 4);
+        if (op == 0 || op == 4) {
+            elem.value = step;
+            CHECK_EQ(sypha_deque_push_back(deque, &elem), 0);
+            expected.push_back(step);
+        } else if (op == 1 || op == 5) {
+            elem.value = -step;
+            CHECK_EQ(sypha_deque_push_front(deque, &elem), 0);
+            expected.push_front(-step);
+        } else if (op == 2) {
+            elem.value = 0;
+            if (expected.empty()) {
+                CHECK_LT(sypha_deque_pop_back(deque, &elem), 0);
+            } else {
+                CHECK_EQ(sypha_deque_pop_back(deque, &elem), 0);
+                CHECK_EQ(elem.value, expected.back());
+                expected.pop_back();
+            }
+        } else {
+            if (expected.empty()) {
+                CHECK_LT(sypha_deque_pop_front(deque, NULL), 0);
+            } else {
+                CHECK_EQ(sypha_deque_pop_front(deque, (step % 2) ? &elem : NULL), 0);
+                if (step % 2) {
+                    CHECK_EQ(elem.value, expected.front());
+                }
+                expected.pop_front();
+            }
+        }
+        if (step % 1000 == 0) {
+            check_contents<PAD>(deque, expected);
+            sypha_deque_shrink(deque);
+            check_contents<PAD>(deque, expected);
+        }
+    }
+    check_contents<PAD>(deque, expected);
+    sypha_deque_destroy(deque);
+}
+
+// Lets a test make allocations fail on demand
+struct failing_ctx {
+    int fail;
+};
+
+static void * failing_alloc(void * ctx, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : malloc(sz);
+}
+
+static void * failing_realloc(void * ctx, void * ptr, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : realloc(ptr, sz);
+}
+
+static void failing_free(void * ctx, void * ptr) {
+    free(ptr);
+}
+
+TEST_CASE("Happy Path Deque") {
+    SYPHA_DEQUE deque = sypha_deque_create(sizeof(int));
+    REQUIRE(deque != NULL);
+
+    std::deque<int> expected;
+
+    SUBCASE("Empty deque") {
+        CHECK_LT(sypha_deque_pop_front(deque, NULL), 0);
+        CHECK_LT(sypha_deque_pop_back(deque, NULL), 0);
+        CHECK_EQ(sypha_deque_capacity(deque), 0);
+        check_contents<0>(deque, expected);
+    }
+
+    SUBCASE("FIFO") {
+        int value;
+        for (int i=0;i < 5000;i++) {
+            CHECK_EQ(sypha_deque_push_back(deque, &i), 0);
+        }
+        for (int i=0;i < 5000;i++) {
+            CHECK_EQ(sypha_deque_pop_front(deque, &value), 0);
+            CHECK_EQ(value, i);
+        }
+        CHECK_EQ(sypha_deque_count(deque), 0);
+    }
+
+    SUBCASE("Steady state keeps its blocks") {
+        CHECK_EQ(sypha_deque_reserve(deque, 3000), 0);
+        size_t capacity = sypha_deque_capacity(deque);
+        CHECK_GE(capacity, 3000);
+        for (int i=0;i < 100000;i++) {
+            CHECK_EQ(sypha_deque_push_back(deque, &i), 0);
+            expected.push_back(i);
+            if (expected.size() > 2000) {
+                CHECK_EQ(sypha_deque_pop_front(deque, NULL), 0);
+                expected.pop_front();
+            }
+        }
+        CHECK_EQ(sypha_deque_capacity(deque), capacity);
+        check_contents<0>(deque, expected);
+
+        sypha_deque_clear(deque);
+        check_contents<0>(deque, std::deque<int>());
+        CHECK_EQ(sypha_deque_capacity(deque), capacity);
+        sypha_deque_shrink(deque);
+        int value = 7;
+        CHECK_EQ(sypha_deque_push_front(deque, &value), 0);
+        check_contents<0>(deque, std::deque<int>({ 7 }));
+    }
+
+    SUBCASE("Failed allocations change nothing") {
+        struct failing_ctx ctx = { 0 };
+        SYPHA_ALLOCATOR allocator = { failing_alloc, failing_realloc, failing_free, &ctx };
+        SYPHA_DEQUE failing = sypha_deque_create_with_allocator(&allocator, sizeof(int));
+        REQUIRE(failing != NULL);
+
+        // Fill the ring exactly, wrapped, so the next push has to grow
+        int value = 0;
+        CHECK_EQ(sypha_deque_push_back(failing, &value), 0);
+        size_t capacity = sypha_deque_capacity(failing);
+        expected.push_back(value);
+        for (value=1;expected.size() < capacity;value++) {
+            CHECK_EQ(sypha_deque_push_front(failing, &value), 0);
+            expected.push_front(value);
+        }
+        ctx.fail = 1;
+        CHECK_LT(sypha_deque_push_back(failing, &value), 0);
+        CHECK_LT(sypha_deque_push_front(failing, &value), 0);
+        CHECK_LT(sypha_deque_reserve(failing, capacity * 4), 0);
+        ctx.fail = 0;
+        check_contents<0>(failing, expected);
+        CHECK_EQ(sypha_deque_push_back(failing, &value), 0);
+        expected.push_back(value);
+        check_contents<0>(failing, expected);
+        sypha_deque_destroy(failing);
+    }
+
+    SUBCASE("Bad element size") {
+        CHECK(sypha_deque_create(0) == NULL);
+    }
+
+    sypha_deque_destroy(deque);
+}
+
+TEST_CASE("Random walk Deque") {
+    SUBCASE("int sized") {
+        random_walk<0>();
+    }
+    SUBCASE("Block of 8") {
+        random_walk<1020>();
+    }
+    SUBCASE("Odd sized") {
+        random_walk<9>();
+    }
+}
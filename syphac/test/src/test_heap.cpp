@@ -0,0 +1,186 @@
+/* test_heap.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_heap.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+// Deadline plus an id so equal deadlines can be told apart
+struct timer {
+    long deadline;
+    long id;
+};
+
+static int cmp_timer(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+    long a_deadline = ((const struct timer *) a)->deadline;
+    long b_deadline = ((const struct timer *) b)->deadline;
+    return (a_deadline > b_deadline) - (a_deadline < b_deadline);
+}
+
+// Pops everything and checks it comes out in order with the expected deadlines
+static void drain(SYPHA_HEAP heap, std::map<SYPHA_HEAP_HANDLE, long> & live) {
+    std::vector<long> expected;
+    struct timer top;
+
+    for (auto & entry : live) {
+        expected.push_back(entry.second);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    CHECK_EQ(sypha_heap_count(heap), expected.size());
+    for (size_t i=0;i < expected.size();i++) {
+        CHECK_EQ(((struct timer *) sypha_heap_peek(heap))->deadline, expected[i]);
+        CHECK_EQ(sypha_heap_pop(heap, &top), 0);
+        CHECK_EQ(top.deadline, expected[i]);
+    }
+    CHECK(sypha_heap_peek(heap) == NULL);
+    CHECK_LT(sypha_heap_pop(heap, NULL), 0);
+    live.clear();
+}
+
+// Lets a test make allocations fail on demand
+struct failing_ctx {
+    int fail;
+};
+
+static void * failing_alloc(void * ctx, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : malloc(sz);
+}
+
+static void * failing_realloc(void * ctx, void * ptr, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : realloc(ptr, sz);
+}
+
+static void failing_free(void * ctx, void * ptr) {
+    free(ptr);
+}
+
+TEST_CASE("Happy Path Heap") {
+    SYPHA_HEAP heap = sypha_heap_create(sizeof(struct timer), cmp_timer, NULL);
+    REQUIRE(heap != NULL);
+
+    std::map<SYPHA_HEAP_HANDLE, long> live;
+    SYPHA_HEAP_HANDLE handle;
+
+    SUBCASE("Push and pop in order") {
+        srand(43);
+        for (long i=0;i < 10000;i++) {
+            struct timer t = { rand() % 5000, i };
+            CHECK_EQ(sypha_heap_push(heap, &t, &handle), 0);
+            CHECK_EQ(((struct timer *) sypha_heap_get(heap, handle))->id, i);
+            live[handle] = t.deadline;
+        }
+        CHECK_EQ(live.size(), 10000);
+        drain(heap, live);
+    }
+
+    SUBCASE("Push many") {
+        std::vector<struct timer> timers;
+        std::vector<SYPHA_HEAP_HANDLE> handles(3000);
+        srand(47);
+        for (long i=0;i < 3000;i++) {
+            timers.push_back({ rand() % 1000, i });
+        }
+
+        // Into an empty heap it heapifies, on top of a bigger one it sifts
+        CHECK_EQ(sypha_heap_push_many(heap, timers.data(), 2000, handles.data()), 0);
+        CHECK_EQ(sypha_heap_push_many(heap, timers.data() + 2000, 1000, handles.data() + 2000), 0);
+        CHECK_EQ(sypha_heap_push_many(heap, timers.data(), 0, NULL), 0);
+        for (long i=0;i < 3000;i++) {
+            CHECK_EQ(((struct timer *) sypha_heap_get(heap, handles[i]))->id, i);
+            live[handles[i]] = timers[i].deadline;
+        }
+        drain(heap, live);
+    }
+
+    SUBCASE("Update and remove through handles") {
+        std::vector<SYPHA_HEAP_HANDLE> handles;
+        struct timer t;
+        srand(53);
+        for (long i=0;i < 2000;i++) {
+            t = { rand() % 10000, i };
+            CHECK_EQ(sypha_heap_push(heap, &t, &handle), 0);
+            handles.push_back(handle);
+            live[handle] = t.deadline;
+        }
+
+        for (int step=0;step < 5000;step++) {
+            SYPHA_HEAP_HANDLE h = handles[rand() % handles.size()];
+            if (live.find(h) == live.end()) {
+                CHECK(sypha_heap_get(heap, h) == NULL);
+                CHECK_LT(sypha_heap_update(heap, h, &t), 0);
+                CHECK_LT(sypha_heap_remove(heap, h, NULL), 0);
+            } else if (step % 4 == 0) {
+                CHECK_EQ(sypha_heap_remove(heap, h, &t), 0);
+                CHECK_EQ(t.deadline, live[h]);
+                live.erase(h);
+                CHECK(sypha_heap_get(heap, h) == NULL);
+            } else {
+                // Both ways, decrease-key and increase-key
+                t = { rand() % 10000, (long) h };
+                CHECK_EQ(sypha_heap_update(heap, h, &t), 0);
+                live[h] = t.deadline;
+            }
+        }
+        drain(heap, live);
+    }
+
+    SUBCASE("Handles get reused") {
+        struct timer t = { 1, 1 };
+        SYPHA_HEAP_HANDLE first;
+        CHECK_EQ(sypha_heap_push(heap, &t, &first), 0);
+        CHECK_EQ(sypha_heap_pop(heap, NULL), 0);
+        CHECK_EQ(sypha_heap_push(heap, &t, &handle), 0);
+        CHECK_EQ(handle, first);
+
+        sypha_heap_clear(heap);
+        CHECK_EQ(sypha_heap_count(heap), 0);
+        CHECK(sypha_heap_get(heap, handle) == NULL);
+    }
+
+    SUBCASE("Failed growth changes nothing") {
+        struct failing_ctx ctx = { 0 };
+        SYPHA_ALLOCATOR allocator = { failing_alloc, failing_realloc, failing_free, &ctx };
+        SYPHA_HEAP failing = sypha_heap_create_with_allocator(&allocator, sizeof(struct timer), cmp_timer, NULL);
+        REQUIRE(failing != NULL);
+
+        for (long i=0;i < 16;i++) {
+            struct timer t = { 100 - i, i };
+            CHECK_EQ(sypha_heap_push(failing, &t, &handle), 0);
+            live[handle] = t.deadline;
+        }
+        ctx.fail = 1;
+        struct timer t = { 0, 0 };
+        CHECK_LT(sypha_heap_push(failing, &t, NULL), 0);
+        CHECK_LT(sypha_heap_push_many(failing, &t, 1, NULL), 0);
+        CHECK_LT(sypha_heap_reserve(failing, 100), 0);
+        ctx.fail = 0;
+        CHECK_EQ(sypha_heap_reserve(failing, 100), 0);
+        drain(failing, live);
+        sypha_heap_destroy(failing);
+    }
+
+    SUBCASE("Bad arguments") {
+        CHECK(sypha_heap_create(0, cmp_timer, NULL) == NULL);
+        CHECK(sypha_heap_create(sizeof(struct timer), NULL, NULL) == NULL);
+    }
+
+    sypha_heap_destroy(heap);
+}
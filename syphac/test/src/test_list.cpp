@@ -17,7 +17,12 @@
 
 #include "doctest.h"
 #include "syphac/sypha_list.h"
+#include "syphac/sypha_list_inline.h"
 #include <string.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <random>
 
 TEST_CASE("Happy Path List") {
     SYPHA_LIST list = sypha_list_create();
@@ -744,3 +749,1248 @@ TEST_CASE("Modify list via iterator") {
 
     sypha_list_destroy(list);
 }
+
+TEST_CASE("Item payloads") {
+    SYPHA_LIST list = sypha_list_create();
+    REQUIRE(list != NULL);
+
+    SUBCASE("Payloads larger than a pointer are copied whole") {
+        char buffer[256];
+        for (int i=0;i < 16;i++) {
+            memset(buffer, 'a' + i, sizeof(buffer));
+            sypha_list_append_item(list, (void *) buffer, (size_t) (i * 16));
+        }
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+
+        char * value;
+        size_t valueSz;
+
+        for (int i=0;i < 16;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            value = (char *) sypha_list_iterator_get(iterator, &valueSz);
+            CHECK_EQ(valueSz, (size_t) (i * 16));
+            for (size_t j=0;j < valueSz;j++) {
+                CHECK_EQ(value[j], (char) ('a' + i));
+            }
+        }
+
+        sypha_list_destroy_iterator(iterator);
+    }
+
+    SUBCASE("Small payloads sit aligned in the item") {
+        unsigned char buffer[24];
+        for (int i=0;i < 25;i++) {
+            memset(buffer, i, sizeof(buffer));
+            sypha_list_append_item(list, (void *) buffer, (size_t) i);
+        }
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+
+        unsigned char * value;
+        size_t valueSz;
+
+        for (int i=0;i < 25;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            value = (unsigned char *) sypha_list_iterator_get(iterator, &valueSz);
+            CHECK_EQ(valueSz, (size_t) i);
+            CHECK_EQ(((size_t) value) % 8, 0);
+            for (size_t j=0;j < valueSz;j++) {
+                CHECK_EQ(value[j], (unsigned char) i);
+            }
+        }
+
+        sypha_list_destroy_iterator(iterator);
+    }
+
+    SUBCASE("Delete from middle of list with backward iterator") {
+        for (unsigned long long i=0;i < 50; i++) {
+            sypha_list_append_item(list, (void *) &i, sizeof(unsigned long long));
+        }
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_back(list);
+        REQUIRE(iterator != NULL);
+
+        for (int i=0;i < 10;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        }
+
+        for (int i=10;i < 30;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+        }
+
+        unsigned long long * value;
+        size_t valueSz;
+
+        for (unsigned long long i=20;i > 0;i--) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            value = (unsigned long long *) sypha_list_iterator_get(iterator, &valueSz);
+            CHECK_EQ(*value, i - 1);
+        }
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+
+        sypha_list_destroy_iterator(iterator);
+    }
+
+    sypha_list_destroy(list);
+}
+
+TEST_CASE("Pooled list") {
+    SYPHA_LIST list = sypha_list_create_pooled(sizeof(unsigned long long), 8);
+    REQUIRE(list != NULL);
+
+    SUBCASE("Queue churn recycles items") {
+        SYPHA_LIST_ITERATOR iterator;
+        unsigned long long * value;
+        size_t valueSz;
+        unsigned long long head = 0;
+
+        // append at back, delete at front, always keeping 20 items (more than a slab) around
+        for (unsigned long long i=0;i < 1000;i++) {
+            sypha_list_append_item(list, (void *) &i, sizeof(unsigned long long));
+            if (i >= 20) {
+                iterator = sypha_list_get_iterator_front(list);
+                REQUIRE(iterator != NULL);
+                CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+                value = (unsigned long long *) sypha_list_iterator_get(iterator, &valueSz);
+                CHECK_EQ(*value, head);
+                CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+                sypha_list_destroy_iterator(iterator);
+                head++;
+            }
+        }
+
+        iterator = sypha_list_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+        for (unsigned long long i=980;i < 1000;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            value = (unsigned long long *) sypha_list_iterator_get(iterator, &valueSz);
+            CHECK_EQ(valueSz, sizeof(unsigned long long));
+            CHECK_EQ(*value, i);
+        }
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+        sypha_list_destroy_iterator(iterator);
+    }
+
+    SUBCASE("Items larger than the hint") {
+        const char * token;
+
+        token = "foo";
+        sypha_list_append_item(list, (void *) token, strlen(token) + 1);
+
+        token = "a token that does not fit in a slot";
+        sypha_list_append_item(list, (void *) token, strlen(token) + 1);
+
+        token = "fubar";
+        sypha_list_append_item(list, (void *) token, strlen(token) + 1);
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+
+        void * value;
+        size_t valueSz;
+
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(strcmp((const char *) value, "foo"), 0);
+
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(strcmp((const char *) value, "a token that does not fit in a slot"), 0);
+
+        // delete the big one, then re-add to check it doesn't land in the pool
+        CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+        CHECK_EQ(sypha_list_iterator_insert_after(iterator, (void *) "another big token", 18), 0);
+
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(strcmp((const char *) value, "another big token"), 0);
+
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(strcmp((const char *) value, "fubar"), 0);
+
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+        sypha_list_destroy_iterator(iterator);
+    }
+
+    sypha_list_destroy(list);
+
+    CHECK(sypha_list_create_pooled(16, 0) == NULL);
+}
+
+struct destructor_log {
+    int calls;
+    size_t bytes;
+};
+
+static void free_and_log(void * data, size_t data_sz, void * ctx) {
+    struct destructor_log * log = (struct destructor_log *) ctx;
+    log->calls++;
+    log->bytes += data_sz;
+    free(data);
+}
+
+TEST_CASE("Ref items") {
+    SUBCASE("Borrowed pointers come back as is") {
+        SYPHA_LIST list = sypha_list_create();
+        char blob[4096];
+        char small[] = "small";
+        void * value;
+        size_t valueSz;
+
+        memset(blob, 'x', sizeof(blob));
+        sypha_list_append_ref(list, blob, sizeof(blob));
+        sypha_list_prepend_ref(list, small, sizeof(small));
+        sypha_list_append_item(list, (void *) "copied", 7);
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(value, (void *) small);
+        CHECK_EQ(valueSz, sizeof(small));
+
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(value, (void *) blob);
+        CHECK_EQ(valueSz, sizeof(blob));
+
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(strcmp((const char *) value, "copied"), 0);
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+        sypha_list_destroy_iterator(iterator);
+
+        // no destructor set, borrowed memory is left alone
+        sypha_list_destroy(list);
+        CHECK_EQ(blob[0], 'x');
+    }
+
+    SUBCASE("Owned pointers go to the destructor") {
+        SYPHA_LIST list = sypha_list_create_pooled(16, 4);
+        struct destructor_log log = { 0, 0 };
+        void * value;
+        size_t valueSz;
+
+        sypha_list_set_destructor(list, free_and_log, &log);
+        for (int i=0;i < 10;i++) {
+            sypha_list_append_ref(list, malloc(100 + i), 100 + i);
+        }
+        // copies never see the destructor
+        sypha_list_append_item(list, (void *) "copied", 7);
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+        CHECK_EQ(log.calls, 1);
+        CHECK_EQ(log.bytes, 101);
+
+        // insert relative to the current (first) item
+        void * owned = malloc(8);
+        CHECK_EQ(sypha_list_iterator_insert_after_ref(iterator, owned, 8), 0);
+        CHECK_EQ(sypha_list_iterator_insert_before_ref(iterator, malloc(9), 9), 0);
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        value = sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(value, owned);
+        CHECK_EQ(valueSz, 8);
+        sypha_list_destroy_iterator(iterator);
+
+        sypha_list_destroy(list);
+        CHECK_EQ(log.calls, 12);
+    }
+
+    SUBCASE("Insert ref on pristine iterator") {
+        SYPHA_LIST list = sypha_list_create();
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        int value = 0;
+        size_t valueSz;
+
+        CHECK_LT(sypha_list_iterator_insert_before_ref(iterator, &value, sizeof(value)), 0);
+        CHECK_EQ(sypha_list_iterator_insert_after_ref(iterator, &value, sizeof(value)), 0);
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_list_iterator_get(iterator, &valueSz), (void *) &value);
+
+        sypha_list_destroy_iterator(iterator);
+        sypha_list_destroy(list);
+    }
+}
+
+// Walks the list front to back checking each int against expected
+static void check_int_list(SYPHA_LIST list, const std::vector<int> & expected) {
+    SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+    size_t valueSz;
+    size_t i = 0;
+
+    while (sypha_list_iterator_next(iterator) == 0) {
+        REQUIRE_LT(i, expected.size());
+        CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &valueSz)), expected[i]);
+        CHECK_EQ(valueSz, sizeof(int));
+        i++;
+    }
+    CHECK_EQ(i, expected.size());
+    sypha_list_destroy_iterator(iterator);
+}
+
+TEST_CASE("Bulk insert") {
+    // enough to span several blocks
+    static int values[5000];
+    std::vector<int> expected;
+
+    for (int i=0;i < 5000;i++) {
+        values[i] = i;
+    }
+
+    SUBCASE("Append and prepend arrays around single items") {
+        SYPHA_LIST list = sypha_list_create();
+        int single = -1;
+
+        CHECK_EQ(sypha_list_append_many(list, values, sizeof(int), 0), 0);
+        CHECK_EQ(sypha_list_append_many(list, values, sizeof(int), 10), 0);
+        sypha_list_append_item(list, &single, sizeof(single));
+        CHECK_EQ(sypha_list_prepend_many(list, values + 10, sizeof(int), 5), 0);
+        CHECK_EQ(sypha_list_append_many(list, values + 100, sizeof(int), 3), 0);
+
+        expected = { 10, 11, 12, 13, 14, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, 100, 101, 102 };
+        check_int_list(list, expected);
+
+        // backward walk should agree
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_back(list);
+        size_t valueSz;
+        for (size_t i=expected.size();i > 0;i--) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &valueSz)), expected[i - 1]);
+        }
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+        sypha_list_destroy_iterator(iterator);
+
+        sypha_list_destroy(list);
+    }
+
+    SUBCASE("Delete and insert among batch items") {
+        SYPHA_LIST list = sypha_list_create();
+        int single = -1;
+
+        CHECK_EQ(sypha_list_prepend_many(list, values, sizeof(int), 5000), 0);
+
+        // drop every other item, insert a regular item in front of the rest
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        while (sypha_list_iterator_next(iterator) == 0) {
+            CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+            if (sypha_list_iterator_next(iterator) == 0) {
+                CHECK_EQ(sypha_list_iterator_insert_before(iterator, &single, sizeof(single)), 0);
+            }
+        }
+        sypha_list_destroy_iterator(iterator);
+
+        expected.clear();
+        for (int i=1;i < 5000;i += 2) {
+            expected.push_back(-1);
+            expected.push_back(i);
+        }
+        check_int_list(list, expected);
+
+        sypha_list_destroy(list);
+    }
+
+    SUBCASE("Pooled list recycles batch items") {
+        SYPHA_LIST list = sypha_list_create_pooled(sizeof(int), 8);
+        char big[64];
+
+        CHECK_EQ(sypha_list_append_many(list, values, sizeof(int), 100), 0);
+        // too big for the slots, gets its own block
+        memset(big, 0x0, sizeof(big));
+        CHECK_EQ(sypha_list_append_many(list, big, sizeof(big), 1), 0);
+
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        for (int i=0;i < 50;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+        }
+        sypha_list_destroy_iterator(iterator);
+        for (int i=0;i < 50;i++) {
+            sypha_list_prepend_item(list, &values[49 - i], sizeof(int));
+        }
+
+        iterator = sypha_list_get_iterator_front(list);
+        size_t valueSz;
+        for (int i=0;i < 100;i++) {
+            CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+            CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &valueSz)), i);
+        }
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(valueSz, sizeof(big));
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+        sypha_list_destroy_iterator(iterator);
+
+        sypha_list_destroy(list);
+    }
+}
+
+// Builds a list of ints from..to-1, first half with single appends and the rest in a batch
+static SYPHA_LIST make_int_list(SYPHA_LIST list, int from, int to) {
+    std::vector<int> values;
+    int mid = from + (to - from) / 2;
+
+    for (int i=from;i < mid;i++) {
+        sypha_list_append_item(list, &i, sizeof(i));
+    }
+    for (int i=mid;i < to;i++) {
+        values.push_back(i);
+    }
+    sypha_list_append_many(list, values.data(), sizeof(int), values.size());
+    return list;
+}
+
+static std::vector<int> int_range(int from, int to) {
+    std::vector<int> values;
+    for (int i=from;i < to;i++) {
+        values.push_back(i);
+    }
+    return values;
+}
+
+// Moves the iterator onto the nth item
+static void advance(SYPHA_LIST_ITERATOR iterator, int n) {
+    for (int i=0;i <= n;i++) {
+        REQUIRE_EQ(sypha_list_iterator_next(iterator), 0);
+    }
+}
+
+TEST_CASE("Moving items between lists") {
+    std::vector<int> expected;
+
+    SUBCASE("Concat lists, source ends up empty and reusable") {
+        SYPHA_LIST dst = make_int_list(sypha_list_create(), 0, 100);
+        SYPHA_LIST src = make_int_list(sypha_list_create(), 100, 300);
+        SYPHA_LIST empty = sypha_list_create();
+
+        CHECK_EQ(sypha_list_concat(dst, src), 0);
+        CHECK_EQ(sypha_list_concat(dst, empty), 0);
+        CHECK_LT(sypha_list_concat(dst, dst), 0);
+        CHECK_EQ(sypha_list_concat(empty, dst), 0);
+        check_int_list(empty, int_range(0, 300));
+        check_int_list(dst, expected);
+        check_int_list(src, expected);
+
+        // the source still works and its old items are safe after it goes
+        make_int_list(src, 300, 310);
+        CHECK_EQ(sypha_list_concat(empty, src), 0);
+        sypha_list_destroy(src);
+        sypha_list_destroy(dst);
+        check_int_list(empty, int_range(0, 310));
+
+        sypha_list_destroy(empty);
+    }
+
+    SUBCASE("Concat pooled lists") {
+        SYPHA_LIST dst = make_int_list(sypha_list_create_pooled(sizeof(int), 8), 0, 50);
+        SYPHA_LIST same = make_int_list(sypha_list_create_pooled(sizeof(int), 16), 50, 100);
+        SYPHA_LIST other = make_int_list(sypha_list_create_pooled(64, 8), 100, 150);
+        SYPHA_LIST plain = make_int_list(sypha_list_create(), 150, 200);
+
+        // leave some free slots behind in the sources
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_back(same);
+        advance(iterator, 0);
+        sypha_list_iterator_delete_current(iterator);
+        sypha_list_destroy_iterator(iterator);
+        sypha_list_append_item(same, &expected, 0);
+        iterator = sypha_list_get_iterator_back(same);
+        advance(iterator, 0);
+        sypha_list_iterator_delete_current(iterator);
+        sypha_list_destroy_iterator(iterator);
+        int last = 99;
+        sypha_list_append_item(same, &last, sizeof(last));
+
+        CHECK_EQ(sypha_list_concat(dst, same), 0);
+        CHECK_EQ(sypha_list_concat(dst, other), 0);
+        CHECK_EQ(sypha_list_concat(dst, plain), 0);
+        sypha_list_destroy(same);
+        sypha_list_destroy(other);
+        sypha_list_destroy(plain);
+        check_int_list(dst, int_range(0, 200));
+
+        // churn the merged list, every slot gets recycled along the way
+        iterator = sypha_list_get_iterator_front(dst);
+        for (int i=0;i < 200;i++) {
+            advance(iterator, 0);
+            sypha_list_iterator_delete_current(iterator);
+            sypha_list_append_item(dst, &i, sizeof(i));
+        }
+        sypha_list_destroy_iterator(iterator);
+        check_int_list(dst, int_range(0, 200));
+
+        sypha_list_destroy(dst);
+    }
+
+    SUBCASE("Splice a range into the middle") {
+        SYPHA_LIST dst = make_int_list(sypha_list_create(), 0, 10);
+        SYPHA_LIST src = make_int_list(sypha_list_create(), 100, 120);
+        SYPHA_LIST_ITERATOR dst_iterator = sypha_list_get_iterator_front(dst);
+        SYPHA_LIST_ITERATOR begin = sypha_list_get_read_iterator_front(src);
+        SYPHA_LIST_ITERATOR end = sypha_list_get_read_iterator_front(src);
+
+        advance(dst_iterator, 4);
+        advance(begin, 3);
+        advance(end, 15);
+
+        // range backwards or pristine iterators are refused
+        CHECK_LT(sypha_list_splice(dst_iterator, src, end, begin), 0);
+        SYPHA_LIST_ITERATOR pristine = sypha_list_get_read_iterator_front(src);
+        CHECK_LT(sypha_list_splice(dst_iterator, src, pristine, end), 0);
+        sypha_list_destroy_iterator(pristine);
+
+        // items 103..115 land after 4, spanning the single and batch halves
+        CHECK_EQ(sypha_list_splice(dst_iterator, src, begin, end), 0);
+        sypha_list_destroy_iterator(begin);
+        sypha_list_destroy_iterator(end);
+
+        // iterator is still on 4
+        size_t valueSz;
+        CHECK_EQ(*((int *) sypha_list_iterator_get(dst_iterator, &valueSz)), 4);
+        CHECK_EQ(sypha_list_iterator_next(dst_iterator), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(dst_iterator, &valueSz)), 103);
+        sypha_list_destroy_iterator(dst_iterator);
+
+        expected = int_range(0, 5);
+        for (int i : int_range(103, 116)) {
+            expected.push_back(i);
+        }
+        for (int i : int_range(5, 10)) {
+            expected.push_back(i);
+        }
+        sypha_list_destroy(src);
+        check_int_list(dst, expected);
+
+        sypha_list_destroy(dst);
+    }
+
+    SUBCASE("Splice whole lists through pristine and backward iterators") {
+        SYPHA_LIST dst = sypha_list_create();
+        SYPHA_LIST src = make_int_list(sypha_list_create_pooled(sizeof(int), 4), 10, 20);
+
+        // into an empty list
+        SYPHA_LIST_ITERATOR dst_iterator = sypha_list_get_iterator_front(dst);
+        CHECK_EQ(sypha_list_splice(dst_iterator, src, NULL, NULL), 0);
+        sypha_list_destroy_iterator(dst_iterator);
+        check_int_list(src, expected);
+
+        // pristine forward goes to the front, next is the first spliced item
+        make_int_list(src, 0, 10);
+        dst_iterator = sypha_list_get_iterator_front(dst);
+        CHECK_EQ(sypha_list_splice(dst_iterator, src, NULL, NULL), 0);
+        size_t valueSz;
+        CHECK_EQ(sypha_list_iterator_next(dst_iterator), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(dst_iterator, &valueSz)), 0);
+        sypha_list_destroy_iterator(dst_iterator);
+
+        // pristine backward goes to the back
+        make_int_list(src, 30, 40);
+        dst_iterator = sypha_list_get_iterator_back(dst);
+        CHECK_EQ(sypha_list_splice(dst_iterator, src, NULL, NULL), 0);
+        CHECK_EQ(sypha_list_iterator_next(dst_iterator), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(dst_iterator, &valueSz)), 39);
+
+        // backward on 39 goes in ahead of it in list order
+        make_int_list(src, 20, 30);
+        advance(dst_iterator, 8);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(dst_iterator, &valueSz)), 30);
+        CHECK_EQ(sypha_list_splice(dst_iterator, src, NULL, NULL), 0);
+        CHECK_EQ(sypha_list_iterator_next(dst_iterator), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(dst_iterator, &valueSz)), 29);
+        sypha_list_destroy_iterator(dst_iterator);
+
+        sypha_list_destroy(src);
+        check_int_list(dst, int_range(0, 40));
+        sypha_list_destroy(dst);
+    }
+
+    SUBCASE("Split a list") {
+        SYPHA_LIST list = make_int_list(sypha_list_create_pooled(sizeof(int), 8), 0, 100);
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+
+        CHECK(sypha_list_split_at(iterator) == NULL);
+        advance(iterator, 60);
+        SYPHA_LIST tail = sypha_list_split_at(iterator);
+        REQUIRE(tail != NULL);
+
+        // iterator is on the new last item
+        size_t valueSz;
+        CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &valueSz)), 59);
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+        sypha_list_destroy_iterator(iterator);
+
+        // splitting at the first item takes everything
+        iterator = sypha_list_get_iterator_front(tail);
+        advance(iterator, 0);
+        SYPHA_LIST all = sypha_list_split_at(iterator);
+        REQUIRE(all != NULL);
+        CHECK_LT(sypha_list_iterator_next(iterator), 0);
+        CHECK(sypha_list_split_at(iterator) == NULL);
+        sypha_list_destroy_iterator(iterator);
+        check_int_list(tail, expected);
+        sypha_list_destroy(tail);
+
+        check_int_list(list, int_range(0, 60));
+        sypha_list_destroy(list);
+
+        // the split off list is a working pooled list on its own
+        make_int_list(all, 100, 110);
+        check_int_list(all, int_range(60, 110));
+        sypha_list_destroy(all);
+    }
+
+    SUBCASE("Slab items are relinked and outlive their source") {
+        SYPHA_LIST pooled = make_int_list(sypha_list_create_pooled(sizeof(int), 8), 0, 100);
+        SYPHA_LIST plain = make_int_list(sypha_list_create(), 100, 200);
+        SYPHA_LIST dst = sypha_list_create_pooled(sizeof(int), 8);
+
+        // the moved items are the very same items
+        SYPHA_LIST_ITERATOR begin = sypha_list_get_read_iterator_front(pooled);
+        advance(begin, 40);
+        size_t valueSz;
+        void * moved = sypha_list_iterator_get(begin, &valueSz);
+        SYPHA_LIST_ITERATOR dst_iterator = sypha_list_get_iterator_front(dst);
+        CHECK_EQ(sypha_list_splice(dst_iterator, pooled, begin, NULL), 0);
+        sypha_list_destroy_iterator(begin);
+        CHECK_EQ(sypha_list_iterator_next(dst_iterator), 0);
+        CHECK(sypha_list_iterator_get(dst_iterator, &valueSz) == moved);
+        sypha_list_destroy_iterator(dst_iterator);
+
+        // batch block items too, then the sources go first
+        SYPHA_LIST_ITERATOR split = sypha_list_get_iterator_front(plain);
+        advance(split, 50);
+        SYPHA_LIST tail = sypha_list_split_at(split);
+        REQUIRE(tail != NULL);
+        sypha_list_destroy_iterator(split);
+        CHECK_EQ(sypha_list_concat(dst, tail), 0);
+        sypha_list_destroy(tail);
+        sypha_list_destroy(plain);
+        check_int_list(pooled, int_range(0, 40));
+        sypha_list_destroy(pooled);
+
+        expected = int_range(40, 100);
+        for (int i : int_range(150, 200)) {
+            expected.push_back(i);
+        }
+        check_int_list(dst, expected);
+
+        // deleting and adding in dst only ever recycles its own slots
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(dst);
+        for (int i : expected) {
+            advance(iterator, 0);
+            sypha_list_iterator_delete_current(iterator);
+            sypha_list_append_item(dst, &i, sizeof(i));
+        }
+        sypha_list_destroy_iterator(iterator);
+        check_int_list(dst, expected);
+        sypha_list_destroy(dst);
+    }
+
+    SUBCASE("Concat keeps the free slots of both lists") {
+        SYPHA_LIST dst = make_int_list(sypha_list_create_pooled(sizeof(int), 8), 0, 16);
+        SYPHA_LIST src = make_int_list(sypha_list_create_pooled(sizeof(int), 8), 16, 32);
+
+        // both end up with free slots, 4 in dst and 8 in src
+        std::vector<void *> freed;
+        size_t valueSz;
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_back(dst);
+        for (int i=0;i < 4;i++) {
+            advance(iterator, 0);
+            freed.push_back(sypha_list_iterator_get(iterator, &valueSz));
+            sypha_list_iterator_delete_current(iterator);
+        }
+        sypha_list_destroy_iterator(iterator);
+        iterator = sypha_list_get_iterator_back(src);
+        for (int i=0;i < 8;i++) {
+            advance(iterator, 0);
+            freed.push_back(sypha_list_iterator_get(iterator, &valueSz));
+            sypha_list_iterator_delete_current(iterator);
+        }
+        sypha_list_destroy_iterator(iterator);
+
+        // every one of those slots is reused before dst carves out more
+        CHECK_EQ(sypha_list_concat(dst, src), 0);
+        sypha_list_destroy(src);
+        for (int i=0;i < 12;i++) {
+            sypha_list_append_item(dst, &i, sizeof(i));
+        }
+        iterator = sypha_list_get_read_iterator_back(dst);
+        for (int i=0;i < 12;i++) {
+            advance(iterator, 0);
+            void * slot = sypha_list_iterator_get(iterator, &valueSz);
+            CHECK(std::find(freed.begin(), freed.end(), slot) != freed.end());
+        }
+        sypha_list_destroy_iterator(iterator);
+
+        sypha_list_destroy(dst);
+    }
+
+    SUBCASE("Moves are refused while the source has a writer") {
+        SYPHA_LIST dst = sypha_list_create();
+        SYPHA_LIST src = make_int_list(sypha_list_create(), 0, 10);
+        SYPHA_LIST_ITERATOR writer = sypha_list_get_iterator_front(src);
+        SYPHA_LIST_ITERATOR dst_iterator = sypha_list_get_iterator_front(dst);
+
+        advance(writer, 3);
+        CHECK_LT(sypha_list_splice(dst_iterator, src, NULL, NULL), 0);
+        CHECK_LT(sypha_list_splice(dst_iterator, src, writer, NULL), 0);
+        CHECK_LT(sypha_list_concat(dst, src), 0);
+
+        // even a range the writer itself marks out, it would be left on an item of dst
+        CHECK_LT(sypha_list_splice(dst_iterator, src, writer, writer), 0);
+        sypha_list_destroy_iterator(writer);
+        sypha_list_destroy_iterator(dst_iterator);
+        check_int_list(dst, expected);
+        check_int_list(src, int_range(0, 10));
+
+        sypha_list_destroy(src);
+        sypha_list_destroy(dst);
+    }
+
+    SUBCASE("Ref items move with their ownership") {
+        SYPHA_LIST dst = sypha_list_create();
+        SYPHA_LIST src = sypha_list_create_pooled(16, 4);
+        struct destructor_log dst_log = { 0, 0 };
+        struct destructor_log src_log = { 0, 0 };
+
+        sypha_list_set_destructor(dst, free_and_log, &dst_log);
+        sypha_list_set_destructor(src, free_and_log, &src_log);
+        for (int i=0;i < 10;i++) {
+            sypha_list_append_ref(src, malloc(8), 8);
+        }
+
+        SYPHA_LIST_ITERATOR dst_iterator = sypha_list_get_iterator_front(dst);
+        SYPHA_LIST_ITERATOR end = sypha_list_get_read_iterator_front(src);
+        advance(end, 4);
+        CHECK_EQ(sypha_list_splice(dst_iterator, src, NULL, end), 0);
+        sypha_list_destroy_iterator(end);
+        sypha_list_destroy_iterator(dst_iterator);
+        CHECK_EQ(sypha_list_concat(dst, src), 0);
+
+        sypha_list_destroy(src);
+        CHECK_EQ(src_log.calls, 0);
+        sypha_list_destroy(dst);
+        CHECK_EQ(dst_log.calls, 10);
+    }
+}
+
+TEST_CASE("Read iterators") {
+    SYPHA_LIST list = make_int_list(sypha_list_create(), 0, 1000);
+    size_t valueSz;
+
+    SUBCASE("Readers share, writers don't") {
+        SYPHA_LIST_ITERATOR first = sypha_list_get_read_iterator_front(list);
+        SYPHA_LIST_ITERATOR second = sypha_list_get_read_iterator_back(list);
+        REQUIRE(first != NULL);
+        REQUIRE(second != NULL);
+        CHECK(sypha_list_get_iterator_front(list) == NULL);
+
+        advance(first, 10);
+        advance(second, 10);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(first, &valueSz)), 10);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(second, &valueSz)), 989);
+        CHECK_EQ(sypha_list_iterator_previous(first), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(first, &valueSz)), 9);
+
+        // readers can't change anything
+        int value = 0;
+        CHECK_LT(sypha_list_iterator_insert_after(first, &value, sizeof(value)), 0);
+        CHECK_LT(sypha_list_iterator_insert_before(first, &value, sizeof(value)), 0);
+        CHECK_LT(sypha_list_iterator_insert_after_ref(first, &value, sizeof(value)), 0);
+        CHECK_LT(sypha_list_iterator_insert_before_ref(first, &value, sizeof(value)), 0);
+        CHECK_LT(sypha_list_iterator_delete_current(first), 0);
+        CHECK(sypha_list_split_at(first) == NULL);
+
+        sypha_list_destroy_iterator(first);
+        CHECK(sypha_list_get_iterator_back(list) == NULL);
+        sypha_list_destroy_iterator(second);
+
+        // last reader gone, a writer can have it
+        SYPHA_LIST_ITERATOR writer = sypha_list_get_iterator_front(list);
+        REQUIRE(writer != NULL);
+        CHECK(sypha_list_get_iterator_front(list) == NULL);
+        CHECK(sypha_list_get_read_iterator_front(list) == NULL);
+        sypha_list_destroy_iterator(writer);
+        writer = sypha_list_get_iterator_back(list);
+        CHECK(writer != NULL);
+        sypha_list_destroy_iterator(writer);
+    }
+
+    SUBCASE("Changes make readers stale") {
+        SYPHA_LIST_ITERATOR reader = sypha_list_get_read_iterator_front(list);
+        int value = 1000;
+
+        advance(reader, 5);
+        sypha_list_append_item(list, &value, sizeof(value));
+        CHECK(sypha_list_iterator_get(reader, &valueSz) == NULL);
+        CHECK_LT(sypha_list_iterator_next(reader), 0);
+        CHECK_LT(sypha_list_iterator_previous(reader), 0);
+        sypha_list_destroy_iterator(reader);
+
+        // a fresh reader sees the change
+        reader = sypha_list_get_read_iterator_back(list);
+        advance(reader, 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(reader, &valueSz)), 1000);
+        sypha_list_destroy_iterator(reader);
+
+        // so do the ones made stale by a batch or a concat
+        SYPHA_LIST other = make_int_list(sypha_list_create(), 0, 10);
+        reader = sypha_list_get_read_iterator_front(other);
+        advance(reader, 0);
+        CHECK_EQ(sypha_list_concat(list, other), 0);
+        CHECK_LT(sypha_list_iterator_next(reader), 0);
+        sypha_list_destroy_iterator(reader);
+        sypha_list_destroy(other);
+    }
+
+    SUBCASE("Scan from several threads at once") {
+        const int threadCount = 4;
+        long long sums[threadCount];
+        std::vector<std::thread> threads;
+
+        for (int t=0;t < threadCount;t++) {
+            threads.push_back(std::thread([list, t, &sums]() {
+                SYPHA_LIST_ITERATOR reader = (t % 2) ? sypha_list_get_read_iterator_back(list) : sypha_list_get_read_iterator_front(list);
+                size_t sz;
+                sums[t] = 0;
+                while (sypha_list_iterator_next(reader) == 0) {
+                    sums[t] += *((int *) sypha_list_iterator_get(reader, &sz));
+                }
+                sypha_list_destroy_iterator(reader);
+            }));
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        for (int t=0;t < threadCount;t++) {
+            CHECK_EQ(sums[t], 999 * 1000 / 2);
+        }
+
+        // every reader let go
+        SYPHA_LIST_ITERATOR writer = sypha_list_get_iterator_front(list);
+        CHECK(writer != NULL);
+        sypha_list_destroy_iterator(writer);
+    }
+
+    sypha_list_destroy(list);
+}
+
+// Reads the whole list through batches of batch_sz and compares with a plain next / get walk
+static void check_batched(SYPHA_LIST list, int forward, size_t batch_sz) {
+    SYPHA_LIST_ITERATOR reader = (forward) ? sypha_list_get_read_iterator_front(list) : sypha_list_get_read_iterator_back(list);
+    SYPHA_LIST_ITERATOR walker = (forward) ? sypha_list_get_read_iterator_front(list) : sypha_list_get_read_iterator_back(list);
+    std::vector<void *> ptrs(batch_sz);
+    std::vector<size_t> sizes(batch_sz);
+    size_t count, valueSz;
+    REQUIRE(reader != NULL);
+    REQUIRE(walker != NULL);
+
+    while ((count = sypha_list_iterator_next_batch(reader, ptrs.data(), sizes.data(), batch_sz)) > 0) {
+        CHECK_LE(count, batch_sz);
+        for (size_t i=0;i < count;i++) {
+            REQUIRE_EQ(sypha_list_iterator_next(walker), 0);
+            CHECK_EQ(ptrs[i], sypha_list_iterator_get(walker, &valueSz));
+            CHECK_EQ(sizes[i], valueSz);
+        }
+        // iterator is left on the last one handed out
+        CHECK_EQ(sypha_list_iterator_get(reader, &valueSz), ptrs[count - 1]);
+    }
+    CHECK_LT(sypha_list_iterator_next(walker), 0);
+    CHECK_EQ(sypha_list_iterator_next_batch(reader, ptrs.data(), sizes.data(), batch_sz), 0);
+
+    sypha_list_destroy_iterator(reader);
+    sypha_list_destroy_iterator(walker);
+}
+
+TEST_CASE("Batched iteration") {
+    SYPHA_LIST list = make_int_list(sypha_list_create(), 0, 1000);
+    void * ptrs[16];
+    size_t sizes[16];
+    size_t valueSz;
+
+    SUBCASE("Forward") {
+        check_batched(list, 1, 1);
+        check_batched(list, 1, 7);
+        check_batched(list, 1, 1000);
+        check_batched(list, 1, 4096);
+    }
+
+    SUBCASE("Backward") {
+        check_batched(list, 0, 1);
+        check_batched(list, 0, 16);
+        check_batched(list, 0, 4096);
+    }
+
+    SUBCASE("Mixed with next and get") {
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+
+        CHECK_EQ(sypha_list_iterator_next_batch(iterator, ptrs, sizes, 0), 0);
+        CHECK(sypha_list_iterator_get(iterator, &valueSz) == NULL);
+
+        CHECK_EQ(sypha_list_iterator_next_batch(iterator, ptrs, NULL, 3), 3);
+        CHECK_EQ(*((int *) ptrs[0]), 0);
+        CHECK_EQ(*((int *) ptrs[2]), 2);
+        CHECK_EQ(sypha_list_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get(iterator, &valueSz)), 3);
+        CHECK_EQ(sypha_list_iterator_next_batch(iterator, ptrs, sizes, 2), 2);
+        CHECK_EQ(*((int *) ptrs[0]), 4);
+        CHECK_EQ(sizes[1], sizeof(int));
+
+        // a write iterator can carry on changing things from where the batch left it
+        CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+        CHECK_EQ(sypha_list_iterator_next_batch(iterator, ptrs, sizes, 1), 1);
+        CHECK_EQ(*((int *) ptrs[0]), 6);
+        sypha_list_destroy_iterator(iterator);
+    }
+
+    SUBCASE("Refs and stale readers") {
+        int value = 42;
+        sypha_list_prepend_ref(list, &value, sizeof(value));
+
+        SYPHA_LIST_ITERATOR reader = sypha_list_get_read_iterator_front(list);
+        REQUIRE(reader != NULL);
+        CHECK_EQ(sypha_list_iterator_next_batch(reader, ptrs, sizes, 2), 2);
+        CHECK_EQ(ptrs[0], (void *) &value);
+
+        sypha_list_append_item(list, &value, sizeof(value));
+        CHECK_EQ(sypha_list_iterator_next_batch(reader, ptrs, sizes, 2), 0);
+        sypha_list_destroy_iterator(reader);
+    }
+
+    SUBCASE("Empty list") {
+        SYPHA_LIST empty = sypha_list_create();
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_read_iterator_back(empty);
+        REQUIRE(iterator != NULL);
+        CHECK_EQ(sypha_list_iterator_next_batch(iterator, ptrs, sizes, 16), 0);
+        sypha_list_destroy_iterator(iterator);
+        sypha_list_destroy(empty);
+    }
+
+    sypha_list_destroy(list);
+}
+
+TEST_CASE("Inline iteration") {
+    SYPHA_LIST list = make_int_list(sypha_list_create(), 0, 1000);
+    size_t valueSz;
+    int * value;
+
+    CHECK_EQ(sypha_list_layout_version(), SYPHA_LIST_LAYOUT_VERSION);
+
+    SUBCASE("Same walk as the library calls") {
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_read_iterator_back(list);
+        REQUIRE(iterator != NULL);
+
+        CHECK(sypha_list_iterator_get_inline(iterator, &valueSz) == NULL);
+        CHECK_LT(sypha_list_iterator_previous_inline(iterator), 0);
+        for (int i=999;i >= 0;i--) {
+            value = (int *) sypha_list_iterator_next_get_inline(iterator, &valueSz);
+            REQUIRE(value != NULL);
+            CHECK_EQ(*value, i);
+            CHECK_EQ(valueSz, sizeof(int));
+        }
+        CHECK(sypha_list_iterator_next_get_inline(iterator, &valueSz) == NULL);
+        CHECK_EQ(sypha_list_iterator_previous_inline(iterator), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get_inline(iterator, &valueSz)), 1);
+
+        // inline and library calls share the iterator
+        CHECK_EQ(sypha_list_iterator_previous(iterator), 0);
+        CHECK_EQ(*((int *) sypha_list_iterator_get_inline(iterator, &valueSz)), 2);
+        sypha_list_destroy_iterator(iterator);
+    }
+
+    SUBCASE("Changes through the library") {
+        SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+
+        long long sum = 0;
+        while ((value = (int *) sypha_list_iterator_next_get_inline(iterator, &valueSz))) {
+            if (*value % 2) {
+                CHECK_EQ(sypha_list_iterator_delete_current(iterator), 0);
+            } else {
+                sum += *value;
+            }
+        }
+        CHECK_EQ(sum, 499 * 500);
+        sypha_list_destroy_iterator(iterator);
+
+        // stale readers are caught inline too
+        SYPHA_LIST_ITERATOR reader = sypha_list_get_read_iterator_front(list);
+        REQUIRE(reader != NULL);
+        CHECK(sypha_list_iterator_next_get_inline(reader, &valueSz) != NULL);
+        int extra = 7;
+        sypha_list_append_item(list, &extra, sizeof(extra));
+        CHECK(sypha_list_iterator_get_inline(reader, &valueSz) == NULL);
+        CHECK_LT(sypha_list_iterator_next_inline(reader), 0);
+        sypha_list_destroy_iterator(reader);
+    }
+
+    sypha_list_destroy(list);
+}
+
+struct keyed {
+    int key;
+    int order;
+};
+
+static int cmp_keyed(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+    int * compares = (int *) ctx;
+    if (compares) {
+        (*compares)++;
+    }
+    return ((const struct keyed *) a)->key - ((const struct keyed *) b)->key;
+}
+
+// Checks the list against what std::stable_sort does with the same items
+static void check_sorted(SYPHA_LIST list, std::vector<struct keyed> values) {
+    std::stable_sort(values.begin(), values.end(), [](const struct keyed & a, const struct keyed & b) {
+        return a.key < b.key;
+    });
+
+    SYPHA_LIST_ITERATOR iterator = sypha_list_get_iterator_front(list);
+    size_t valueSz;
+    size_t i = 0;
+    while (sypha_list_iterator_next(iterator) == 0) {
+        REQUIRE_LT(i, values.size());
+        struct keyed * value = (struct keyed *) sypha_list_iterator_get(iterator, &valueSz);
+        CHECK_EQ(value->key, values[i].key);
+        CHECK_EQ(value->order, values[i].order);
+        i++;
+    }
+    CHECK_EQ(i, values.size());
+    sypha_list_destroy_iterator(iterator);
+
+    // prev links have to agree
+    iterator = sypha_list_get_iterator_back(list);
+    while (sypha_list_iterator_next(iterator) == 0) {
+        REQUIRE_GT(i, 0);
+        i--;
+        CHECK_EQ(((struct keyed *) sypha_list_iterator_get(iterator, &valueSz))->order, values[i].order);
+    }
+    CHECK_EQ(i, 0);
+    sypha_list_destroy_iterator(iterator);
+}
+
+static std::vector<struct keyed> random_keyed(size_t count, int key_range, unsigned int seed) {
+    std::vector<struct keyed> values;
+    std::mt19937 rng(seed);
+    for (size_t i=0;i < count;i++) {
+        values.push_back({ (int) (rng() % key_range), (int) i });
+    }
+    return values;
+}
+
+TEST_CASE("Sort") {
+    SUBCASE("Small and degenerate lists") {
+        SYPHA_LIST list = sypha_list_create();
+        std::vector<struct keyed> values;
+
+        CHECK_LT(sypha_list_sort(list, NULL, NULL), 0);
+        CHECK_EQ(sypha_list_sort(list, cmp_keyed, NULL), 0);
+        check_sorted(list, values);
+
+        values.push_back({ 5, 0 });
+        sypha_list_append_item(list, &values[0], sizeof(struct keyed));
+        CHECK_EQ(sypha_list_sort(list, cmp_keyed, NULL), 0);
+        check_sorted(list, values);
+
+        values.push_back({ 1, 1 });
+        sypha_list_append_item(list, &values[1], sizeof(struct keyed));
+        CHECK_EQ(sypha_list_sort_parallel(list, cmp_keyed, NULL, 8), 0);
+        check_sorted(list, values);
+
+        sypha_list_destroy(list);
+    }
+
+    SUBCASE("Random, sorted and reversed input, stable") {
+        for (int shape=0;shape < 3;shape++) {
+            std::vector<struct keyed> values = random_keyed(5000, 100, shape);
+            if (shape == 1) {
+                std::stable_sort(values.begin(), values.end(), [](const struct keyed & a, const struct keyed & b) { return a.key < b.key; });
+            } else if (shape == 2) {
+                std::sort(values.begin(), values.end(), [](const struct keyed & a, const struct keyed & b) { return a.key > b.key; });
+            }
+
+            SYPHA_LIST list = sypha_list_create();
+            sypha_list_append_many(list, values.data(), sizeof(struct keyed), values.size());
+            int compares = 0;
+            CHECK_EQ(sypha_list_sort(list, cmp_keyed, &compares), 0);
+            check_sorted(list, values);
+
+            // already sorted is a single pass
+            if (shape == 1) {
+                CHECK_EQ(compares, 4999);
+            }
+            sypha_list_destroy(list);
+        }
+    }
+
+    SUBCASE("Parallel sort matches") {
+        std::vector<struct keyed> values = random_keyed(100000, 1000, 42);
+        for (size_t nthreads : { 0, 1, 3, 4, 64, 1000 }) {
+            SYPHA_LIST list = sypha_list_create_pooled(sizeof(struct keyed), 1024);
+            sypha_list_append_many(list, values.data(), sizeof(struct keyed), values.size());
+
+            CHECK_EQ(sypha_list_sort_parallel(list, cmp_keyed, NULL, nthreads), 0);
+            check_sorted(list, values);
+            sypha_list_destroy(list);
+        }
+    }
+
+    SUBCASE("Ref items sort by what they point at and readers go stale") {
+        std::vector<struct keyed> values = random_keyed(100, 10, 7);
+        SYPHA_LIST list = sypha_list_create();
+        for (auto & value : values) {
+            sypha_list_append_ref(list, &value, sizeof(value));
+        }
+
+        SYPHA_LIST_ITERATOR reader = sypha_list_get_read_iterator_front(list);
+        CHECK_EQ(sypha_list_iterator_next(reader), 0);
+        CHECK_EQ(sypha_list_sort(list, cmp_keyed, NULL), 0);
+        CHECK_LT(sypha_list_iterator_next(reader), 0);
+        sypha_list_destroy_iterator(reader);
+
+        check_sorted(list, values);
+        sypha_list_destroy(list);
+    }
+}
+
+static void triple(void * data, size_t data_sz, void * ctx) {
+    *((int *) data) *= 3;
+}
+
+static int keep_odd(const void * data, size_t data_sz, void * ctx) {
+    return *((const int *) data) % 2;
+}
+
+static void sum_ints(void * acc, const void * data, size_t data_sz, void * ctx) {
+    *((long long *) acc) += *((const int *) data);
+}
+
+static void sum_partials(void * acc, const void * partial, void * ctx) {
+    *((long long *) acc) += *((const long long *) partial);
+}
+
+// Order sensitive: collects the items' values into a vector, combine appends
+static void collect_ints(void * acc, const void * data, size_t data_sz, void * ctx) {
+    (*((std::vector<int> **) acc))->push_back(*((const int *) data));
+}
+
+static void append_partials(void * acc, const void * partial, void * ctx) {
+    std::vector<int> * into = *((std::vector<int> **) acc);
+    std::vector<int> * from = *((std::vector<int> * const *) partial);
+    into->insert(into->end(), from->begin(), from->end());
+    delete from;
+}
+
+// Runs the parallel algorithms with use_pool, which can be NULL
+static void check_parallel_algorithms(SYPHA_POOL use_pool) {
+    // For each, filter and reduce
+    {
+        SYPHA_LIST list = make_int_list(sypha_list_create_pooled(sizeof(int), 64), 0, 100000);
+        long long sum = 0, zero = 0;
+
+        CHECK_EQ(sypha_list_parallel_for_each(list, use_pool, triple, NULL), 0);
+        CHECK_EQ(sypha_list_parallel_reduce(list, use_pool, &sum, &zero, sizeof(sum), sum_ints, sum_partials, NULL), 0);
+        CHECK_EQ(sum, 3LL * 99999 * 100000 / 2);
+
+        // odd multiples of 3 stay
+        CHECK_EQ(sypha_list_parallel_filter(list, use_pool, keep_odd, NULL), 0);
+        std::vector<int> expected;
+        for (int i=1;i < 100000;i += 2) {
+            expected.push_back(i * 3);
+        }
+        check_int_list(list, expected);
+
+        // the list still works afterwards, dropped slots get recycled
+        int value = 7;
+        sypha_list_append_item(list, &value, sizeof(value));
+        expected.push_back(7);
+        check_int_list(list, expected);
+
+        sypha_list_destroy(list);
+    }
+
+    // Reduce combines in list order
+    {
+        SYPHA_LIST list = make_int_list(sypha_list_create(), 0, 5000);
+        std::vector<int> all;
+        std::vector<int> * acc = &all;
+
+        // each segment needs its own vector, so build them on demand from a null identity
+        struct {
+            static void reduce(void * acc, const void * data, size_t data_sz, void * ctx) {
+                std::vector<int> ** partial = (std::vector<int> **) acc;
+                if (!*partial) {
+                    *partial = new std::vector<int>();
+                }
+                collect_ints(acc, data, data_sz, ctx);
+            }
+        } fns;
+        std::vector<int> * identity = NULL;
+        CHECK_EQ(sypha_list_parallel_reduce(list, use_pool, &acc, &identity, sizeof(acc), fns.reduce, append_partials, NULL), 0);
+        CHECK_EQ(all, int_range(0, 5000));
+
+        sypha_list_destroy(list);
+    }
+
+    // Filter everything, nothing and an empty list
+    {
+        SYPHA_LIST list = make_int_list(sypha_list_create(), 0, 3000);
+        struct destructor_log log = { 0, 0 };
+        sypha_list_set_destructor(list, free_and_log, &log);
+        for (int i=0;i < 10;i++) {
+            int * owned = (int *) malloc(sizeof(int));
+            *owned = 2 * i;
+            sypha_list_append_ref(list, owned, sizeof(int));
+        }
+
+        CHECK_EQ(sypha_list_parallel_filter(list, use_pool, keep_odd, NULL), 0);
+        CHECK_EQ(log.calls, 10);
+        std::vector<int> odds;
+        for (int i=1;i < 3000;i += 2) {
+            odds.push_back(i);
+        }
+        check_int_list(list, odds);
+
+        // a live iterator keeps it from running
+        SYPHA_LIST_ITERATOR reader = sypha_list_get_read_iterator_front(list);
+        CHECK_LT(sypha_list_parallel_filter(list, use_pool, keep_odd, NULL), 0);
+        sypha_list_destroy_iterator(reader);
+
+        struct {
+            static int none(const void * data, size_t data_sz, void * ctx) {
+                return 0;
+            }
+        } fns;
+        CHECK_EQ(sypha_list_parallel_filter(list, use_pool, fns.none, NULL), 0);
+        check_int_list(list, std::vector<int>());
+        CHECK_EQ(sypha_list_parallel_filter(list, use_pool, fns.none, NULL), 0);
+
+        long long sum = 5, zero = 0;
+        CHECK_EQ(sypha_list_parallel_reduce(list, use_pool, &sum, &zero, sizeof(sum), sum_ints, sum_partials, NULL), 0);
+        CHECK_EQ(sum, 5);
+        CHECK_LT(sypha_list_parallel_reduce(list, use_pool, &sum, NULL, sizeof(sum), sum_ints, sum_partials, NULL), 0);
+        CHECK_LT(sypha_list_parallel_for_each(list, use_pool, NULL, NULL), 0);
+
+        sypha_list_destroy(list);
+    }
+}
+
+TEST_CASE("Parallel algorithms") {
+    SUBCASE("Without a pool") {
+        check_parallel_algorithms(NULL);
+    }
+
+    SUBCASE("On a pool") {
+        SYPHA_POOL pool = sypha_pool_create(4);
+        REQUIRE(pool != NULL);
+        check_parallel_algorithms(pool);
+        sypha_pool_destroy(pool);
+    }
+}
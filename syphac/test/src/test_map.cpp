@@ -0,0 +1,229 @@
+/* test_map.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_map.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+// Looks up every expected key and walks the map with an iterator, both have to agree with expected
+static void check_contents(SYPHA_MAP map, const std::map<std::string, std::string> & expected) {
+    SYPHA_MAP_ITERATOR iterator;
+    size_t value_sz;
+    size_t key_sz;
+
+    CHECK_EQ(sypha_map_count(map), expected.size());
+    for (auto & entry : expected) {
+        void * value = sypha_map_get(map, entry.first.data(), entry.first.size(), &value_sz);
+        REQUIRE(value != NULL);
+        CHECK_EQ(((uintptr_t) value) % 8, 0);
+        CHECK_EQ(std::string((const char *) value, value_sz), entry.second);
+    }
+
+    std::map<std::string, std::string> seen;
+    iterator = sypha_map_get_iterator(map);
+    REQUIRE(iterator != NULL);
+    CHECK(sypha_map_iterator_get(iterator, NULL) == NULL);
+    while (sypha_map_iterator_next(iterator) == 0) {
+        const void * key = sypha_map_iterator_get_key(iterator, &key_sz);
+        void * value = sypha_map_iterator_get(iterator, &value_sz);
+        REQUIRE(key != NULL);
+        REQUIRE(value != NULL);
+        CHECK(seen.insert({ std::string((const char *) key, key_sz), std::string((const char *) value, value_sz) }).second);
+    }
+    sypha_map_destroy_iterator(iterator);
+    CHECK(seen == expected);
+}
+
+static int put_string(SYPHA_MAP map, const std::string & key, const std::string & value) {
+    return sypha_map_put(map, key.data(), key.size(), value.data(), value.size());
+}
+
+// Lets a test make allocations fail on demand
+struct failing_ctx {
+    int fail;
+};
+
+static void * failing_alloc(void * ctx, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : malloc(sz);
+}
+
+static void * failing_realloc(void * ctx, void * ptr, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : realloc(ptr, sz);
+}
+
+static void failing_free(void * ctx, void * ptr) {
+    free(ptr);
+}
+
+TEST_CASE("Happy Path Map") {
+    SYPHA_MAP map = sypha_map_create();
+    REQUIRE(map != NULL);
+
+    std::map<std::string, std::string> expected;
+
+    SUBCASE("Empty map") {
+        CHECK(sypha_map_get(map, "a", 1, NULL) == NULL);
+        CHECK_LT(sypha_map_delete(map, "a", 1), 0);
+        check_contents(map, expected);
+    }
+
+    SUBCASE("Put, replace and delete") {
+        for (int i=0;i < 5000;i++) {
+            std::string key = "key" + std::to_string(i);
+            std::string value = std::string(i % 37, 'v') + std::to_string(i);
+            CHECK_EQ(put_string(map, key, value), 0);
+            expected[key] = value;
+        }
+        check_contents(map, expected);
+
+        // Same size values stay where they are, others move
+        size_t value_sz;
+        void * before = sypha_map_get(map, "key10", 5, NULL);
+        CHECK_EQ(put_string(map, "key10", "vvvvvvvvvvx0"), 0);
+        CHECK_EQ(sypha_map_get(map, "key10", 5, &value_sz), before);
+        CHECK_EQ(put_string(map, "key10", "longer than it was"), 0);
+        expected["key10"] = "longer than it was";
+        CHECK_EQ(value_sz, 12);
+
+        for (int i=0;i < 5000;i+=3) {
+            std::string key = "key" + std::to_string(i);
+            CHECK_EQ(sypha_map_delete(map, key.data(), key.size()), 0);
+            CHECK_LT(sypha_map_delete(map, key.data(), key.size()), 0);
+            expected.erase(key);
+        }
+        check_contents(map, expected);
+    }
+
+    SUBCASE("Odd keys") {
+        // Empty keys, embedded zeros and keys that only differ in length
+        CHECK_EQ(sypha_map_put(map, "", 0, "empty", 5), 0);
+        CHECK_EQ(sypha_map_put(map, "\0", 1, "zero", 4), 0);
+        CHECK_EQ(sypha_map_put(map, "\0\0", 2, "zeros", 5), 0);
+        CHECK_EQ(sypha_map_put(map, "a", 1, "", 0), 0);
+        std::string long_key(1000, 'k');
+        CHECK_EQ(put_string(map, long_key, "long"), 0);
+        expected[std::string()] = "empty";
+        expected[std::string(1, '\0')] = "zero";
+        expected[std::string(2, '\0')] = "zeros";
+        expected["a"] = "";
+        expected[long_key] = "long";
+        check_contents(map, expected);
+    }
+
+    SUBCASE("Entries don't move on growth") {
+        std::string key = "stable";
+        CHECK_EQ(put_string(map, key, "value"), 0);
+        void * value = sypha_map_get(map, key.data(), key.size(), NULL);
+        for (int i=0;i < 10000;i++) {
+            CHECK_EQ(sypha_map_put(map, &i, sizeof(i), &i, sizeof(i)), 0);
+        }
+        CHECK_EQ(sypha_map_get(map, key.data(), key.size(), NULL), value);
+        CHECK_EQ(sypha_map_count(map), 10001);
+    }
+
+    SUBCASE("Reserve and clear") {
+        CHECK_EQ(sypha_map_reserve(map, 1000), 0);
+        for (int i=0;i < 1000;i++) {
+            CHECK_EQ(sypha_map_put(map, &i, sizeof(i), &i, sizeof(i)), 0);
+        }
+        CHECK_EQ(sypha_map_count(map), 1000);
+        sypha_map_clear(map);
+        check_contents(map, expected);
+        int i = 5;
+        CHECK(sypha_map_get(map, &i, sizeof(i), NULL) == NULL);
+        CHECK_EQ(put_string(map, "again", "here"), 0);
+        expected["again"] = "here";
+        check_contents(map, expected);
+    }
+
+    SUBCASE("Delete while iterating") {
+        for (int i=0;i < 1000;i++) {
+            std::string key = std::to_string(i);
+            CHECK_EQ(put_string(map, key, key), 0);
+            if (i % 2) {
+                expected[key] = key;
+            }
+        }
+
+        SYPHA_MAP_ITERATOR iterator = sypha_map_get_iterator(map);
+        REQUIRE(iterator != NULL);
+        CHECK_LT(sypha_map_iterator_delete_current(iterator), 0);
+        size_t key_sz;
+        int visited = 0;
+        while (sypha_map_iterator_next(iterator) == 0) {
+            const char * key = (const char *) sypha_map_iterator_get_key(iterator, &key_sz);
+            visited++;
+            if (atoi(std::string(key, key_sz).c_str()) % 2 == 0) {
+                CHECK_EQ(sypha_map_iterator_delete_current(iterator), 0);
+                CHECK(sypha_map_iterator_get(iterator, NULL) == NULL);
+                CHECK_LT(sypha_map_iterator_delete_current(iterator), 0);
+            }
+        }
+        sypha_map_destroy_iterator(iterator);
+        CHECK_EQ(visited, 1000);
+        check_contents(map, expected);
+    }
+
+    SUBCASE("Failed allocations change nothing") {
+        struct failing_ctx ctx = { 0 };
+        SYPHA_ALLOCATOR allocator = { failing_alloc, failing_realloc, failing_free, &ctx };
+        SYPHA_MAP failing = sypha_map_create_with_allocator(&allocator);
+        REQUIRE(failing != NULL);
+
+        for (int i=0;i < 14;i++) {
+            std::string key = std::to_string(i);
+            CHECK_EQ(put_string(failing, key, key), 0);
+            expected[key] = key;
+        }
+        ctx.fail = 1;
+        CHECK_LT(put_string(failing, "new", "value"), 0);
+        CHECK_LT(put_string(failing, "1", "longer"), 0);
+        CHECK_LT(sypha_map_reserve(failing, 1000), 0);
+        ctx.fail = 0;
+        check_contents(failing, expected);
+        sypha_map_destroy(failing);
+    }
+
+    sypha_map_destroy(map);
+}
+
+TEST_CASE("Map churn") {
+    // Puts and deletes over a small key space leave lots of tombstones behind, the table has to
+    // clean them up rather than grow forever
+    SYPHA_MAP map = sypha_map_create();
+    REQUIRE(map != NULL);
+    std::map<std::string, std::string> expected;
+
+    srand(31);
+    for (int step=0;step < 200000;step++) {
+        int k = rand() % 500;
+        std::string key = std::to_string(k);
+        if (rand() % 2) {
+            std::string value = std::to_string(step);
+            CHECK_EQ(put_string(map, key, value), 0);
+            expected[key] = value;
+        } else {
+            CHECK_EQ(sypha_map_delete(map, key.data(), key.size()) == 0, expected.erase(key) == 1);
+        }
+    }
+    check_contents(map, expected);
+    sypha_map_destroy(map);
+}
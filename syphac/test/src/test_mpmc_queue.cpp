@@ -0,0 +1,177 @@
+/* test_mpmc_queue.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_mpmc_queue.h"
+#include <stdlib.h>
+#include <time.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Producer id and a per producer sequence number
+struct message {
+    int producer;
+    int sequence;
+    char payload[24];
+};
+
+TEST_CASE("Happy Path MPMC Queue") {
+    SYPHA_MPMC_QUEUE queue = sypha_mpmc_queue_create(sizeof(int), 100);
+    REQUIRE(queue != NULL);
+
+    SUBCASE("FIFO until full") {
+        CHECK_EQ(sypha_mpmc_queue_capacity(queue), 128);
+        int value;
+        CHECK_LT(sypha_mpmc_queue_try_pop(queue, &value), 0);
+
+        // Several laps round the ring
+        for (int lap=0;lap < 5;lap++) {
+            for (int i=0;i < 128;i++) {
+                CHECK_EQ(sypha_mpmc_queue_try_push(queue, &i), 0);
+            }
+            CHECK_EQ(sypha_mpmc_queue_count(queue), 128);
+            CHECK_LT(sypha_mpmc_queue_try_push(queue, &value), 0);
+            for (int i=0;i < 128;i++) {
+                CHECK_EQ(sypha_mpmc_queue_try_pop(queue, &value), 0);
+                CHECK_EQ(value, i);
+            }
+            CHECK_LT(sypha_mpmc_queue_try_pop(queue, &value), 0);
+            CHECK_EQ(sypha_mpmc_queue_count(queue), 0);
+        }
+    }
+
+    SUBCASE("Waiting calls") {
+        int value = 7;
+        sypha_mpmc_queue_push(queue, &value);
+        value = 0;
+        sypha_mpmc_queue_pop(queue, &value);
+        CHECK_EQ(value, 7);
+    }
+
+    SUBCASE("Bad arguments") {
+        CHECK(sypha_mpmc_queue_create(0, 16) == NULL);
+        SYPHA_MPMC_QUEUE tiny = sypha_mpmc_queue_create(1, 0);
+        REQUIRE(tiny != NULL);
+        CHECK_EQ(sypha_mpmc_queue_capacity(tiny), 2);
+        sypha_mpmc_queue_destroy(tiny);
+    }
+
+    sypha_mpmc_queue_destroy(queue);
+}
+
+// CPU time the calling thread has used, in seconds
+static double thread_cpu_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+TEST_CASE("MPMC Queue waiting calls park") {
+    SYPHA_MPMC_QUEUE queue = sypha_mpmc_queue_create(sizeof(int), 2);
+    REQUIRE(queue != NULL);
+
+    // A pop on an empty queue and a push on a full one sit for half a second each without
+    // burning CPU, and still see the push / pop that lets them through
+    double pop_cpu = 0.0;
+    int popped = 0;
+    std::thread popper([queue, &pop_cpu, &popped]() {
+        double start = thread_cpu_seconds();
+        sypha_mpmc_queue_pop(queue, &popped);
+        pop_cpu = thread_cpu_seconds() - start;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    int value = 42;
+    sypha_mpmc_queue_push(queue, &value);
+    popper.join();
+    CHECK_EQ(popped, 42);
+    CHECK_LT(pop_cpu, 0.1);
+
+    CHECK_EQ(sypha_mpmc_queue_try_push(queue, &value), 0);
+    CHECK_EQ(sypha_mpmc_queue_try_push(queue, &value), 0);
+    double push_cpu = 0.0;
+    std::thread pusher([queue, &push_cpu]() {
+        int last = 7;
+        double start = thread_cpu_seconds();
+        sypha_mpmc_queue_push(queue, &last);
+        push_cpu = thread_cpu_seconds() - start;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    sypha_mpmc_queue_pop(queue, &value);
+    pusher.join();
+    CHECK_LT(push_cpu, 0.1);
+    sypha_mpmc_queue_pop(queue, &value);
+    sypha_mpmc_queue_pop(queue, &value);
+    CHECK_EQ(value, 7);
+
+    sypha_mpmc_queue_destroy(queue);
+}
+
+TEST_CASE("MPMC Queue across threads") {
+    // A small ring so producers keep running into a full queue and consumers into an empty one
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 20000;
+    SYPHA_MPMC_QUEUE queue = sypha_mpmc_queue_create(sizeof(struct message), 64);
+    REQUIRE(queue != NULL);
+
+    std::vector<std::thread> threads;
+    std::vector<std::vector<int>> received(consumers * producers);
+    for (int p=0;p < producers;p++) {
+        threads.emplace_back([queue, p, per_producer]() {
+            struct message msg = { p, 0, { 0 } };
+            for (int i=0;i < per_producer;i++) {
+                msg.sequence = i;
+                msg.payload[i % sizeof(msg.payload)] = (char) i;
+                sypha_mpmc_queue_push(queue, &msg);
+            }
+        });
+    }
+    for (int c=0;c < consumers;c++) {
+        threads.emplace_back([queue, c, producers, &received]() {
+            struct message msg;
+            for (int i=0;i < producers * per_producer / consumers;i++) {
+                sypha_mpmc_queue_pop(queue, &msg);
+                received[c * producers + msg.producer].push_back(msg.sequence);
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+
+    // Every message came out exactly once, and each consumer saw every producer's messages in
+    // the order they were pushed
+    for (int p=0;p < producers;p++) {
+        std::vector<int> seen(per_producer, 0);
+        for (int c=0;c < consumers;c++) {
+            const std::vector<int> & got = received[c * producers + p];
+            for (size_t i=0;i < got.size();i++) {
+                seen[got[i]]++;
+                if (i > 0) {
+                    REQUIRE(got[i - 1] < got[i]);
+                }
+            }
+        }
+        for (int i=0;i < per_producer;i++) {
+            REQUIRE(seen[i] == 1);
+        }
+    }
+    CHECK_EQ(sypha_mpmc_queue_count(queue), 0);
+
+    sypha_mpmc_queue_destroy(queue);
+}
@@ -0,0 +1,120 @@
+/* test_pool.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_pool.h"
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+struct square_arg {
+    long value;
+    long result;
+};
+
+static void square(void * arg) {
+    struct square_arg * _arg = (struct square_arg *) arg;
+    _arg->result = _arg->value * _arg->value;
+}
+
+static void count_task(void * arg) {
+    __atomic_add_fetch((long *) *((long **) arg), 1, __ATOMIC_RELAXED);
+}
+
+struct nested_arg {
+    SYPHA_POOL pool;
+    long count;
+};
+
+// Runs a batch of its own on the pool it is running on
+static void nested_task(void * arg) {
+    struct nested_arg * _arg = (struct nested_arg *) arg;
+    std::vector<long *> args(10, &_arg->count);
+    sypha_pool_run(_arg->pool, count_task, args.data(), sizeof(long *), args.size());
+}
+
+TEST_CASE("Worker pool") {
+    SUBCASE("Runs every task once, batch after batch") {
+        for (size_t nthreads : { 1, 2, 4, 0 }) {
+            SYPHA_POOL pool = sypha_pool_create(nthreads);
+            REQUIRE(pool != NULL);
+            if (nthreads) {
+                CHECK_EQ(sypha_pool_thread_count(pool), nthreads);
+            } else {
+                CHECK_GE(sypha_pool_thread_count(pool), 1);
+            }
+
+            std::vector<struct square_arg> args(1000);
+            for (int batch=0;batch < 50;batch++) {
+                for (size_t i=0;i < args.size();i++) {
+                    args[i].value = (long) (i + batch);
+                    args[i].result = -1;
+                }
+                // batches of every size, down to nothing
+                size_t count = args.size() - batch * 20;
+                CHECK_EQ(sypha_pool_run(pool, square, args.data(), sizeof(struct square_arg), count), 0);
+                for (size_t i=0;i < args.size();i++) {
+                    CHECK_EQ(args[i].result, (i < count) ? args[i].value * args[i].value : -1);
+                }
+            }
+
+            CHECK_EQ(sypha_pool_run(pool, square, args.data(), sizeof(struct square_arg), 0), 0);
+            CHECK_LT(sypha_pool_run(pool, NULL, args.data(), sizeof(struct square_arg), 1), 0);
+            sypha_pool_destroy(pool);
+        }
+        sypha_pool_destroy(NULL);
+    }
+
+    SUBCASE("A task can run a batch on its own pool") {
+        SYPHA_POOL pool = sypha_pool_create(4);
+        std::vector<struct nested_arg> args(20);
+        for (auto & arg : args) {
+            arg.pool = pool;
+            arg.count = 0;
+        }
+
+        CHECK_EQ(sypha_pool_run(pool, nested_task, args.data(), sizeof(struct nested_arg), args.size()), 0);
+        for (auto & arg : args) {
+            CHECK_EQ(arg.count, 10);
+        }
+
+        sypha_pool_destroy(pool);
+    }
+
+    SUBCASE("Batches from several threads take turns") {
+        SYPHA_POOL pool = sypha_pool_create(3);
+        long counts[4] = { 0, 0, 0, 0 };
+        std::vector<std::thread> threads;
+
+        for (int t=0;t < 4;t++) {
+            threads.push_back(std::thread([pool, t, &counts]() {
+                std::vector<long *> args(100, &counts[t]);
+                for (int batch=0;batch < 100;batch++) {
+                    sypha_pool_run(pool, count_task, args.data(), sizeof(long *), args.size());
+                }
+            }));
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        for (int t=0;t < 4;t++) {
+            CHECK_EQ(counts[t], 100 * 100);
+        }
+
+        sypha_pool_destroy(pool);
+    }
+}
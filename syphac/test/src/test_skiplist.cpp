@@ -0,0 +1,261 @@
+/* test_skiplist.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_skiplist.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Ordered by key only so equal keys show whether insertion order is kept
+struct event {
+    int key;
+    int id;
+};
+
+static int cmp_event(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+    int a_key = ((const struct event *) a)->key;
+    int b_key = ((const struct event *) b)->key;
+    (*((int *) ctx))++;
+    return (a_key > b_key) - (a_key < b_key);
+}
+
+static bool event_less(const struct event & a, const struct event & b) {
+    return a.key < b.key;
+}
+
+// Walks the skip list both ways and compares against the expected (sorted) contents
+static void check_contents(SYPHA_SKIPLIST skiplist, const std::vector<struct event> & expected) {
+    SYPHA_SKIPLIST_ITERATOR iterator;
+    struct event * item;
+    size_t data_sz;
+
+    CHECK_EQ(sypha_skiplist_count(skiplist), expected.size());
+
+    iterator = sypha_skiplist_get_iterator_front(skiplist);
+    REQUIRE(iterator != NULL);
+    CHECK(sypha_skiplist_iterator_get(iterator, NULL) == NULL);
+    for (size_t i=0;i < expected.size();i++) {
+        CHECK_EQ(sypha_skiplist_iterator_next(iterator), 0);
+        item = (struct event *) sypha_skiplist_iterator_get(iterator, &data_sz);
+        CHECK_EQ(data_sz, sizeof(struct event));
+        CHECK_EQ(item->key, expected[i].key);
+        CHECK_EQ(item->id, expected[i].id);
+    }
+    CHECK_LT(sypha_skiplist_iterator_next(iterator), 0);
+    sypha_skiplist_destroy_iterator(iterator);
+
+    iterator = sypha_skiplist_get_iterator_back(skiplist);
+    REQUIRE(iterator != NULL);
+    for (size_t i=expected.size();i > 0;i--) {
+        CHECK_EQ(sypha_skiplist_iterator_next(iterator), 0);
+        CHECK_EQ(((struct event *) sypha_skiplist_iterator_get(iterator, NULL))->id, expected[i - 1].id);
+    }
+    CHECK_LT(sypha_skiplist_iterator_next(iterator), 0);
+    sypha_skiplist_destroy_iterator(iterator);
+}
+
+// Lets a test make allocations fail on demand
+struct failing_ctx {
+    int fail;
+};
+
+static void * failing_alloc(void * ctx, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : malloc(sz);
+}
+
+static void * failing_realloc(void * ctx, void * ptr, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : realloc(ptr, sz);
+}
+
+static void failing_free(void * ctx, void * ptr) {
+    free(ptr);
+}
+
+TEST_CASE("Happy Path Skip List") {
+    int compares = 0;
+    SYPHA_SKIPLIST skiplist = sypha_skiplist_create(cmp_event, &compares);
+    REQUIRE(skiplist != NULL);
+
+    std::vector<struct event> expected;
+
+    SUBCASE("Empty skip list") {
+        struct event key = { 1, 0 };
+        CHECK_LT(sypha_skiplist_delete(skiplist, &key, sizeof(key)), 0);
+        CHECK(sypha_skiplist_find(skiplist, &key, sizeof(key), NULL) == NULL);
+        SYPHA_SKIPLIST_ITERATOR iterator = sypha_skiplist_get_iterator_lower_bound(skiplist, &key, sizeof(key));
+        REQUIRE(iterator != NULL);
+        CHECK_LT(sypha_skiplist_iterator_next(iterator), 0);
+        CHECK_LT(sypha_skiplist_iterator_previous(iterator), 0);
+        CHECK_LT(sypha_skiplist_iterator_delete_current(iterator), 0);
+        sypha_skiplist_destroy_iterator(iterator);
+        check_contents(skiplist, expected);
+    }
+
+    SUBCASE("Insert, find and delete") {
+        srand(41);
+        for (int i=0;i < 5000;i++) {
+            struct event item = { rand() % 1000, i };
+            CHECK_EQ(sypha_skiplist_insert(skiplist, &item, sizeof(item)), 0);
+            expected.insert(std::upper_bound(expected.begin(), expected.end(), item, event_less), item);
+        }
+        check_contents(skiplist, expected);
+
+        // Logarithmic, nowhere near the 5000 * 2500 a sorted list insert takes
+        CHECK_LT(compares, 5000 * 60);
+
+        for (int key=0;key < 1000;key+=7) {
+            struct event probe = { key, -1 };
+            auto first = std::lower_bound(expected.begin(), expected.end(), probe, event_less);
+            size_t data_sz;
+            struct event * found = (struct event *) sypha_skiplist_find(skiplist, &probe, sizeof(probe), &data_sz);
+            if (first == expected.end() || first->key != key) {
+                CHECK(found == NULL);
+                CHECK_LT(sypha_skiplist_delete(skiplist, &probe, sizeof(probe)), 0);
+            } else {
+                REQUIRE(found != NULL);
+                CHECK_EQ(found->id, first->id);
+                CHECK_EQ(sypha_skiplist_delete(skiplist, &probe, sizeof(probe)), 0);
+                expected.erase(first);
+            }
+        }
+        check_contents(skiplist, expected);
+    }
+
+    SUBCASE("Lower bound iterators") {
+        for (int i=0;i < 100;i++) {
+            struct event item = { (i / 2) * 10, i };
+            CHECK_EQ(sypha_skiplist_insert(skiplist, &item, sizeof(item)), 0);
+        }
+
+        struct event key = { 245, 0 };
+        SYPHA_SKIPLIST_ITERATOR iterator = sypha_skiplist_get_iterator_lower_bound(skiplist, &key, sizeof(key));
+        REQUIRE(iterator != NULL);
+        CHECK(sypha_skiplist_iterator_get(iterator, NULL) == NULL);
+        CHECK_EQ(sypha_skiplist_iterator_next(iterator), 0);
+        CHECK_EQ(((struct event *) sypha_skiplist_iterator_get(iterator, NULL))->id, 50);
+        CHECK_EQ(sypha_skiplist_iterator_previous(iterator), 0);
+        CHECK_EQ(((struct event *) sypha_skiplist_iterator_get(iterator, NULL))->id, 49);
+        sypha_skiplist_destroy_iterator(iterator);
+
+        // From before it, previous goes to the last item less than the key
+        key.key = 250;
+        iterator = sypha_skiplist_get_iterator_lower_bound(skiplist, &key, sizeof(key));
+        REQUIRE(iterator != NULL);
+        CHECK_EQ(sypha_skiplist_iterator_previous(iterator), 0);
+        CHECK_EQ(((struct event *) sypha_skiplist_iterator_get(iterator, NULL))->id, 49);
+        sypha_skiplist_destroy_iterator(iterator);
+
+        // Past the end
+        key.key = 1000;
+        iterator = sypha_skiplist_get_iterator_lower_bound(skiplist, &key, sizeof(key));
+        REQUIRE(iterator != NULL);
+        CHECK_LT(sypha_skiplist_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_skiplist_iterator_previous(iterator), 0);
+        CHECK_EQ(((struct event *) sypha_skiplist_iterator_get(iterator, NULL))->id, 99);
+        sypha_skiplist_destroy_iterator(iterator);
+    }
+
+    SUBCASE("Delete while iterating") {
+        for (int i=0;i < 1000;i++) {
+            struct event item = { i % 10, i };
+            CHECK_EQ(sypha_skiplist_insert(skiplist, &item, sizeof(item)), 0);
+            expected.insert(std::upper_bound(expected.begin(), expected.end(), item, event_less), item);
+        }
+
+        // Drop every odd id, equal keys make the unlink walk past neighbours
+        SYPHA_SKIPLIST_ITERATOR iterator = sypha_skiplist_get_iterator_back(skiplist);
+        REQUIRE(iterator != NULL);
+        while (sypha_skiplist_iterator_next(iterator) == 0) {
+            struct event * item = (struct event *) sypha_skiplist_iterator_get(iterator, NULL);
+            if (item->id % 2) {
+                CHECK_EQ(sypha_skiplist_iterator_delete_current(iterator), 0);
+            }
+        }
+        sypha_skiplist_destroy_iterator(iterator);
+        expected.erase(std::remove_if(expected.begin(), expected.end(), [](const struct event & e) { return e.id % 2; }), expected.end());
+        check_contents(skiplist, expected);
+
+        // Deleting the first item leaves the iterator before the new first one
+        iterator = sypha_skiplist_get_iterator_front(skiplist);
+        REQUIRE(iterator != NULL);
+        CHECK_EQ(sypha_skiplist_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_skiplist_iterator_delete_current(iterator), 0);
+        CHECK(sypha_skiplist_iterator_get(iterator, NULL) == NULL);
+        CHECK_LT(sypha_skiplist_iterator_delete_current(iterator), 0);
+        CHECK_EQ(sypha_skiplist_iterator_next(iterator), 0);
+        CHECK_EQ(((struct event *) sypha_skiplist_iterator_get(iterator, NULL))->id, expected[1].id);
+        sypha_skiplist_destroy_iterator(iterator);
+        expected.erase(expected.begin());
+        check_contents(skiplist, expected);
+    }
+
+    SUBCASE("Failed allocations change nothing") {
+        struct failing_ctx ctx = { 0 };
+        SYPHA_ALLOCATOR allocator = { failing_alloc, failing_realloc, failing_free, &ctx };
+        SYPHA_SKIPLIST failing = sypha_skiplist_create_with_allocator(&allocator, cmp_event, &compares);
+        REQUIRE(failing != NULL);
+
+        for (int i=0;i < 50;i++) {
+            struct event item = { 50 - i, i };
+            CHECK_EQ(sypha_skiplist_insert(failing, &item, sizeof(item)), 0);
+            expected.insert(expected.begin(), item);
+        }
+        ctx.fail = 1;
+        struct event item = { 25, 100 };
+        CHECK_LT(sypha_skiplist_insert(failing, &item, sizeof(item)), 0);
+        CHECK(sypha_skiplist_get_iterator_front(failing) == NULL);
+        ctx.fail = 0;
+        check_contents(failing, expected);
+        sypha_skiplist_destroy(failing);
+    }
+
+    SUBCASE("No comparator") {
+        CHECK(sypha_skiplist_create(NULL, NULL) == NULL);
+    }
+
+    sypha_skiplist_destroy(skiplist);
+}
+
+static int cmp_string(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+    int ret = memcmp(a, b, (a_sz < b_sz) ? a_sz : b_sz);
+    return (ret) ? ret : (a_sz > b_sz) - (a_sz < b_sz);
+}
+
+TEST_CASE("Skip list of variable sized items") {
+    SYPHA_SKIPLIST skiplist = sypha_skiplist_create(cmp_string, NULL);
+    REQUIRE(skiplist != NULL);
+
+    std::vector<std::string> words = { "pear", "apple", "fig", "banana", "apples", "", "kiwi" };
+    for (auto & word : words) {
+        CHECK_EQ(sypha_skiplist_insert(skiplist, word.data(), word.size()), 0);
+    }
+    std::sort(words.begin(), words.end());
+
+    SYPHA_SKIPLIST_ITERATOR iterator = sypha_skiplist_get_iterator_front(skiplist);
+    REQUIRE(iterator != NULL);
+    size_t data_sz;
+    for (auto & word : words) {
+        CHECK_EQ(sypha_skiplist_iterator_next(iterator), 0);
+        const char * data = (const char *) sypha_skiplist_iterator_get(iterator, &data_sz);
+        CHECK_EQ(std::string(data, data_sz), word);
+    }
+    sypha_skiplist_destroy_iterator(iterator);
+    sypha_skiplist_destroy(skiplist);
+}
@@ -0,0 +1,227 @@
+/* test_ulist.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_ulist.h"
+#include <stdlib.h>
+#include <vector>
+
+// Walks the whole list both ways and compares against the expected contents
+static void check_contents(SYPHA_ULIST list, const std::vector<int> & expected) {
+    SYPHA_ULIST_ITERATOR iterator;
+
+    CHECK_EQ(sypha_ulist_count(list), expected.size());
+
+    iterator = sypha_ulist_get_iterator_front(list);
+    REQUIRE(iterator != NULL);
+    for (size_t i=0;i < expected.size();i++) {
+        CHECK_EQ(sypha_ulist_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_ulist_iterator_get(iterator)), expected[i]);
+    }
+    CHECK_LT(sypha_ulist_iterator_next(iterator), 0);
+    sypha_ulist_destroy_iterator(iterator);
+
+    iterator = sypha_ulist_get_iterator_back(list);
+    REQUIRE(iterator != NULL);
+    for (size_t i=expected.size();i > 0;i--) {
+        CHECK_EQ(sypha_ulist_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_ulist_iterator_get(iterator)), expected[i - 1]);
+    }
+    CHECK_LT(sypha_ulist_iterator_next(iterator), 0);
+    sypha_ulist_destroy_iterator(iterator);
+}
+
+TEST_CASE("Happy Path Unrolled List") {
+    SYPHA_ULIST list = sypha_ulist_create(sizeof(int), 4);
+    REQUIRE(list != NULL);
+
+    std::vector<int> expected;
+
+    SUBCASE("Append and prepend across nodes") {
+        for (int i=0;i < 50;i++) {
+            CHECK_EQ(sypha_ulist_append_item(list, &i), 0);
+            expected.push_back(i);
+        }
+        for (int i=-1;i > -50;i--) {
+            CHECK_EQ(sypha_ulist_prepend_item(list, &i), 0);
+            expected.insert(expected.begin(), i);
+        }
+        check_contents(list, expected);
+    }
+
+    SUBCASE("Insert into full nodes") {
+        for (int i=0;i < 8;i++) {
+            CHECK_EQ(sypha_ulist_append_item(list, &i), 0);
+            expected.push_back(i);
+        }
+
+        SYPHA_ULIST_ITERATOR iterator = sypha_ulist_get_iterator_front(list);
+        REQUIRE(iterator != NULL);
+        CHECK_EQ(sypha_ulist_iterator_next(iterator), 0);
+        CHECK_EQ(sypha_ulist_iterator_next(iterator), 0);
+
+        // Splits the first node, iterator has to stay on 1
+        int value = 100;
+        CHECK_EQ(sypha_ulist_iterator_insert_before(iterator, &value), 0);
+        CHECK_EQ(*((int *) sypha_ulist_iterator_get(iterator)), 1);
+        expected.insert(expected.begin() + 1, value);
+
+        value = 101;
+        CHECK_EQ(sypha_ulist_iterator_insert_after(iterator, &value), 0);
+        CHECK_EQ(*((int *) sypha_ulist_iterator_get(iterator)), 1);
+        expected.insert(expected.begin() + 3, value);
+
+        CHECK_EQ(sypha_ulist_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_ulist_iterator_get(iterator)), 101);
+
+        sypha_ulist_destroy_iterator(iterator);
+        check_contents(list, expected);
+    }
+
+    sypha_ulist_destroy(list);
+}
+
+// Drives the list through random iterator operations and mirrors them on a vector
+static void random_walk(size_t elems_per_node, int forward) {
+    SYPHA_ULIST list = sypha_ulist_create(sizeof(int), elems_per_node);
+    REQUIRE(list != NULL);
+
+    std::vector<int> expected;
+    for (int i=0;i < 20;i++) {
+        CHECK_EQ(sypha_ulist_append_item(list, &i), 0);
+        expected.push_back(i);
+    }
+
+    SYPHA_ULIST_ITERATOR iterator = (forward) ? sypha_ulist_get_iterator_front(list) : sypha_ulist_get_iterator_back(list);
+    REQUIRE(iterator != NULL);
+
+    // Model of the iterator, pos is the physical index of the current item
+    int pristine = 1;
+    long pos = (forward) ? 0 : (long) expected.size() - 1;
+    int value = 1000;
+
+    srand(17);
+    for (int step=0;step < 20000;step++) {
+        long size = (long) expected.size();
+        // second half leans toward deletes so the list drains and refills
+        int op = rand() % ((step < 10000) ? 6 : 9);
+        int ret;
+
+        if (op == 0) {
+            ret = sypha_ulist_iterator_next(iterator);
+            if (size == 0) {
+                CHECK_LT(ret, 0);
+            } else if (pristine) {
+                CHECK_EQ(ret, 0);
+                pristine = 0;
+            } else if (forward ? (pos + 1 < size) : (pos > 0)) {
+                CHECK_EQ(ret, 0);
+                pos += (forward) ? 1 : -1;
+            } else {
+                CHECK_LT(ret, 0);
+            }
+        } else if (op == 1) {
+            ret = sypha_ulist_iterator_previous(iterator);
+            if (size == 0 || pristine) {
+                CHECK_LT(ret, 0);
+            } else if (forward ? (pos > 0) : (pos + 1 < size)) {
+                CHECK_EQ(ret, 0);
+                pos += (forward) ? -1 : 1;
+            } else {
+                CHECK_LT(ret, 0);
+            }
+        } else if (op == 2) {
+            value++;
+            CHECK_EQ(sypha_ulist_iterator_insert_after(iterator, &value), 0);
+            if (pristine || size == 0) {
+                // lands at the head of the iteration and the iterator moves onto it
+                if (forward) {
+                    expected.insert(expected.begin(), value);
+                    pos = 0;
+                } else {
+                    expected.push_back(value);
+                    pos = size;
+                }
+            } else if (forward) {
+                expected.insert(expected.begin() + pos + 1, value);
+            } else {
+                expected.insert(expected.begin() + pos, value);
+                pos++;
+            }
+        } else if (op == 3) {
+            value++;
+            ret = sypha_ulist_iterator_insert_before(iterator, &value);
+            if (pristine || size == 0) {
+                CHECK_LT(ret, 0);
+            } else {
+                CHECK_EQ(ret, 0);
+                if (forward) {
+                    expected.insert(expected.begin() + pos, value);
+                    pos++;
+                } else {
+                    expected.insert(expected.begin() + pos + 1, value);
+                }
+            }
+        } else if (op >= 4 && op != 5 && size > 0) {
+            ret = sypha_ulist_iterator_delete_current(iterator);
+            if (pristine) {
+                CHECK_LT(ret, 0);
+            } else {
+                CHECK_EQ(ret, 0);
+                expected.erase(expected.begin() + pos);
+                size--;
+                if (forward) {
+                    if (pos > 0) {
+                        pos--;
+                    } else {
+                        pristine = 1;
+                    }
+                } else if (pos == size) {
+                    pos = size - 1;
+                    pristine = 1;
+                }
+            }
+        }
+
+        int * got = (int *) sypha_ulist_iterator_get(iterator);
+        if (pristine || expected.empty()) {
+            CHECK(got == NULL);
+        } else {
+            REQUIRE(got != NULL);
+            CHECK_EQ(*got, expected[pos]);
+        }
+    }
+
+    sypha_ulist_destroy_iterator(iterator);
+    check_contents(list, expected);
+    sypha_ulist_destroy(list);
+}
+
+TEST_CASE("Random walk Unrolled List") {
+    SUBCASE("Forward, small nodes") {
+        random_walk(4, 1);
+    }
+    SUBCASE("Backward, small nodes") {
+        random_walk(4, 0);
+    }
+    SUBCASE("Forward, default nodes") {
+        random_walk(0, 1);
+    }
+    SUBCASE("Backward, one item nodes") {
+        random_walk(1, 0);
+    }
+}
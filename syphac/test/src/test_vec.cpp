@@ -0,0 +1,282 @@
+/* test_vec.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphac/sypha_vec.h"
+#include <stdlib.h>
+#include <vector>
+
+// Walks the whole vector both ways and compares against the expected contents
+static void check_contents(SYPHA_VEC vec, const std::vector<int> & expected) {
+    SYPHA_VEC_ITERATOR iterator;
+    size_t valueSz;
+
+    CHECK_EQ(sypha_vec_count(vec), expected.size());
+    for (size_t i=0;i < expected.size();i++) {
+        CHECK_EQ(*((int *) sypha_vec_get(vec, i)), expected[i]);
+    }
+    CHECK(sypha_vec_get(vec, expected.size()) == NULL);
+
+    iterator = sypha_vec_get_iterator_front(vec);
+    REQUIRE(iterator != NULL);
+    for (size_t i=0;i < expected.size();i++) {
+        CHECK_EQ(sypha_vec_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_vec_iterator_get(iterator, &valueSz)), expected[i]);
+        CHECK_EQ(valueSz, sizeof(int));
+    }
+    CHECK_LT(sypha_vec_iterator_next(iterator), 0);
+    sypha_vec_destroy_iterator(iterator);
+
+    iterator = sypha_vec_get_iterator_back(vec);
+    REQUIRE(iterator != NULL);
+    for (size_t i=expected.size();i > 0;i--) {
+        CHECK_EQ(sypha_vec_iterator_next(iterator), 0);
+        CHECK_EQ(*((int *) sypha_vec_iterator_get(iterator, NULL)), expected[i - 1]);
+    }
+    CHECK_LT(sypha_vec_iterator_next(iterator), 0);
+    sypha_vec_destroy_iterator(iterator);
+}
+
+// Lets a test make realloc fail on demand
+struct failing_ctx {
+    int fail;
+};
+
+static void * failing_alloc(void * ctx, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : malloc(sz);
+}
+
+static void * failing_realloc(void * ctx, void * ptr, size_t sz) {
+    return (((struct failing_ctx *) ctx)->fail) ? NULL : realloc(ptr, sz);
+}
+
+static void failing_free(void * ctx, void * ptr) {
+    free(ptr);
+}
+
+TEST_CASE("Happy Path Vector") {
+    SYPHA_VEC vec = sypha_vec_create(sizeof(int));
+    REQUIRE(vec != NULL);
+
+    std::vector<int> expected;
+
+    SUBCASE("Append and prepend") {
+        CHECK(sypha_vec_data(vec) == NULL);
+        for (int i=0;i < 1000;i++) {
+            CHECK_EQ(sypha_vec_append_item(vec, &i), 0);
+            expected.push_back(i);
+        }
+        for (int i=-1;i > -50;i--) {
+            CHECK_EQ(sypha_vec_prepend_item(vec, &i), 0);
+            expected.insert(expected.begin(), i);
+        }
+        check_contents(vec, expected);
+        CHECK_EQ(((int *) sypha_vec_data(vec))[49], 0);
+    }
+
+    SUBCASE("Append many") {
+        std::vector<int> values;
+        for (int i=0;i < 5000;i++) {
+            values.push_back(i * 3);
+        }
+        CHECK_EQ(sypha_vec_append_many(vec, values.data(), 10), 0);
+        CHECK_EQ(sypha_vec_append_many(vec, values.data() + 10, 0), 0);
+        CHECK_EQ(sypha_vec_append_many(vec, values.data() + 10, values.size() - 10), 0);
+        check_contents(vec, values);
+    }
+
+    SUBCASE("Reserve, shrink and clear") {
+        CHECK_EQ(sypha_vec_reserve(vec, 1000), 0);
+        CHECK_EQ(sypha_vec_capacity(vec), 1000);
+        void * data = sypha_vec_data(vec);
+        for (int i=0;i < 1000;i++) {
+            CHECK_EQ(sypha_vec_append_item(vec, &i), 0);
+            expected.push_back(i);
+        }
+        // never had to move
+        CHECK_EQ(sypha_vec_data(vec), data);
+        CHECK_EQ(sypha_vec_reserve(vec, 10), 0);
+        CHECK_EQ(sypha_vec_capacity(vec), 1000);
+
+        int value = 1000;
+        CHECK_EQ(sypha_vec_append_item(vec, &value), 0);
+        expected.push_back(value);
+        CHECK_GT(sypha_vec_capacity(vec), 1001);
+        CHECK_EQ(sypha_vec_shrink(vec), 0);
+        CHECK_EQ(sypha_vec_capacity(vec), 1001);
+        check_contents(vec, expected);
+
+        sypha_vec_clear(vec);
+        CHECK_EQ(sypha_vec_capacity(vec), 1001);
+        check_contents(vec, std::vector<int>());
+        CHECK_EQ(sypha_vec_shrink(vec), 0);
+        CHECK_EQ(sypha_vec_capacity(vec), 0);
+        CHECK_EQ(sypha_vec_append_item(vec, &value), 0);
+        check_contents(vec, std::vector<int>({ 1000 }));
+    }
+
+    SUBCASE("Failed growth changes nothing") {
+        struct failing_ctx ctx = { 0 };
+        SYPHA_ALLOCATOR allocator = { failing_alloc, failing_realloc, failing_free, &ctx };
+        SYPHA_VEC failing = sypha_vec_create_with_allocator(&allocator, sizeof(int));
+        REQUIRE(failing != NULL);
+
+        for (int i=0;i < 16;i++) {
+            CHECK_EQ(sypha_vec_append_item(failing, &i), 0);
+            expected.push_back(i);
+        }
+        ctx.fail = 1;
+        int values[4] = { 1, 2, 3, 4 };
+        CHECK_LT(sypha_vec_append_item(failing, &values[0]), 0);
+        CHECK_LT(sypha_vec_append_many(failing, values, 4), 0);
+        CHECK_LT(sypha_vec_reserve(failing, 100), 0);
+        ctx.fail = 0;
+        check_contents(failing, expected);
+        sypha_vec_destroy(failing);
+    }
+
+    SUBCASE("Bad element size") {
+        CHECK(sypha_vec_create(0) == NULL);
+    }
+
+    sypha_vec_destroy(vec);
+}
+
+// Drives the vector through random iterator operations and mirrors them on a std::vector
+static void random_walk(int forward) {
+    SYPHA_VEC vec = sypha_vec_create(sizeof(int));
+    REQUIRE(vec != NULL);
+
+    std::vector<int> expected;
+    for (int i=0;i < 20;i++) {
+        CHECK_EQ(sypha_vec_append_item(vec, &i), 0);
+        expected.push_back(i);
+    }
+
+    SYPHA_VEC_ITERATOR iterator = (forward) ? sypha_vec_get_iterator_front(vec) : sypha_vec_get_iterator_back(vec);
+    REQUIRE(iterator != NULL);
+
+    // Model of the iterator, pos is the physical index of the current item
+    int pristine = 1;
+    long pos = (forward) ? 0 : (long) expected.size() - 1;
+    int value = 1000;
+
+    srand(29);
+    for (int step=0;step < 20000;step++) {
+        long size = (long) expected.size();
+        // second half leans toward deletes so the vector drains and refills
+        int op = rand() % ((step < 10000) ? 6 : 9);
+        int ret;
+
+        if (op == 0) {
+            ret = sypha_vec_iterator_next(iterator);
+            if (size == 0) {
+                CHECK_LT(ret, 0);
+            } else if (pristine) {
+                CHECK_EQ(ret, 0);
+                pristine = 0;
+            } else if (forward ? (pos + 1 < size) : (pos > 0)) {
+                CHECK_EQ(ret, 0);
+                pos += (forward) ? 1 : -1;
+            } else {
+                CHECK_LT(ret, 0);
+            }
+        } else if (op == 1) {
+            ret = sypha_vec_iterator_previous(iterator);
+            if (size == 0 || pristine) {
+                CHECK_LT(ret, 0);
+            } else if (forward ? (pos > 0) : (pos + 1 < size)) {
+                CHECK_EQ(ret, 0);
+                pos += (forward) ? -1 : 1;
+            } else {
+                CHECK_LT(ret, 0);
+            }
+        } else if (op == 2) {
+            value++;
+            CHECK_EQ(sypha_vec_iterator_insert_after(iterator, &value), 0);
+            if (pristine || size == 0) {
+                // lands at the head of the iteration and the iterator moves onto it
+                if (forward) {
+                    expected.insert(expected.begin(), value);
+                    pos = 0;
+                } else {
+                    expected.push_back(value);
+                    pos = size;
+                }
+            } else if (forward) {
+                expected.insert(expected.begin() + pos + 1, value);
+            } else {
+                expected.insert(expected.begin() + pos, value);
+                pos++;
+            }
+        } else if (op == 3) {
+            value++;
+            ret = sypha_vec_iterator_insert_before(iterator, &value);
+            if (pristine || size == 0) {
+                CHECK_LT(ret, 0);
+            } else {
+                CHECK_EQ(ret, 0);
+                if (forward) {
+                    expected.insert(expected.begin() + pos, value);
+                    pos++;
+                } else {
+                    expected.insert(expected.begin() + pos + 1, value);
+                }
+            }
+        } else if (op >= 4 && op != 5 && size > 0) {
+            ret = sypha_vec_iterator_delete_current(iterator);
+            if (pristine) {
+                CHECK_LT(ret, 0);
+            } else {
+                CHECK_EQ(ret, 0);
+                expected.erase(expected.begin() + pos);
+                size--;
+                if (forward) {
+                    if (pos > 0) {
+                        pos--;
+                    } else {
+                        pristine = 1;
+                    }
+                } else if (pos == size) {
+                    pos = size - 1;
+                    pristine = 1;
+                }
+            }
+        }
+
+        int * got = (int *) sypha_vec_iterator_get(iterator, NULL);
+        if (pristine || expected.empty()) {
+            CHECK(got == NULL);
+        } else {
+            REQUIRE(got != NULL);
+            CHECK_EQ(*got, expected[pos]);
+        }
+    }
+
+    sypha_vec_destroy_iterator(iterator);
+    check_contents(vec, expected);
+    sypha_vec_destroy(vec);
+}
+
+TEST_CASE("Random walk Vector") {
+    SUBCASE("Forward") {
+        random_walk(1);
+    }
+    SUBCASE("Backward") {
+        random_walk(0);
+    }
+}
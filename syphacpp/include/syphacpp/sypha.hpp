@@ -18,7 +18,14 @@
 #ifndef _SYPHA_HPP_
 #define _SYPHA_HPP_
 
+#include "syphacpp/sypha_deque.hpp"
 #include "syphacpp/sypha_env.hpp"
+#include "syphacpp/sypha_heap.hpp"
+#include "syphacpp/sypha_map.hpp"
+#include "syphacpp/sypha_mpmc_queue.hpp"
 #include "syphacpp/sypha_opt.hpp"
+#include "syphacpp/sypha_processor.hpp"
+#include "syphacpp/sypha_skiplist.hpp"
+#include "syphacpp/sypha_vec.hpp"
 
 #endif // _SYPHA_HPP_
@@ -0,0 +1,83 @@
+/* sypha_deque.hpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _SYPHA_DEQUE_HPP_
+#define _SYPHA_DEQUE_HPP_
+
+#include <exception>
+#include <type_traits>
+#include "syphac/sypha_deque.h"
+
+namespace sypha {
+
+    // Typed SYPHA_DEQUE.  Elements are copied around as raw bytes so T has to be trivially
+    // copyable.  A moved-from Deque is only good for destroying.
+
+    template <typename T>
+    class Deque {
+        static_assert(std::is_trivially_copyable<T>::value, "sypha::Deque needs a trivially copyable type");
+
+        private:
+            SYPHA_DEQUE m_deque;
+
+        public:
+            Deque() : m_deque(sypha_deque_create(sizeof(T))) {
+                if (!m_deque) {
+                    throw std::exception();
+                }
+            }
+            Deque(Deque && other) : m_deque(other.m_deque) {
+                other.m_deque = NULL;
+            }
+            Deque(const Deque &) = delete;
+            Deque & operator=(const Deque &) = delete;
+            ~Deque() {
+                sypha_deque_destroy(m_deque);
+            }
+
+            size_t count() const { return sypha_deque_count(m_deque); }
+            size_t capacity() const { return sypha_deque_capacity(m_deque); }
+            bool empty() const { return count() == 0; }
+
+            // Returns false on allocation error, leaving the Deque as it was
+            bool pushBack(const T & value) { return sypha_deque_push_back(m_deque, &value) == 0; }
+            bool pushFront(const T & value) { return sypha_deque_push_front(m_deque, &value) == 0; }
+            bool reserve(size_t count) { return sypha_deque_reserve(m_deque, count) == 0; }
+
+            // Returns false if empty
+            bool popBack(T & value) { return sypha_deque_pop_back(m_deque, &value) == 0; }
+            bool popFront(T & value) { return sypha_deque_pop_front(m_deque, &value) == 0; }
+            bool popBack() { return sypha_deque_pop_back(m_deque, NULL) == 0; }
+            bool popFront() { return sypha_deque_pop_front(m_deque, NULL) == 0; }
+
+            void shrink() { sypha_deque_shrink(m_deque); }
+            void clear() { sypha_deque_clear(m_deque); }
+
+            // Element at index counting from the front, NULL if out of range
+            T * at(size_t index) const { return (T *) sypha_deque_at(m_deque, index); }
+
+            // Unchecked access
+            T & operator[](size_t index) const { return *at(index); }
+
+            // First / last element, NULL if empty
+            T * front() const { return (T *) sypha_deque_front(m_deque); }
+            T * back() const { return (T *) sypha_deque_back(m_deque); }
+    };
+
+} // namespace sypha
+
+#endif // _SYPHA_DEQUE_HPP_
@@ -0,0 +1,93 @@
+/* sypha_heap.hpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _SYPHA_HEAP_HPP_
+#define _SYPHA_HEAP_HPP_
+
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include "syphac/sypha_heap.h"
+
+namespace sypha {
+
+    // Typed SYPHA_HEAP, the smallest element by Compare comes out first (the opposite of
+    // std::priority_queue).  Compare is default constructed for every comparison so it shouldn't
+    // carry state.  Elements are copied around as raw bytes so T has to be trivially copyable.  A
+    // moved-from Heap is only good for destroying.
+
+    template <typename T, typename Compare = std::less<T>>
+    class Heap {
+        static_assert(std::is_trivially_copyable<T>::value, "sypha::Heap needs a trivially copyable type");
+
+        private:
+            SYPHA_HEAP m_heap;
+
+            static int compare(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+                Compare less;
+                if (less(*((const T *) a), *((const T *) b))) {
+                    return -1;
+                }
+                return (less(*((const T *) b), *((const T *) a))) ? 1 : 0;
+            }
+
+        public:
+            typedef SYPHA_HEAP_HANDLE Handle;
+
+            Heap() : m_heap(sypha_heap_create(sizeof(T), compare, NULL)) {
+                if (!m_heap) {
+                    throw std::exception();
+                }
+            }
+            Heap(Heap && other) : m_heap(other.m_heap) {
+                other.m_heap = NULL;
+            }
+            Heap(const Heap &) = delete;
+            Heap & operator=(const Heap &) = delete;
+            ~Heap() {
+                sypha_heap_destroy(m_heap);
+            }
+
+            size_t count() const { return sypha_heap_count(m_heap); }
+            bool empty() const { return count() == 0; }
+
+            // Returns false on allocation error, leaving the Heap as it was.  Fills in the new
+            // elements' handles unless NULL.
+            bool push(const T & value, Handle * handle = NULL) { return sypha_heap_push(m_heap, &value, handle) == 0; }
+            bool pushMany(const T * values, size_t count, Handle * handles = NULL) { return sypha_heap_push_many(m_heap, values, count, handles) == 0; }
+            bool reserve(size_t count) { return sypha_heap_reserve(m_heap, count) == 0; }
+
+            void clear() { sypha_heap_clear(m_heap); }
+
+            // Smallest element, NULL if empty
+            T * top() const { return (T *) sypha_heap_peek(m_heap); }
+
+            // Returns false if empty
+            bool pop(T & value) { return sypha_heap_pop(m_heap, &value) == 0; }
+            bool pop() { return sypha_heap_pop(m_heap, NULL) == 0; }
+
+            // Element named by handle, NULL if the handle isn't live
+            T * get(Handle handle) const { return (T *) sypha_heap_get(m_heap, handle); }
+
+            // Returns false if the handle isn't live
+            bool update(Handle handle, const T & value) { return sypha_heap_update(m_heap, handle, &value) == 0; }
+            bool remove(Handle handle) { return sypha_heap_remove(m_heap, handle, NULL) == 0; }
+    };
+
+} // namespace sypha
+
+#endif // _SYPHA_HEAP_HPP_
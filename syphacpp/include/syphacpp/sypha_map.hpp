@@ -0,0 +1,122 @@
+/* sypha_map.hpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _SYPHA_MAP_HPP_
+#define _SYPHA_MAP_HPP_
+
+#include <exception>
+#include <string>
+#include <type_traits>
+#include "syphac/sypha_map.h"
+
+namespace sypha {
+
+    // SYPHA_MAP keyed by strings.  Values are copied around as raw bytes so V has to be trivially
+    // copyable.  A moved-from Map is only good for destroying.
+
+    template <typename V>
+    class Map {
+        static_assert(std::is_trivially_copyable<V>::value, "sypha::Map needs a trivially copyable value type");
+
+        public:
+            // Mirrors SYPHA_MAP_ITERATOR, visits the entries in no particular order
+            class Iterator {
+                private:
+                    SYPHA_MAP_ITERATOR m_iterator;
+
+                public:
+                    explicit Iterator(SYPHA_MAP_ITERATOR iterator) : m_iterator(iterator) {
+                        if (!m_iterator) {
+                            throw std::exception();
+                        }
+                    }
+                    Iterator(Iterator && other) : m_iterator(other.m_iterator) {
+                        other.m_iterator = NULL;
+                    }
+                    Iterator(const Iterator &) = delete;
+                    Iterator & operator=(const Iterator &) = delete;
+                    ~Iterator() {
+                        sypha_map_destroy_iterator(m_iterator);
+                    }
+
+                    // Returns false at end-of-iterator
+                    bool next() { return sypha_map_iterator_next(m_iterator) == 0; }
+
+                    // Current entry's key, empty before the first entry
+                    std::string key() const {
+                        size_t key_sz;
+                        const char * key = (const char *) sypha_map_iterator_get_key(m_iterator, &key_sz);
+                        return (key) ? std::string(key, key_sz) : std::string();
+                    }
+
+                    // Current entry's value, NULL before the first entry
+                    V * get() const { return (V *) sypha_map_iterator_get(m_iterator, NULL); }
+
+                    // Returns false if nothing was deleted
+                    bool deleteCurrent() { return sypha_map_iterator_delete_current(m_iterator) == 0; }
+            };
+
+        private:
+            SYPHA_MAP m_map;
+
+        public:
+            Map() : m_map(sypha_map_create()) {
+                if (!m_map) {
+                    throw std::exception();
+                }
+            }
+            Map(Map && other) : m_map(other.m_map) {
+                other.m_map = NULL;
+            }
+            Map(const Map &) = delete;
+            Map & operator=(const Map &) = delete;
+            ~Map() {
+                sypha_map_destroy(m_map);
+            }
+
+            size_t count() const { return sypha_map_count(m_map); }
+
+            // Returns false on allocation error, leaving the Map as it was
+            bool put(const std::string & key, const V & value) { return sypha_map_put(m_map, key.data(), key.size(), &value, sizeof(V)) == 0; }
+            bool reserve(size_t count) { return sypha_map_reserve(m_map, count) == 0; }
+
+            // Returns false if key wasn't there
+            bool remove(const std::string & key) { return sypha_map_delete(m_map, key.data(), key.size()) == 0; }
+
+            void clear() { sypha_map_clear(m_map); }
+
+            // Stored value for key, NULL if it isn't there.  Good until the entry is replaced or removed.
+            V * get(const std::string & key) const { return (V *) sypha_map_get(m_map, key.data(), key.size(), NULL); }
+
+            // Copies the value for key out, returns false if it isn't there
+            bool get(const std::string & key, V & value) const {
+                V * stored = get(key);
+                if (!stored) {
+                    return false;
+                }
+                value = *stored;
+                return true;
+            }
+
+            bool contains(const std::string & key) const { return get(key) != NULL; }
+
+            Iterator iterator() const { return Iterator(sypha_map_get_iterator(m_map)); }
+    };
+
+} // namespace sypha
+
+#endif // _SYPHA_MAP_HPP_
@@ -0,0 +1,74 @@
+/* sypha_mpmc_queue.hpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _SYPHA_MPMC_QUEUE_HPP_
+#define _SYPHA_MPMC_QUEUE_HPP_
+
+#include <exception>
+#include <type_traits>
+#include "syphac/sypha_mpmc_queue.h"
+
+namespace sypha {
+
+    // Typed SYPHA_MPMC_QUEUE, safe to share between any number of producer and consumer threads.
+    // Items are copied around as raw bytes so T has to be trivially copyable.  A moved-from
+    // MpmcQueue is only good for destroying.
+
+    template <typename T>
+    class MpmcQueue {
+        static_assert(std::is_trivially_copyable<T>::value, "sypha::MpmcQueue needs a trivially copyable type");
+
+        private:
+            SYPHA_MPMC_QUEUE m_queue;
+
+        public:
+            // Holds capacity items rounded up to a power of 2
+            explicit MpmcQueue(size_t capacity) : m_queue(sypha_mpmc_queue_create(sizeof(T), capacity)) {
+                if (!m_queue) {
+                    throw std::exception();
+                }
+            }
+            MpmcQueue(MpmcQueue && other) : m_queue(other.m_queue) {
+                other.m_queue = NULL;
+            }
+            MpmcQueue(const MpmcQueue &) = delete;
+            MpmcQueue & operator=(const MpmcQueue &) = delete;
+            ~MpmcQueue() {
+                sypha_mpmc_queue_destroy(m_queue);
+            }
+
+            size_t capacity() const { return sypha_mpmc_queue_capacity(m_queue); }
+
+            // Only a snapshot while other threads are using the queue
+            size_t count() const { return sypha_mpmc_queue_count(m_queue); }
+
+            // Don't wait, return false if full / empty
+            bool tryPush(const T & item) { return sypha_mpmc_queue_try_push(m_queue, &item) == 0; }
+            bool tryPop(T & item) { return sypha_mpmc_queue_try_pop(m_queue, &item) == 0; }
+
+            // Wait for room / an item, parking the thread if it takes a while
+            void push(const T & item) { sypha_mpmc_queue_push(m_queue, &item); }
+            T pop() {
+                T item;
+                sypha_mpmc_queue_pop(m_queue, &item);
+                return item;
+            }
+    };
+
+} // namespace sypha
+
+#endif // _SYPHA_MPMC_QUEUE_HPP_
@@ -0,0 +1,188 @@
+/* sypha_processor.hpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _SYPHA_PROCESSOR_HPP_
+#define _SYPHA_PROCESSOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "syphacpp/sypha_mpmc_queue.hpp"
+
+namespace sypha {
+
+    // Native take on syphapy's QueueProcessor: producer threads fill a queue that consumer threads
+    // drain, with the same lifecycle (startProducers / startConsumers / startAll, the stop and
+    // join calls, stopAll draining gracefully).  Workers are OS threads over a MpmcQueue so
+    // CPU-bound consumers aren't held to one core.
+    //
+    // Items go through the queue as raw bytes, so Item has to be trivially copyable (pass an index
+    // or pointer for anything bigger).  A subclass has to stop the processor (stopAll, or the stop
+    // and join calls) before its own destructor finishes, the workers call into it.  Destroying a
+    // processor whose workers haven't been joined terminates the program.
+
+    template <typename Item>
+    class QueueProcessor {
+        static_assert(std::is_trivially_copyable<Item>::value, "sypha::QueueProcessor needs a trivially copyable item type");
+
+        private:
+            // Poisoned slots tell a consumer to stop
+            struct Slot {
+                Item item;
+                bool poison;
+            };
+
+            MpmcQueue<Slot> m_queue;
+            size_t m_producerCount;
+            std::chrono::milliseconds m_producerThrottle;
+            size_t m_consumerCount;
+
+            std::atomic<bool> m_stopProducers;
+            std::vector<std::thread> m_producers;
+            std::vector<std::thread> m_consumers;
+
+            void runProducer(size_t tid) {
+                std::vector<Item> items;
+                Slot slot = Slot();
+
+                while (!m_stopProducers.load(std::memory_order_acquire)) {
+                    items.clear();
+                    if (!produce(tid, items)) {
+                        // Nothing more is coming
+                        break;
+                    }
+
+                    if (items.empty()) {
+                        std::this_thread::sleep_for(m_producerThrottle);
+                        continue;
+                    }
+                    for (const Item & item : items) {
+                        // Parks while the queue is full, which is ok
+                        slot.item = item;
+                        m_queue.push(slot);
+                    }
+                }
+            }
+
+            void runConsumer(size_t tid) {
+                Slot slot;
+
+                while (true) {
+                    // Parks while the queue is empty, see MpmcQueue::pop
+                    slot = m_queue.pop();
+                    if (slot.poison) {
+                        break;
+                    }
+                    consume(tid, slot.item);
+                }
+            }
+
+        public:
+            // The counts are the number of respective worker threads to create.  The throttle is how
+            // long an idle producer (one that produced nothing) sleeps before trying again, idle
+            // consumers and producers facing a full queue park in the queue's waiting calls.
+            explicit QueueProcessor(size_t capacity = 1024, size_t producerCount = 1, std::chrono::milliseconds producerThrottle = std::chrono::milliseconds(100),
+                size_t consumerCount = 1)
+                : m_queue(capacity), m_producerCount(producerCount), m_producerThrottle(producerThrottle),
+                  m_consumerCount(consumerCount), m_stopProducers(false) {
+            }
+            QueueProcessor(const QueueProcessor &) = delete;
+            QueueProcessor & operator=(const QueueProcessor &) = delete;
+            virtual ~QueueProcessor() {
+                // Stopping here would be too late, the subclass the workers call into is gone
+                if (!m_producers.empty() || !m_consumers.empty()) {
+                    std::terminate();
+                }
+            }
+
+            // Called over and over by each producer thread.  Appends zero or more items to items
+            // and returns true, or returns false once there is nothing left and the producer
+            // should halt.  No items means nothing right now, the producer sleeps a throttle
+            // period and asks again.  Must not block indefinitely.
+            virtual bool produce(size_t producerTid, std::vector<Item> & items) = 0;
+
+            // Called by a consumer thread for each item it takes off the queue
+            virtual void consume(size_t consumerTid, Item & item) = 0;
+
+            // Starts producer threads
+            void startProducers() {
+                m_stopProducers.store(false, std::memory_order_release);
+                for (size_t i=0;i < m_producerCount;i++) {
+                    m_producers.emplace_back(&QueueProcessor::runProducer, this, i);
+                }
+            }
+
+            // Starts consumer threads
+            void startConsumers() {
+                for (size_t i=0;i < m_consumerCount;i++) {
+                    m_consumers.emplace_back(&QueueProcessor::runConsumer, this, i);
+                }
+            }
+
+            // Starts all producer and consumer threads
+            void startAll() {
+                startProducers();
+                startConsumers();
+            }
+
+            // Signal producer threads to stop after their current produce call
+            void stopProducers() {
+                m_stopProducers.store(true, std::memory_order_release);
+            }
+
+            // Wait for producer threads to finish (blocks!)
+            void joinProducers() {
+                for (std::thread & producer : m_producers) {
+                    producer.join();
+                }
+                m_producers.clear();
+            }
+
+            // Signal consumer threads to stop once they get through what's queued so far
+            void stopConsumers() {
+                Slot slot = Slot();
+                slot.poison = true;
+                for (size_t i=0;i < m_consumers.size();i++) {
+                    // Parks while the queue is full, the consumers are still draining it
+                    m_queue.push(slot);
+                }
+            }
+
+            // Wait for consumer threads to finish (blocks!)
+            void joinConsumers() {
+                for (std::thread & consumer : m_consumers) {
+                    consumer.join();
+                }
+                m_consumers.clear();
+            }
+
+            // Gracefully stops the processor, leaving no produced items unprocessed.  Blocks until
+            // all workers stop.
+            void stopAll() {
+                stopProducers();
+                joinProducers();
+                stopConsumers();
+                joinConsumers();
+            }
+    };
+
+} // namespace sypha
+
+#endif // _SYPHA_PROCESSOR_HPP_
@@ -0,0 +1,113 @@
+/* sypha_skiplist.hpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _SYPHA_SKIPLIST_HPP_
+#define _SYPHA_SKIPLIST_HPP_
+
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include "syphac/sypha_skiplist.h"
+
+namespace sypha {
+
+    // Typed SYPHA_SKIPLIST ordered by Compare, which is default constructed for every comparison
+    // so it shouldn't carry state.  Elements are copied around as raw bytes so T has to be
+    // trivially copyable.  A moved-from SkipList is only good for destroying.
+
+    template <typename T, typename Compare = std::less<T>>
+    class SkipList {
+        static_assert(std::is_trivially_copyable<T>::value, "sypha::SkipList needs a trivially copyable type");
+
+        private:
+            SYPHA_SKIPLIST m_skiplist;
+
+            static int compare(const void * a, size_t a_sz, const void * b, size_t b_sz, void * ctx) {
+                Compare less;
+                if (less(*((const T *) a), *((const T *) b))) {
+                    return -1;
+                }
+                return (less(*((const T *) b), *((const T *) a))) ? 1 : 0;
+            }
+
+        public:
+            // Mirrors SYPHA_SKIPLIST_ITERATOR
+            class Iterator {
+                private:
+                    SYPHA_SKIPLIST_ITERATOR m_iterator;
+
+                public:
+                    explicit Iterator(SYPHA_SKIPLIST_ITERATOR iterator) : m_iterator(iterator) {
+                        if (!m_iterator) {
+                            throw std::exception();
+                        }
+                    }
+                    Iterator(Iterator && other) : m_iterator(other.m_iterator) {
+                        other.m_iterator = NULL;
+                    }
+                    Iterator(const Iterator &) = delete;
+                    Iterator & operator=(const Iterator &) = delete;
+                    ~Iterator() {
+                        sypha_skiplist_destroy_iterator(m_iterator);
+                    }
+
+                    // Returns false at end-of-iterator
+                    bool next() { return sypha_skiplist_iterator_next(m_iterator) == 0; }
+                    bool previous() { return sypha_skiplist_iterator_previous(m_iterator) == 0; }
+
+                    // Current element, NULL if not on one
+                    T * get() const { return (T *) sypha_skiplist_iterator_get(m_iterator, NULL); }
+
+                    // Returns false if nothing was deleted
+                    bool deleteCurrent() { return sypha_skiplist_iterator_delete_current(m_iterator) == 0; }
+            };
+
+            SkipList() : m_skiplist(sypha_skiplist_create(compare, NULL)) {
+                if (!m_skiplist) {
+                    throw std::exception();
+                }
+            }
+            SkipList(SkipList && other) : m_skiplist(other.m_skiplist) {
+                other.m_skiplist = NULL;
+            }
+            SkipList(const SkipList &) = delete;
+            SkipList & operator=(const SkipList &) = delete;
+            ~SkipList() {
+                sypha_skiplist_destroy(m_skiplist);
+            }
+
+            size_t count() const { return sypha_skiplist_count(m_skiplist); }
+
+            // Returns false on allocation error
+            bool insert(const T & value) { return sypha_skiplist_insert(m_skiplist, &value, sizeof(T)) == 0; }
+
+            // Removes the first element equivalent to value, returns false if there is none
+            bool remove(const T & value) { return sypha_skiplist_delete(m_skiplist, &value, sizeof(T)) == 0; }
+
+            // First element equivalent to value, NULL if there is none
+            T * find(const T & value) const { return (T *) sypha_skiplist_find(m_skiplist, &value, sizeof(T), NULL); }
+
+            Iterator front() const { return Iterator(sypha_skiplist_get_iterator_front(m_skiplist)); }
+            Iterator back() const { return Iterator(sypha_skiplist_get_iterator_back(m_skiplist)); }
+
+            // A "next" call moves to the first element not less than value
+            Iterator lowerBound(const T & value) const { return Iterator(sypha_skiplist_get_iterator_lower_bound(m_skiplist, &value, sizeof(T))); }
+    };
+
+} // namespace sypha
+
+#endif // _SYPHA_SKIPLIST_HPP_
@@ -0,0 +1,112 @@
+/* sypha_vec.hpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _SYPHA_VEC_HPP_
+#define _SYPHA_VEC_HPP_
+
+#include <exception>
+#include <type_traits>
+#include "syphac/sypha_vec.h"
+
+namespace sypha {
+
+    // Typed SYPHA_VEC.  Elements are copied around as raw bytes so T has to be trivially copyable.
+    // A moved-from Vec is only good for destroying.
+
+    template <typename T>
+    class Vec {
+        static_assert(std::is_trivially_copyable<T>::value, "sypha::Vec needs a trivially copyable type");
+
+        public:
+            // Mirrors SYPHA_VEC_ITERATOR, only one in use at a time while changing the Vec
+            class Iterator {
+                private:
+                    SYPHA_VEC_ITERATOR m_iterator;
+
+                public:
+                    explicit Iterator(SYPHA_VEC_ITERATOR iterator) : m_iterator(iterator) {
+                        if (!m_iterator) {
+                            throw std::exception();
+                        }
+                    }
+                    Iterator(Iterator && other) : m_iterator(other.m_iterator) {
+                        other.m_iterator = NULL;
+                    }
+                    Iterator(const Iterator &) = delete;
+                    Iterator & operator=(const Iterator &) = delete;
+                    ~Iterator() {
+                        sypha_vec_destroy_iterator(m_iterator);
+                    }
+
+                    // Returns false at end-of-iterator
+                    bool next() { return sypha_vec_iterator_next(m_iterator) == 0; }
+                    bool previous() { return sypha_vec_iterator_previous(m_iterator) == 0; }
+
+                    // Current element, NULL before the first one
+                    T * get() const { return (T *) sypha_vec_iterator_get(m_iterator, NULL); }
+
+                    // Returns false if nothing was changed
+                    bool insertAfter(const T & value) { return sypha_vec_iterator_insert_after(m_iterator, (void *) &value) == 0; }
+                    bool insertBefore(const T & value) { return sypha_vec_iterator_insert_before(m_iterator, (void *) &value) == 0; }
+                    bool deleteCurrent() { return sypha_vec_iterator_delete_current(m_iterator) == 0; }
+            };
+
+        private:
+            SYPHA_VEC m_vec;
+
+        public:
+            Vec() : m_vec(sypha_vec_create(sizeof(T))) {
+                if (!m_vec) {
+                    throw std::exception();
+                }
+            }
+            Vec(Vec && other) : m_vec(other.m_vec) {
+                other.m_vec = NULL;
+            }
+            Vec(const Vec &) = delete;
+            Vec & operator=(const Vec &) = delete;
+            ~Vec() {
+                sypha_vec_destroy(m_vec);
+            }
+
+            size_t count() const { return sypha_vec_count(m_vec); }
+            size_t capacity() const { return sypha_vec_capacity(m_vec); }
+
+            // Returns false on allocation error, leaving the Vec as it was
+            bool append(const T & value) { return sypha_vec_append_item(m_vec, (void *) &value) == 0; }
+            bool prepend(const T & value) { return sypha_vec_prepend_item(m_vec, (void *) &value) == 0; }
+            bool appendMany(const T * values, size_t count) { return sypha_vec_append_many(m_vec, values, count) == 0; }
+            bool reserve(size_t count) { return sypha_vec_reserve(m_vec, count) == 0; }
+            bool shrink() { return sypha_vec_shrink(m_vec) == 0; }
+
+            void clear() { sypha_vec_clear(m_vec); }
+
+            // Element at index, NULL if out of range
+            T * get(size_t index) const { return (T *) sypha_vec_get(m_vec, index); }
+
+            // Unchecked access and the elements as a range, good until the next change
+            T & operator[](size_t index) const { return ((T *) sypha_vec_data(m_vec))[index]; }
+            T * begin() const { return (T *) sypha_vec_data(m_vec); }
+            T * end() const { return begin() + count(); }
+
+            Iterator front() const { return Iterator(sypha_vec_get_iterator_front(m_vec)); }
+            Iterator back() const { return Iterator(sypha_vec_get_iterator_back(m_vec)); }
+    };
+
+} // namespace sypha
+
+#endif // _SYPHA_VEC_HPP_
@@ -0,0 +1,65 @@
+/* test_deque.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphacpp/sypha_deque.hpp"
+#include <utility>
+
+using namespace sypha;
+
+struct Point {
+    int x;
+    int y;
+};
+
+TEST_CASE("Typed deque") {
+    Deque<Point> d;
+
+    SUBCASE("Both ends") {
+        CHECK(d.empty());
+        CHECK(d.front() == NULL);
+        for (int i=0;i < 1000;i++) {
+            CHECK(d.pushBack({ i, -i }));
+            CHECK(d.pushFront({ -i, i }));
+        }
+        CHECK_EQ(d.count(), 2000);
+        CHECK_EQ(d.front()->x, -999);
+        CHECK_EQ(d.back()->x, 999);
+        CHECK_EQ(d[1000].x, 0);
+        CHECK(d.at(2000) == NULL);
+
+        Point p;
+        CHECK(d.popFront(p));
+        CHECK_EQ(p.x, -999);
+        CHECK(d.popBack(p));
+        CHECK_EQ(p.x, 999);
+        CHECK(d.popBack());
+        CHECK_EQ(d.count(), 1997);
+
+        d.clear();
+        CHECK_FALSE(d.popFront());
+        CHECK_GE(d.capacity(), 2000);
+        d.shrink();
+    }
+
+    SUBCASE("Move") {
+        CHECK(d.reserve(100));
+        CHECK(d.pushBack({ 1, 2 }));
+        Deque<Point> other(std::move(d));
+        CHECK_EQ(other.front()->y, 2);
+    }
+}
@@ -0,0 +1,69 @@
+/* test_heap.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphacpp/sypha_heap.hpp"
+#include <functional>
+#include <utility>
+
+using namespace sypha;
+
+TEST_CASE("Typed heap") {
+    Heap<int> h;
+
+    SUBCASE("Smallest first") {
+        int values[] = { 5, 3, 9, 1, 7 };
+        CHECK(h.pushMany(values, 5));
+        CHECK(h.push(4));
+        CHECK_EQ(h.count(), 6);
+        CHECK_EQ(*h.top(), 1);
+
+        int expected[] = { 1, 3, 4, 5, 7, 9 };
+        int value;
+        for (int e : expected) {
+            CHECK(h.pop(value));
+            CHECK_EQ(value, e);
+        }
+        CHECK(h.empty());
+        CHECK_FALSE(h.pop());
+        CHECK(h.top() == NULL);
+    }
+
+    SUBCASE("Handles") {
+        Heap<int>::Handle a, b;
+        CHECK(h.push(10, &a));
+        CHECK(h.push(20, &b));
+        CHECK(h.push(15));
+        CHECK(h.update(b, 5));
+        CHECK_EQ(*h.top(), 5);
+        CHECK_EQ(*h.get(a), 10);
+        CHECK(h.remove(b));
+        CHECK_FALSE(h.remove(b));
+        CHECK_EQ(*h.top(), 10);
+        h.clear();
+        CHECK(h.get(a) == NULL);
+    }
+
+    SUBCASE("Largest first and move") {
+        Heap<int, std::greater<int>> maxHeap;
+        CHECK(maxHeap.reserve(10));
+        CHECK(maxHeap.push(1));
+        CHECK(maxHeap.push(3));
+        Heap<int, std::greater<int>> other(std::move(maxHeap));
+        CHECK_EQ(*other.top(), 3);
+    }
+}
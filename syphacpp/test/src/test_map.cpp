@@ -0,0 +1,86 @@
+/* test_map.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphacpp/sypha_map.hpp"
+#include <map>
+#include <string>
+#include <utility>
+
+using namespace sypha;
+
+struct Point {
+    int x;
+    int y;
+};
+
+TEST_CASE("Typed map") {
+    Map<Point> m;
+
+    SUBCASE("Put, get and remove") {
+        for (int i=0;i < 100;i++) {
+            CHECK(m.put("p" + std::to_string(i), { i, -i }));
+        }
+        CHECK_EQ(m.count(), 100);
+        CHECK(m.put("p5", { 50, 50 }));
+        CHECK_EQ(m.count(), 100);
+
+        Point p;
+        CHECK(m.get("p5", p));
+        CHECK_EQ(p.x, 50);
+        CHECK_EQ(m.get("p99")->y, -99);
+        CHECK_FALSE(m.get("nope", p));
+        CHECK(m.get("nope") == NULL);
+
+        CHECK(m.remove("p5"));
+        CHECK_FALSE(m.remove("p5"));
+        CHECK_FALSE(m.contains("p5"));
+        CHECK_EQ(m.count(), 99);
+
+        CHECK(m.reserve(1000));
+        m.clear();
+        CHECK_EQ(m.count(), 0);
+    }
+
+    SUBCASE("Iterate") {
+        std::map<std::string, int> expected;
+        for (int i=0;i < 50;i++) {
+            std::string key = std::to_string(i);
+            CHECK(m.put(key, { i, i }));
+            expected[key] = i;
+        }
+
+        Map<Point>::Iterator it = m.iterator();
+        CHECK(it.get() == NULL);
+        CHECK(it.key().empty());
+        std::map<std::string, int> seen;
+        while (it.next()) {
+            seen[it.key()] = it.get()->x;
+            if (it.get()->x % 2) {
+                CHECK(it.deleteCurrent());
+            }
+        }
+        CHECK(seen == expected);
+        CHECK_EQ(m.count(), 25);
+    }
+
+    SUBCASE("Move") {
+        CHECK(m.put("a", { 1, 2 }));
+        Map<Point> other(std::move(m));
+        CHECK_EQ(other.get("a")->y, 2);
+    }
+}
@@ -0,0 +1,69 @@
+/* test_mpmc_queue.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphacpp/sypha_mpmc_queue.hpp"
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace sypha;
+
+struct Job {
+    int id;
+    double cost;
+};
+
+TEST_CASE("Typed MPMC queue") {
+    MpmcQueue<Job> q(10);
+    CHECK_EQ(q.capacity(), 16);
+
+    SUBCASE("Try calls") {
+        Job job;
+        CHECK_FALSE(q.tryPop(job));
+        for (int i=0;i < 16;i++) {
+            CHECK(q.tryPush({ i, i * 0.5 }));
+        }
+        CHECK_FALSE(q.tryPush({ 99, 0 }));
+        CHECK_EQ(q.count(), 16);
+        CHECK(q.tryPop(job));
+        CHECK_EQ(job.id, 0);
+        CHECK_EQ(q.pop().id, 1);
+    }
+
+    SUBCASE("Between threads") {
+        std::thread producer([&q]() {
+            for (int i=0;i < 10000;i++) {
+                q.push({ i, 1.0 });
+            }
+        });
+        long sum = 0;
+        for (int i=0;i < 10000;i++) {
+            Job job = q.pop();
+            CHECK_EQ(job.id, i);
+            sum += job.id;
+        }
+        producer.join();
+        CHECK_EQ(sum, 10000L * 9999 / 2);
+    }
+
+    SUBCASE("Move") {
+        q.push({ 3, 0 });
+        MpmcQueue<Job> other(std::move(q));
+        CHECK_EQ(other.pop().id, 3);
+    }
+}
@@ -0,0 +1,179 @@
+/* test_processor.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphacpp/sypha_processor.hpp"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+using namespace sypha;
+
+// Same cases as syphapy's tests/test_processor.py
+
+struct Event {
+    int producer;
+    int value;
+};
+
+class NoneQueueProcessor : public QueueProcessor<Event> {
+    public:
+        std::atomic<int> processedCount;
+
+        NoneQueueProcessor() : QueueProcessor<Event>(16), processedCount(0) {}
+        ~NoneQueueProcessor() { stopAll(); }
+
+        bool produce(size_t producerTid, std::vector<Event> & items) override {
+            return false;
+        }
+
+        void consume(size_t consumerTid, Event & item) override {
+            processedCount++;
+        }
+};
+
+// Odd producers hand out an item per call, even ones never have any
+class EmptyQueueProcessor : public QueueProcessor<Event> {
+    public:
+        std::atomic<int> eventCount;
+        std::atomic<int> processedCount;
+
+        EmptyQueueProcessor(size_t capacity = 16, size_t producerCount = 1, size_t consumerCount = 1)
+            : QueueProcessor<Event>(capacity, producerCount, std::chrono::milliseconds(100), consumerCount),
+              eventCount(0), processedCount(0) {}
+        ~EmptyQueueProcessor() { stopAll(); }
+
+        bool produce(size_t producerTid, std::vector<Event> & items) override {
+            if (producerTid % 2 > 0) {
+                items.push_back({ (int) producerTid, eventCount++ });
+            }
+            return true;
+        }
+
+        void consume(size_t consumerTid, Event & item) override {
+            processedCount++;
+        }
+};
+
+// Each producer hands out a fixed number of items in small batches, then halts
+class CountingQueueProcessor : public QueueProcessor<Event> {
+    public:
+        static const int perProducer = 5000;
+        std::vector<std::atomic<int>> seen;
+        std::vector<int> produced;
+
+        CountingQueueProcessor(size_t producerCount, size_t consumerCount)
+            : QueueProcessor<Event>(64, producerCount, std::chrono::milliseconds(1), consumerCount),
+              seen(producerCount * perProducer), produced(producerCount, 0) {
+            for (auto & s : seen) {
+                s = 0;
+            }
+        }
+        ~CountingQueueProcessor() { stopAll(); }
+
+        bool produce(size_t producerTid, std::vector<Event> & items) override {
+            for (int i=0;i < 7 && produced[producerTid] < perProducer;i++) {
+                items.push_back({ (int) producerTid, produced[producerTid]++ });
+            }
+            return !items.empty();
+        }
+
+        void consume(size_t consumerTid, Event & item) override {
+            seen[item.producer * perProducer + item.value]++;
+        }
+};
+
+TEST_CASE("Queue processor") {
+    SUBCASE("Stop by producer returning none") {
+        NoneQueueProcessor processor;
+        processor.startAll();
+
+        // No explicit stop of producers
+        processor.joinProducers();
+        processor.stopConsumers();
+        processor.joinConsumers();
+        CHECK_EQ(processor.processedCount, 0);
+    }
+
+    SUBCASE("Stop explicit call") {
+        EmptyQueueProcessor processor;
+        processor.startAll();
+        processor.stopAll();
+        CHECK_EQ(processor.processedCount, 0);
+    }
+
+    SUBCASE("Producer returning empty list") {
+        EmptyQueueProcessor processor(16, 2);
+        processor.startAll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        processor.stopAll();
+        CHECK_GT(processor.processedCount, 0);
+        CHECK_EQ(processor.processedCount, processor.eventCount);
+    }
+
+    SUBCASE("Multi producer and consumer") {
+        EmptyQueueProcessor processor(16, 5, 7);
+        processor.startAll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        processor.stopAll();
+        CHECK_EQ(processor.processedCount, processor.eventCount);
+    }
+
+    SUBCASE("Every item consumed exactly once") {
+        CountingQueueProcessor processor(4, 3);
+        processor.startAll();
+        processor.joinProducers();
+        processor.stopAll();
+        for (auto & s : processor.seen) {
+            REQUIRE(s == 1);
+        }
+    }
+
+    SUBCASE("Idle workers don't burn CPU") {
+        // Consumers with nothing to take, then producers with no room to put
+        EmptyQueueProcessor processor(2, 4, 4);
+        processor.startConsumers();
+        std::clock_t start = std::clock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        CHECK_LT((double) (std::clock() - start) / CLOCKS_PER_SEC, 0.1);
+
+        processor.stopConsumers();
+        processor.joinConsumers();
+        processor.startProducers();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        start = std::clock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        CHECK_LT((double) (std::clock() - start) / CLOCKS_PER_SEC, 0.1);
+
+        processor.startConsumers();
+        processor.stopAll();
+        CHECK_EQ(processor.processedCount, processor.eventCount);
+    }
+
+    SUBCASE("Consumers started first") {
+        CountingQueueProcessor processor(2, 2);
+        processor.startConsumers();
+        processor.startProducers();
+        processor.joinProducers();
+        processor.stopAll();
+        for (auto & s : processor.seen) {
+            REQUIRE(s == 1);
+        }
+    }
+}
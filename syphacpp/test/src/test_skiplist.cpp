@@ -0,0 +1,71 @@
+/* test_skiplist.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphacpp/sypha_skiplist.hpp"
+#include <functional>
+#include <utility>
+
+using namespace sypha;
+
+TEST_CASE("Typed skip list") {
+    SkipList<int> s;
+
+    SUBCASE("Ordered") {
+        for (int i=0;i < 100;i++) {
+            CHECK(s.insert((i * 37) % 100));
+        }
+        CHECK(s.insert(50));
+        CHECK_EQ(s.count(), 101);
+        CHECK_EQ(*s.find(42), 42);
+        CHECK(s.remove(50));
+        CHECK(s.remove(50));
+        CHECK_FALSE(s.remove(50));
+        CHECK(s.find(50) == NULL);
+
+        SkipList<int>::Iterator it = s.front();
+        int expected = 0;
+        while (it.next()) {
+            if (expected == 50) {
+                expected++;
+            }
+            CHECK_EQ(*it.get(), expected++);
+        }
+        CHECK_EQ(expected, 100);
+
+        SkipList<int>::Iterator bound = s.lowerBound(50);
+        CHECK(bound.next());
+        CHECK_EQ(*bound.get(), 51);
+        CHECK(bound.deleteCurrent());
+        CHECK_EQ(*bound.get(), 49);
+        CHECK_EQ(s.count(), 98);
+    }
+
+    SUBCASE("Custom order and move") {
+        SkipList<int, std::greater<int>> desc;
+        CHECK(desc.insert(1));
+        CHECK(desc.insert(3));
+        CHECK(desc.insert(2));
+        SkipList<int, std::greater<int>> other(std::move(desc));
+        SkipList<int, std::greater<int>>::Iterator it = other.back();
+        CHECK(it.next());
+        CHECK_EQ(*it.get(), 1);
+        CHECK(it.previous() == false);
+        CHECK(it.next());
+        CHECK_EQ(*it.get(), 2);
+    }
+}
@@ -0,0 +1,102 @@
+/* test_vec.cpp
+ *
+ * Copyright 2024 David Tuttle
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#include "doctest.h"
+#include "syphacpp/sypha_vec.hpp"
+#include <utility>
+#include <vector>
+
+using namespace sypha;
+
+struct Point {
+    int x;
+    int y;
+};
+
+TEST_CASE("Typed vector") {
+    Vec<Point> v;
+
+    SUBCASE("Append and range") {
+        for (int i=0;i < 100;i++) {
+            CHECK(v.append({ i, -i }));
+        }
+        CHECK(v.prepend({ -1, 1 }));
+        CHECK_EQ(v.count(), 101);
+        CHECK_EQ(v[0].x, -1);
+        CHECK_EQ(v.get(100)->y, -99);
+        CHECK(v.get(101) == NULL);
+
+        int expected = -1;
+        for (Point & p : v) {
+            CHECK_EQ(p.x, expected++);
+        }
+
+        std::vector<Point> more = { { 200, 0 }, { 201, 0 } };
+        CHECK(v.appendMany(more.data(), more.size()));
+        CHECK_EQ(v.count(), 103);
+        CHECK_EQ(v[102].x, 201);
+    }
+
+    SUBCASE("Reserve, shrink and clear") {
+        CHECK(v.reserve(64));
+        CHECK_EQ(v.capacity(), 64);
+        CHECK(v.append({ 1, 2 }));
+        CHECK(v.shrink());
+        CHECK_EQ(v.capacity(), 1);
+        v.clear();
+        CHECK_EQ(v.count(), 0);
+        CHECK(v.begin() == v.end());
+    }
+
+    SUBCASE("Iterators") {
+        for (int i=0;i < 10;i++) {
+            CHECK(v.append({ i, 0 }));
+        }
+
+        Vec<Point>::Iterator it = v.front();
+        CHECK(it.get() == NULL);
+        while (it.next()) {
+            if (it.get()->x % 2) {
+                CHECK(it.deleteCurrent());
+            }
+        }
+        CHECK_EQ(v.count(), 5);
+
+        Vec<Point>::Iterator back = v.back();
+        CHECK(back.next());
+        CHECK_EQ(back.get()->x, 8);
+        CHECK(back.insertAfter({ 7, 0 }));
+        CHECK(back.insertBefore({ 9, 0 }));
+        CHECK(back.next());
+        CHECK_EQ(back.get()->x, 7);
+        CHECK(back.previous());
+        CHECK_EQ(back.get()->x, 8);
+
+        int expected[] = { 0, 2, 4, 6, 7, 8, 9 };
+        CHECK_EQ(v.count(), 7);
+        for (size_t i=0;i < v.count();i++) {
+            CHECK_EQ(v[i].x, expected[i]);
+        }
+    }
+
+    SUBCASE("Moving") {
+        CHECK(v.append({ 5, 5 }));
+        Vec<Point> other(std::move(v));
+        CHECK_EQ(other.count(), 1);
+        CHECK_EQ(other[0].y, 5);
+    }
+}
@@ -16,26 +16,99 @@
 
 # An attempt at generalizing a pattern of having a queue and spinning up a set of
 # worker threads to drain the queue.
+#
+# Consumers can instead run as worker processes for CPU-heavy consume work the GIL
+# would otherwise serialize, see the backend argument of QueueProcessor.
 
 from abc import ABC, abstractmethod
 from queue import Queue
 from threading import Thread, Event
 from typing import Sequence, List
-import time
+import multiprocessing
 import logging
 
 logger = logging.getLogger(__name__)
 
 POISON = "poison"
 
+# First sleep of an idle producer polling with backoff, doubles up to the producer throttle
+MIN_BACKOFF = 0.001
+
 class Item(dict):
     pass
+
+# A Queue that also moves items in bulk, taking its lock once per run of items
+# instead of once per item.  Works on the Queue internals (its condition variables,
+# _put, _get and _qsize) the same way put and get do, so the join / task_done
+# accounting still holds.
+class BatchQueue(Queue):
+    # Puts all items on the queue, blocking while it is full
+    def put_many(self, items: Sequence[Item]):
+        index = 0
+        count = len(items)
+        while index < count:
+            with self.not_full:
+                if self.maxsize > 0:
+                    while self._qsize() >= self.maxsize:
+                        self.not_full.wait()
+                    room = min(count - index, self.maxsize - self._qsize())
+                else:
+                    room = count - index
+                for item in items[index:index + room]:
+                    self._put(item)
+                index += room
+                self.unfinished_tasks += room
+                self.not_empty.notify(room)
+
+    # Takes up to max_count items off the queue, blocking until there is at least
+    # one.  Stops right after a poison message so every consumer still gets exactly
+    # one, the poison comes back as the last item.
+    def get_many(self, max_count: int) -> List[Item]:
+        items: List[Item] = []
+        with self.not_empty:
+            while not self._qsize():
+                self.not_empty.wait()
+            while self._qsize() and len(items) < max_count:
+                item = self._get()
+                items.append(item)
+                if POISON in item:
+                    break
+            self.not_full.notify(len(items))
+        return items
     
 class QueueProcessor(ABC):
     # The counts are the number of respective worker thread to create.  The throttles are the number of
-    # seconds to sleep for if needing to slow down activity (for whatever reason)
-    def __init__(self, capacity=0, producer_count=1, producer_throttle=0.1, consumer_count=1, consumer_throttle=0.1):
-        self._queue = Queue(maxsize=capacity)
+    # seconds to sleep for if needing to slow down activity (for whatever reason).  consumer_batch is the
+    # most items a consumer pulls off the queue per wakeup and hands to consume_batch.
+    #
+    # With producer_signal the sources say when they have work by calling notify_work and idle producers
+    # sleep until then, each on its own wake event.  Otherwise idle producers poll produce with exponential backoff, starting at
+    # MIN_BACKOFF and capped at producer_throttle.
+    #
+    # backend is "thread" or "process".  With "process" each consumer is a worker process forked off
+    # this one when the consumers start, so consume / consume_batch run on a copy of this object and
+    # anything they produce has to go back through multiprocessing primitives (Value, Array, Queue...)
+    # made here beforehand.  It differs from "thread" in that:
+    #   - it needs the fork start method (not on Windows, or macOS by default), a ValueError otherwise
+    #   - items are pickled over in batches of up to consumer_batch, and capacity is rounded down to a
+    #     count of those batches (at least one) rather than of items
+    #   - consumer processes don't take consumer_throttle, they just block on the queue
+    def __init__(self, capacity=0, producer_count=1, producer_throttle=0.1, consumer_count=1, consumer_throttle=0.1,
+                 consumer_batch=1, producer_signal=False, backend="thread"):
+        self._consumer_batch = max(1, consumer_batch)
+        self._backend = backend
+        if backend == "thread":
+            self._queue = BatchQueue(maxsize=capacity)
+        elif backend == "process":
+            if "fork" not in multiprocessing.get_all_start_methods():
+                raise ValueError("The process backend forks its consumers, fork is not available here")
+            self._context = multiprocessing.get_context("fork")
+            batches = 0 if capacity <= 0 else max(1, capacity // self._consumer_batch)
+            self._queue = self._context.Queue(maxsize=batches)
+        else:
+            raise ValueError(f"Unknown backend {backend}")
+        self._producer_signal = producer_signal
+        self._producers_go = Event()
         
         self.__producer_count=producer_count
         self.__producers: List[Producer] = []
@@ -43,9 +116,12 @@ class QueueProcessor(ABC):
             self.__producers.append(Producer(i, producer_throttle, self))
         
         self.__consumer_count=consumer_count
-        self.__consumers: List[Consumer] = []
+        self.__consumers: List[Consumer | multiprocessing.process.BaseProcess] = []
         for i in range(self.__consumer_count):
-            self.__consumers.append(Consumer(i, consumer_throttle, self))
+            if backend == "process":
+                self.__consumers.append(self._context.Process(target=self._consume_process, args=(i,)))
+            else:
+                self.__consumers.append(Consumer(i, consumer_throttle, self))
 
     # Child class should implement this such that each call to this by a
     # producer thread yields N queue items
@@ -63,13 +139,81 @@ class QueueProcessor(ABC):
     def consume(self, consumer_tid: int, item: Item):
         pass
 
+    # Child class may override this to handle a whole batch of up to consumer_batch
+    # items in one call, by default each item goes to consume in order.
+    def consume_batch(self, consumer_tid: int, items: List[Item]):
+        for item in items:
+            self.consume(consumer_tid, item=item)
+
+    # Wakes the producer producer_tid, or all of them when None, if waiting for
+    # work.  Safe to call from any thread at any time.  Meant to be handed to a
+    # source as its callback, or called from whatever watches the source's fd,
+    # when new items arrive.
+    def notify_work(self, producer_tid: int | None = None):
+        if producer_tid is None:
+            for producer in self.__producers:
+                producer.wake.set()
+        else:
+            self.__producers[producer_tid].wake.set()
+
+    # Puts all items on the queue, blocks while the queue is full, which is ok
+    def _put_batch(self, items: Sequence[Item]):
+        if self._backend == "process":
+            # One pickled message per consumer_batch items, the feeder thread of
+            # the multiprocessing queue keeps them in order
+            for index in range(0, len(items), self._consumer_batch):
+                self._queue.put(list(items[index:index + self._consumer_batch]))
+        else:
+            self._queue.put_many(items)
+
+    # Takes up to max_count items off the queue, blocking until there is at least
+    # one.  A poison message only ever comes last.
+    def _get_batch(self, max_count: int) -> List[Item]:
+        if self._backend == "process":
+            # Already batched by _put_batch, poison always on its own
+            return self._queue.get()
+        return self._queue.get_many(max_count)
+
+    # Runs a consumer, thread or process, until it gets its poison message
+    def _consume_until_poisoned(self, consumer_tid: int):
+        batch = self._consumer_batch
+        while True:
+            # This can block, which is ok since we are pushing enough poison messages
+            # for each consumer to get one.
+            items = self._get_batch(batch)
+
+            # Time to stop?  A poison message can only be last, the items ahead of it
+            # still get handled.
+            poison = items[-1].get(POISON, None)
+            if poison != None:
+                items.pop()
+            if len(items) > 0:
+                self.consume_batch(consumer_tid, items)
+            if poison != None:
+                logger.debug(f"Consumer {consumer_tid} poisoned")
+                break
+
+    # Body of a consumer process
+    def _consume_process(self, consumer_tid: int):
+        logger.debug(f"Consumer process {consumer_tid} starting")
+        self._consume_until_poisoned(consumer_tid)
+        logger.debug(f"Consumer process {consumer_tid} exiting")
+
     # Starts producer threads
     def start_producers(self):
         logger.debug("Starting producers")
 
-        # Start producer threads
+        # Start producer threads, held until all are up.  Thread.start waits for the new
+        # thread to get going, which can take seconds when it has to win the GIL from
+        # producers already busy on the queue.
         for i in range(self.__producer_count):
             self.__producers[i].start()
+        self._producers_go.set()
+
+        # Return once each has checked for a stop, so one coming after this finds
+        # them going the way it would with producers started straight away
+        for i in range(self.__producer_count):
+            self.__producers[i].up.wait()
 
     # Starts consumer threads
     def start_consumers(self):
@@ -79,10 +223,11 @@ class QueueProcessor(ABC):
         for i in range(self.__consumer_count):
             self.__consumers[i].start()
 
-    # Starts all producer and consumer threads
+    # Starts all producer and consumer threads, consumers first so they are all up
+    # before there is anything busy to compete with
     def start_all(self):
-        self.start_producers()
         self.start_consumers()
+        self.start_producers()
 
     # Stop producer threads
     def stop_producers(self):
@@ -106,7 +251,7 @@ class QueueProcessor(ABC):
 
         # Signal stop to all consumers
         for _ in range(self.__consumer_count):
-            self._queue.put({ POISON: 1 })
+            self._put_batch([{ POISON: 1 }])
 
     # Wait for consumer threads to finish (blocks!)
     def join_consumers(self):
@@ -133,14 +278,30 @@ class Producer(Thread):
         self.throttle = throttle
         self.processor = processor
         self.event = Event()
+        # Set by notify_work and stop(), what an idle producer with producer_signal waits on
+        self.wake = Event()
+        # Set once let go by start_producers and past the first stop check
+        self.up = Event()
 
         logger.debug(f"Producer thread {self.tid} created")
 
     def run(self):
         logger.debug(f"Producer thread {self.tid} starting")
+        # Held by start_producers, the stop signal is still checked before the first produce
+        self.processor._producers_go.wait()
+        running = not self.event.is_set()
+        self.up.set()
+
+        signal = self.processor._producer_signal
+        backoff = 0.0
 
         # While not signaled to stop via stop(), attempt to pull more items
-        while not self.event.is_set():
+        while running:
+            # Cleared before producing so a notify landing from here on still wakes
+            # the wait below
+            if signal:
+                self.wake.clear()
+
             # This cannot block, must give up after wait and yield no items or None
             items = self.processor.produce(self.tid)
             
@@ -150,18 +311,28 @@ class Producer(Thread):
                 break
 
             if len(items) > 0:
-                for item in items:
-                    # Blocks, which is ok
-                    self.processor._queue.put(item)
+                backoff = 0.0
+                self.processor._put_batch(items)
+            elif signal:
+                logger.debug(f"Producer thread {self.tid} received empty list, wait for notify")
+                # stop() sets the stop signal before waking, so either it shows
+                # here or the wait returns
+                if not self.event.is_set():
+                    self.wake.wait()
             else:
-                logger.debug(f"Producer thread {self.tid} received empty list, throttle")
-                time.sleep(self.throttle)
+                backoff = min(self.throttle, backoff * 2 if backoff > 0 else MIN_BACKOFF)
+                logger.debug(f"Producer thread {self.tid} received empty list, back off {backoff}")
+                # Returns early on stop()
+                self.event.wait(backoff)
+
+            running = not self.event.is_set()
     
         logger.debug(f"Producer thread {self.tid} exiting")
 
     def stop(self):
         logger.debug(f"Producer thread {self.tid} set stop signal")
         self.event.set()
+        self.wake.set()
 
 # Doesn't stop handling work items until receiving a specific message in the work queue
 class Consumer(Thread):
@@ -176,17 +347,5 @@ class Consumer(Thread):
 
     def run(self):
         logger.debug(f"Consumer thread {self.tid} starting")
-        while True:
-            # This can block, which is ok since we are pushing enough poison messages
-            # for each consumer thread to get one.
-            item = self.processor._queue.get()
-            
-            # Time to stop?
-            poison = item.get(POISON, None)
-            if poison != None:
-                logger.debug(f"Consumer thread {self.tid} poisoned")
-                break
-            
-            self.processor.consume(self.tid, item=item)
-        
+        self.processor._consume_until_poisoned(self.tid)
         logger.debug(f"Consumer thread {self.tid} exiting")
@@ -18,14 +18,18 @@ import logging
 
 import time
 from typing import Sequence
-from syphapy.processor import QueueProcessor, Item
-from threading import RLock
+from syphapy.processor import QueueProcessor, Item, BatchQueue, POISON
+from threading import RLock, Event, Thread
+from collections import deque
+import multiprocessing
+import os
+import pytest
 
 logger = logging.getLogger(__name__)
 
 class NoneQueueProcessor(QueueProcessor):
-    def __init__(self, capacity=16, producer_count=1, producer_throttle=0.1, consumer_count=1, consumer_throttle=0.1):
-        super().__init__(capacity, producer_count, producer_throttle, consumer_count, consumer_throttle)
+    def __init__(self, capacity=16, producer_count=1, producer_throttle=0.1, consumer_count=1, consumer_throttle=0.1, backend="thread"):
+        super().__init__(capacity, producer_count, producer_throttle, consumer_count, consumer_throttle, backend=backend)
         self.processed_count = 0
 
     def produce(self, producer_tid: int) -> Sequence[Item] | None:
@@ -57,8 +61,8 @@ class EmptyQueueProcessor(QueueProcessor):
         self.processed_count = self.processed_count + 1
 
 class MultiQueueProcessor(QueueProcessor):
-    def __init__(self, capacity=16, producer_count=5, producer_throttle=0.1, consumer_count=7, consumer_throttle=0.1):
-        super().__init__(capacity, producer_count, producer_throttle, consumer_count, consumer_throttle)
+    def __init__(self, capacity=16, producer_count=5, producer_throttle=0.1, consumer_count=7, consumer_throttle=0.1, consumer_batch=1):
+        super().__init__(capacity, producer_count, producer_throttle, consumer_count, consumer_throttle, consumer_batch)
         self.producer_lock = RLock()
         self.event_count = 0
         self.consumer_lock = RLock()
@@ -88,6 +92,130 @@ class MultiQueueProcessor(QueueProcessor):
         with self.consumer_lock:
             self.processed_count = self.processed_count + 1
 
+class BatchQueueProcessor(QueueProcessor):
+    def __init__(self, total=5000, per_produce=50, capacity=256, producer_count=2, producer_throttle=0.1, consumer_count=3, consumer_throttle=0.1, consumer_batch=64):
+        super().__init__(capacity, producer_count, producer_throttle, consumer_count, consumer_throttle, consumer_batch)
+        self.total = total
+        self.per_produce = per_produce
+        self.producer_lock = RLock()
+        self.event_count = 0
+        self.consumer_lock = RLock()
+        self.processed = []
+        self.batch_count = 0
+        self.largest_batch = 0
+
+    def produce(self, producer_tid: int) -> Sequence[Item] | None:
+        with self.producer_lock:
+            first = self.event_count
+            count = min(self.per_produce, self.total - first)
+            self.event_count = self.event_count + count
+
+        if count == 0:
+            return None
+
+        return [{ "n": first + i } for i in range(count)]
+
+    def consume(self, consumer_tid: int, item: Item):
+        assert False, "consume_batch is overridden"
+
+    def consume_batch(self, consumer_tid: int, items: Sequence[Item]):
+        logger.debug(f"consume_batch - thread {consumer_tid}: {len(items)} items")
+
+        with self.consumer_lock:
+            self.processed.extend(item["n"] for item in items)
+            self.batch_count = self.batch_count + 1
+            self.largest_batch = max(self.largest_batch, len(items))
+
+class SourceQueueProcessor(QueueProcessor):
+    def __init__(self, capacity=16, producer_count=2, producer_throttle=10, consumer_count=1, consumer_throttle=0.1, producer_signal=True):
+        super().__init__(capacity, producer_count, producer_throttle, consumer_count, consumer_throttle, producer_signal=producer_signal)
+        self.source = deque()
+        self.lock = RLock()
+        self.produce_count = 0
+        self.consumed = Event()
+
+    # Stands in for a source with a readiness callback
+    def arrive(self, item: Item):
+        self.source.append(item)
+        self.notify_work()
+
+    def produce(self, producer_tid: int) -> Sequence[Item] | None:
+        with self.lock:
+            self.produce_count = self.produce_count + 1
+
+        result = list()
+        while len(self.source) > 0:
+            try:
+                result.append(self.source.popleft())
+            except IndexError:
+                break
+
+        return result
+
+    def consume(self, consumer_tid: int, item: Item):
+        logger.debug(f"consume - thread {consumer_tid}: {item}")
+        self.consumed.set()
+
+class HeldSourceQueueProcessor(QueueProcessor):
+    def __init__(self, producer_count=2):
+        super().__init__(16, producer_count, 10, 1, 0.1, producer_signal=True)
+        self.sources = [deque() for _ in range(producer_count)]
+        self.hold = False
+        self.inside = Event()
+        self.release = Event()
+        self.consumed = Event()
+
+    # Producer 0 takes what its source has, then while hold is set stays inside
+    # produce until released, so things can happen in between
+    def produce(self, producer_tid: int) -> Sequence[Item] | None:
+        result = list()
+        while len(self.sources[producer_tid]) > 0:
+            result.append(self.sources[producer_tid].popleft())
+
+        if producer_tid == 0 and self.hold:
+            self.inside.set()
+            self.release.wait()
+
+        return result
+
+    def consume(self, consumer_tid: int, item: Item):
+        logger.debug(f"consume - thread {consumer_tid}: {item}")
+        self.consumed.set()
+
+class ProcessQueueProcessor(QueueProcessor):
+    def __init__(self, total=3000, per_produce=30, capacity=256, producer_count=2, consumer_count=3, consumer_batch=16):
+        super().__init__(capacity, producer_count, 0.1, consumer_count, 0.1, consumer_batch, backend="process")
+        self.total = total
+        self.per_produce = per_produce
+        self.producer_lock = RLock()
+        self.event_count = 0
+
+        # Consumers run in forked processes, results come back through shared memory
+        context = multiprocessing.get_context("fork")
+        self.parent_pid = os.getpid()
+        self.seen = context.Array("i", total)
+        self.in_parent = context.Value("i", 0)
+
+    def produce(self, producer_tid: int) -> Sequence[Item] | None:
+        with self.producer_lock:
+            first = self.event_count
+            count = min(self.per_produce, self.total - first)
+            self.event_count = self.event_count + count
+
+        if count == 0:
+            return None
+
+        return [{ "n": first + i } for i in range(count)]
+
+    def consume(self, consumer_tid: int, item: Item):
+        logger.debug(f"consume - process {os.getpid()}: {item}")
+
+        # Each n is only ever consumed once, so no lock needed on its slot
+        self.seen[item["n"]] = self.seen[item["n"]] + 1
+        if os.getpid() == self.parent_pid:
+            with self.in_parent.get_lock():
+                self.in_parent.value = self.in_parent.value + 1
+
 def test_stop_by_producer_return_none():
     processor = NoneQueueProcessor()
     processor.start_all()
@@ -123,3 +251,182 @@ def test_stress():
     time.sleep(3)
     processor.stop_all()
     assert processor.event_count == processor.processed_count
+
+def test_start_all_with_busy_producers():
+    # Half of the producers never idle, starting the rest must not get stuck behind them
+    processor = MultiQueueProcessor(capacity=20480, producer_count=32, consumer_count=16)
+    start = time.monotonic()
+    processor.start_all()
+    assert time.monotonic() - start < 2
+    processor.stop_all()
+    assert processor.event_count == processor.processed_count
+
+def test_stop_before_start():
+    # Held producers still check for a stop before their first produce
+    processor = SourceQueueProcessor(producer_count=4)
+    processor.stop_producers()
+    processor.start_all()
+    processor.stop_all()
+    assert processor.produce_count == 0
+
+def test_consume_batch():
+    processor = BatchQueueProcessor()
+    processor.start_all()
+    processor.join_producers()
+    processor.stop_consumers()
+    processor.join_consumers()
+
+    # Every item exactly once, never more than consumer_batch per call
+    assert sorted(processor.processed) == list(range(processor.total))
+    assert 0 < processor.largest_batch <= 64
+    assert processor.batch_count < processor.total
+
+def test_consume_batch_small_capacity():
+    # Produced lists bigger than the queue have to go on in pieces
+    processor = BatchQueueProcessor(total=2000, per_produce=100, capacity=8, consumer_batch=5)
+    processor.start_all()
+    processor.join_producers()
+    processor.stop_consumers()
+    processor.join_consumers()
+
+    assert sorted(processor.processed) == list(range(processor.total))
+    assert processor.largest_batch <= 5
+
+def test_batch_queue():
+    queue = BatchQueue(maxsize=4)
+
+    # put_many waits for room, get_many takes what is there and stops after poison
+    putter = Thread(target=queue.put_many, args=([{ "value": i } for i in range(10)] + [{ POISON: 1 }, { "value": 10 }],))
+    putter.start()
+    items = []
+    while not items or POISON not in items[-1]:
+        items += queue.get_many(3)
+    putter.join()
+    assert [item["value"] for item in items[:-1]] == list(range(10))
+    assert queue.get_many(3) == [{ "value": 10 }]
+
+    # task accounting is kept the same as put / get
+    assert queue.unfinished_tasks == 12
+    for _ in range(12):
+        queue.task_done()
+    queue.join()
+
+def test_consume_batch_default_calls_consume():
+    processor = MultiQueueProcessor(consumer_batch=32)
+    processor.start_all()
+    processor.stop_all()
+    assert processor.event_count == processor.processed_count
+
+def test_producer_signal_wakes_on_notify():
+    # A throttle of 10 seconds would fail this if producers were still sleeping on it
+    processor = SourceQueueProcessor()
+    processor.start_all()
+    time.sleep(0.3)
+
+    # Idle producers wait for the notify instead of polling
+    assert processor.produce_count <= 2
+
+    start = time.monotonic()
+    processor.arrive({ "foo": "bar" })
+    assert processor.consumed.wait(5)
+    assert time.monotonic() - start < 0.5
+
+    start = time.monotonic()
+    processor.stop_all()
+    assert time.monotonic() - start < 0.5
+
+def test_producer_signal_multi_producer():
+    processor = HeldSourceQueueProcessor()
+    processor.hold = True
+    processor.start_all()
+    assert processor.inside.wait(5)
+
+    # Work for producer 0 turns up while it is inside produce, and producer 1 goes
+    # through a whole idle round meanwhile.  The wakeup for 0 has to survive that.
+    processor.sources[0].append({ "foo": "bar" })
+    processor.notify_work(0)
+    processor.notify_work(1)
+    time.sleep(0.1)
+    processor.hold = False
+    processor.release.set()
+    assert processor.consumed.wait(5)
+
+    # Stopping while a producer is inside produce
+    processor.hold = True
+    processor.inside.clear()
+    processor.release.clear()
+    processor.notify_work()
+    assert processor.inside.wait(5)
+    stopper = Thread(target=processor.stop_all)
+    stopper.start()
+    time.sleep(0.1)
+    processor.release.set()
+    stopper.join(5)
+    assert not stopper.is_alive()
+
+def test_producer_backoff_without_signal():
+    processor = SourceQueueProcessor(producer_count=1, producer_throttle=0.2, producer_signal=False)
+    processor.start_all()
+    time.sleep(0.6)
+
+    # 1 + 2 + 4 + ... ms up to the 200 ms cap, a fixed 1 ms poll would be hundreds of calls
+    assert 3 <= processor.produce_count <= 20
+
+    processor.arrive({ "foo": "bar" })
+    assert processor.consumed.wait(5)
+    processor.stop_all()
+
+    # Stopping does not wait out the backoff
+    processor = SourceQueueProcessor(producer_count=1, producer_throttle=10, producer_signal=False)
+    processor.start_all()
+    time.sleep(0.1)
+    start = time.monotonic()
+    processor.stop_all()
+    assert time.monotonic() - start < 0.5
+
+def test_process_backend():
+    processor = ProcessQueueProcessor()
+    processor.start_all()
+    processor.join_producers()
+    processor.stop_consumers()
+    processor.join_consumers()
+
+    assert list(processor.seen) == [1] * processor.total
+    assert processor.in_parent.value == 0
+
+def test_process_backend_stop_explicit_call():
+    processor = ProcessQueueProcessor(total=100000, per_produce=10, capacity=64, consumer_batch=4)
+    processor.start_all()
+    time.sleep(0.5)
+    processor.stop_all()
+
+    # Whatever got produced before the stop was consumed exactly once
+    assert list(processor.seen[:processor.event_count]) == [1] * processor.event_count
+    assert sum(processor.seen) == processor.event_count
+
+def test_process_backend_stop_by_producer_return_none():
+    # Producers hand out everything they have then return None, no explicit stop
+    processor = ProcessQueueProcessor(total=500, per_produce=7, consumer_count=2, consumer_batch=3)
+    processor.start_all()
+    processor.join_producers()
+    processor.stop_consumers()
+    processor.join_consumers()
+
+    assert processor.event_count == processor.total
+    assert list(processor.seen) == [1] * processor.total
+
+    # and nothing at all
+    processor = NoneQueueProcessor(consumer_count=2, backend="process")
+    processor.start_all()
+    processor.join_producers()
+    processor.stop_consumers()
+    processor.join_consumers()
+
+def test_unknown_backend():
+    with pytest.raises(ValueError):
+        NoneQueueProcessor(backend="fiber")
+
+def test_process_backend_needs_fork(monkeypatch):
+    monkeypatch.setattr(multiprocessing, "get_all_start_methods", lambda: ["spawn"])
+    with pytest.raises(ValueError, match="fork"):
+        NoneQueueProcessor(backend="process")